@@ -0,0 +1,85 @@
+/*
+  uc-Microlab Example: ADC binary streaming
+  Repository: uc-Microlab
+
+  Description:
+    Gap-free logging of ADC channel 0 at 1 kS/s over UART. Timer1 compare
+    match B triggers every conversion, the ADC sampler (adc-sampler.h)
+    collects the results in ping-pong buffers and the stream layer
+    (stream.h) sends them as COBS-framed binary records with sequence
+    numbers and a CRC-16, instead of one printf line per sample.
+    Decode on the host with firmware/tools/stream-decode.py.
+
+    Expected calls shown:
+      - HAL_UART_Init(unsigned int baud_rate);
+      - HAL_CTC_Init / HAL_CTC_SetValue with the compile-time solver
+        HAL_CTC_CH1_CK / HAL_CTC_CH1_OCR (Timer1 as the sample clock);
+      - ADC_SMP_Start, ADC_SMP_GetBuffer, ADC_SMP_Release;
+      - STRM_Init, STRM_PushBlock, STRM_Service.
+
+  Hardware: uc-Microlab — version r1
+  Target MCU: ATmega328P (Arduino Uno compatible)
+
+  Connections:
+    - ADC CH0 (MCU PC0 / ADC0) -> analog signal to measure
+    - UART TX (MCU PD1 / TXD0) -> serial adapter RX
+
+  Build notes / usage:
+    - Add uart-hal.c, adc-hal.c, ctc-hal.c, adc-sampler.c and stream.c to
+      the project source files.
+    - Define HAL_UART_USE_ISR=1 in the project compiler symbols so frames
+      are sent from the UART interrupt.
+    - 1000 samples/s need about 2500 bytes/s (16 samples per 40-byte
+      frame), within the roughly 3400 bytes/s of 38400 baud.
+    - On the host: stream-decode.py /dev/ttyACM0 -b 38400 > capture.csv
+    - SPDX-License-Identifier: MIT — see repository LICENSE for full terms.
+
+  Author: otavioacb
+  Date: 2026-10-14
+*/
+
+#define F_CPU 16000000UL
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "uart-hal.h"
+#include "ctc-hal.h"
+#include "adc-sampler.h"
+#include "stream.h"
+
+/* Timer1 as a 1 kHz sample clock (prescaler 1, TOP 15999 at 16 MHz) */
+#define SAMPLE_RATE 1000UL
+#define SAMPLE_TOP  HAL_CTC_CH1_OCR(SAMPLE_RATE)
+
+int main(void)
+{
+	uint16_t now = 0;
+
+	HAL_UART_Init(38400);
+	STRM_Init(STRM_TYPE_ADC);
+
+	HAL_CTC_Init(HAL_CTC_SRC_1, HAL_CTC_CH_A, 0, HAL_CTC_CH1_CK(SAMPLE_RATE));
+	HAL_CTC_SetValue(HAL_CTC_SRC_1, HAL_CTC_CH_A, SAMPLE_TOP);
+	HAL_CTC_SetValue(HAL_CTC_SRC_1, HAL_CTC_CH_B, SAMPLE_TOP);
+
+	ADC_SMP_Start(HAL_ADC_CH00, HAL_ADC_AVCC, HAL_ADC_DF64, HAL_ADC_TRSC_T1CP);
+
+	sei();
+
+    while(1)
+    {
+		const uint16_t* buf = ADC_SMP_GetBuffer();
+
+		if(buf)
+		{
+			STRM_PushBlock(buf, ADC_SMP_BUFFER_LEN);
+			ADC_SMP_Release();
+
+			/* One buffer per ADC_SMP_BUFFER_LEN ms at 1 kS/s */
+			now += ADC_SMP_BUFFER_LEN;
+		}
+
+		STRM_Service(now);
+    }
+}
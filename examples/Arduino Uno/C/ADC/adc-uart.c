@@ -17,7 +17,7 @@
       - HAL_ADC_SetPrescaler(unsigned char pre);
       - HAL_ADC_Enable(void);
       - HAL_ADC_StartConversion(void);
-      - HAL_ADC_Finished(void);
+      - HAL_ADC_isRunning(void);
       - HAL_ADC_Read(void);
 
   Hardware: uc-Microlab — version r1
@@ -43,6 +43,7 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "adc-hal.h"
 #include "uart-hal.h"
@@ -63,9 +64,9 @@ int main(void)
     while(1)
     {
 		HAL_ADC_StartConversion();
-		while(!HAL_ADC_Finished());
+		while(HAL_ADC_isRunning());
 		adc_val = HAL_ADC_Read();
-		sprintf(msg, "O valor e: %d\n", adc_val);
-		HAL_UART_Send(msg, sizeof(msg));
+		snprintf((char*) msg, sizeof(msg), "O valor e: %u\n", adc_val);
+		HAL_UART_Send(msg, strlen((char*) msg));
     }
 }
@@ -0,0 +1,262 @@
+/*
+  uc-Microlab Example: HAL and driver benchmark
+  Repository: uc-Microlab
+
+  Description:
+    Times the main HAL and driver calls in CPU cycles and prints a table
+    over UART: payload size, minimum / average / maximum cycles of
+    BENCH_RUNS runs and the resulting payload throughput in bytes/s.
+    Timer1 runs as a 16 MHz cycle counter (trace-hal.h); the cost of
+    reading it is measured first and subtracted from every sample.
+    Build it once with the default blocking HALs and once with
+    HAL_UART_USE_ISR=1 to compare both modes on the same board; the
+    "i2c submit" row shows what the CPU pays for an asynchronous I2C
+    transaction before it is free again.
+
+    Expected calls shown:
+      - HAL_TRACE_Init, HAL_TRACE_Cycles, HAL_TRACE_Get (cycle counter);
+      - HAL_UART_InitConfig, HAL_UART_Send;
+      - HAL_I2C_InitController, HAL_I2C_ControllerTransmit, HAL_I2C_Submit,
+        HAL_I2C_Wait;
+      - DS3231_Init, DS3231_GetTime;
+      - MAX_Init, MAX_SendData, MAX_ChainInit, MAX_ChainRefresh.
+
+  Hardware: uc-Microlab — version r1
+  Target MCU: ATmega328P (Arduino Uno compatible)
+
+  Connections:
+    - UART TX  (MCU PD1 / TXD0)          -> serial adapter RX
+    - I2C SDA  (MCU PC4 / SDA, Arduino A4) -> DS3231 SDA (4.7 k pull-up)
+    - I2C SCL  (MCU PC5 / SCL, Arduino A5) -> DS3231 SCL (4.7 k pull-up)
+    - SPI MOSI (MCU PB3 / MOSI, Arduino D11) -> MAX7219 DIN
+    - SPI SCK  (MCU PB5 / SCK, Arduino D13)  -> MAX7219 CLK
+    - LOAD     (MCU PB2 / SS, Arduino D10)   -> MAX7219 LOAD/CS
+
+  Build notes / usage:
+    - Add trace-hal.c, uart-hal.c, i2c-hal.c, spi-hal.c, ds3231.c and
+      max7219.c to the project source files.
+    - Timer1 belongs to trace-hal.c; do not link pwm-hal.c built with
+      HAL_PWM_TIMER1_ISR=1 or icp-hal.c.
+    - Define HAL_TRACE_USE=1 as well to get the per-interrupt rows at the
+      end (cycles spent in each TWI, SPI, UART and ADC interrupt).
+    - The I2C transmit rows write zeros to the DS3231 alarm registers
+      (0x07-0x0D); the alarms stay disabled, the time is not touched.
+    - Terminal at 115200 baud, 8N1. Samples include the interrupts that
+      preempted the call, so the maximum shows the worst case seen.
+    - SPDX-License-Identifier: MIT — see repository LICENSE for full terms.
+
+  Author: otavioacb
+  Date: 2026-10-14
+*/
+
+#define F_CPU 16000000UL
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "trace-hal.h"
+#include "uart-hal.h"
+#include "i2c-hal.h"
+#include "ds3231.h"
+#include "max7219.h"
+
+#define BENCH_RUNS 16
+#define BENCH_BAUD 115200UL
+
+typedef struct
+{
+	uint32_t min;
+	uint32_t max;
+	uint32_t total;
+} bench_t;
+
+/* Time one call; the UART is drained first so its ISR cannot interfere */
+#define BENCH(b, call)                                   \
+	do                                                   \
+	{                                                    \
+		uart_drain();                                    \
+		uint32_t t0 = HAL_TRACE_Cycles();                \
+		call;                                            \
+		bench_add(&(b), HAL_TRACE_Cycles() - t0);        \
+	} while(0)
+
+static uint32_t bench_overhead = 0;
+static char line[72];
+
+static void bench_clear(bench_t* b);
+static void bench_add(bench_t* b, uint32_t cycles);
+static void bench_report(const char* name, uint16_t bytes, const bench_t* b);
+#if HAL_TRACE_USE
+static void bench_trace(const char* name, uint8_t id);
+#endif
+
+static void uart_print(const char* s);
+static void uart_drain(void);
+
+int main(void)
+{
+	static const uint8_t sizes[] = {1, 16, 64};
+	static const uint8_t i2c_sizes[] = {1, 4, 8};
+
+	HAL_UART_Config_t cfg = {BENCH_BAUD, 8, HAL_UART_PARITY_NONE, 1, HAL_UART_U2X_AUTO};
+	unsigned char payload[64];
+	unsigned char alarm[8] = {DS3231_REG_ALM1_SEC};
+	unsigned char digits[9] = {0};
+	DS3231_Datetime_t now;
+	MAX_Chain_t panel;
+	bench_t b;
+
+	HAL_UART_InitConfig(&cfg);
+	HAL_TRACE_Init();
+	DS3231_Init();
+
+	sei();
+
+	/* Cost of the two HAL_TRACE_Cycles calls themselves */
+	bench_overhead = 0;
+	bench_clear(&b);
+	for(uint8_t i = 0; i < BENCH_RUNS; ++i) BENCH(b, );
+	bench_overhead = b.min;
+
+	sprintf(line, "\r\nuc-Microlab HAL benchmark, %u runs, overhead %lu cycles\r\n", BENCH_RUNS, bench_overhead);
+	uart_print(line);
+	sprintf(line, "%-20s %6s %8s %8s %8s %9s\r\n", "call", "bytes", "min", "avg", "max", "bytes/s");
+	uart_print(line);
+
+	/* Spaces ending in CR: the measured output leaves the table readable */
+	memset(payload, ' ', sizeof(payload));
+
+	for(uint8_t s = 0; s < sizeof(sizes); ++s)
+	{
+		payload[sizes[s] - 1] = '\r';
+
+		bench_clear(&b);
+		for(uint8_t i = 0; i < BENCH_RUNS; ++i) BENCH(b, HAL_UART_Send(payload, sizes[s]));
+		bench_report("uart send", sizes[s], &b);
+
+		payload[sizes[s] - 1] = ' ';
+	}
+
+	for(uint8_t s = 0; s < sizeof(i2c_sizes); ++s)
+	{
+		bench_clear(&b);
+		for(uint8_t i = 0; i < BENCH_RUNS; ++i) BENCH(b, HAL_I2C_ControllerTransmit(DS3231_ADDR, alarm, i2c_sizes[s]));
+		bench_report("i2c transmit", i2c_sizes[s], &b);
+	}
+
+	{
+		HAL_I2C_Transaction_t t = {DS3231_ADDR, alarm, sizeof(alarm), NULL, 0, NULL, NULL, HAL_I2C_ST_OK, NULL};
+		bench_t done;
+
+		bench_clear(&b);
+		bench_clear(&done);
+
+		for(uint8_t i = 0; i < BENCH_RUNS; ++i)
+		{
+			uart_drain();
+
+			uint32_t t0 = HAL_TRACE_Cycles();
+			HAL_I2C_Submit(&t);
+			bench_add(&b, HAL_TRACE_Cycles() - t0);
+			HAL_I2C_Wait(&t);
+			bench_add(&done, HAL_TRACE_Cycles() - t0);
+		}
+
+		bench_report("i2c submit", sizeof(alarm), &b);
+		bench_report("i2c submit + wait", sizeof(alarm), &done);
+	}
+
+	bench_clear(&b);
+	for(uint8_t i = 0; i < BENCH_RUNS; ++i) BENCH(b, DS3231_GetTime(&now));
+	bench_report("ds3231 get time", 7, &b);
+
+	MAX_ChainInit(&panel, 1, &PORTB, &DDRB, PB2);
+
+	bench_clear(&b);
+	for(uint8_t i = 0; i < BENCH_RUNS; ++i) BENCH(b, MAX_ChainRefresh(&panel));
+	bench_report("max chain refresh", 16, &b);
+
+	MAX_Init();
+
+	bench_clear(&b);
+	for(uint8_t i = 0; i < BENCH_RUNS; ++i) BENCH(b, MAX_SendData(digits));
+	bench_report("max send data", 16, &b);
+
+#if HAL_TRACE_USE
+	sprintf(line, "\r\n%-20s %8s %8s %8s %8s\r\n", "interrupt", "count", "min", "avg", "max");
+	uart_print(line);
+	bench_trace("TWI_vect", HAL_TRACE_ID_I2C);
+	bench_trace("SPI_STC_vect", HAL_TRACE_ID_SPI);
+	bench_trace("USART_UDRE_vect", HAL_TRACE_ID_UART_TX);
+	bench_trace("USART_RX_vect", HAL_TRACE_ID_UART_RX);
+	bench_trace("ADC_vect", HAL_TRACE_ID_ADC);
+#endif
+
+    while(1)
+    {
+    }
+}
+
+static void bench_clear(bench_t* b)
+{
+	b->min   = 0xFFFFFFFFUL;
+	b->max   = 0;
+	b->total = 0;
+}
+
+static void bench_add(bench_t* b, uint32_t cycles)
+{
+	cycles = (cycles > bench_overhead) ? cycles - bench_overhead : 0;
+
+	if(cycles < b->min) b->min = cycles;
+	if(cycles > b->max) b->max = cycles;
+	b->total += cycles;
+}
+
+/*
+ * One table row. bytes * F_CPU stays below 2^32 for payloads up to 268
+ * bytes, so the throughput fits 32-bit arithmetic.
+ */
+static void bench_report(const char* name, uint16_t bytes, const bench_t* b)
+{
+	uint32_t avg  = b->total / BENCH_RUNS;
+	uint32_t rate = avg ? ((uint32_t) bytes * F_CPU) / avg : 0;
+
+	sprintf(line, "%-20s %6u %8lu %8lu %8lu %9lu\r\n", name, bytes, b->min, avg, b->max, rate);
+	uart_print(line);
+}
+
+#if HAL_TRACE_USE
+static void bench_trace(const char* name, uint8_t id)
+{
+	HAL_TRACE_Stat_t s;
+
+	HAL_TRACE_Get(id, &s);
+	if(s.count == 0) s.min = 0;
+
+	sprintf(line, "%-20s %8u %8u %8lu %8u\r\n", name, s.count, s.min, s.count ? s.total / s.count : 0UL, s.max);
+	uart_print(line);
+}
+#endif
+
+static void uart_print(const char* s)
+{
+	HAL_UART_Send((unsigned char*) s, strlen(s));
+}
+
+/*
+ * Wait until the last queued byte has left the transmitter: the TX ring
+ * is empty (UDRIE0 cleared in ISR mode), UDR0 is free and one more frame
+ * time has passed for the shift register.
+ */
+static void uart_drain(void)
+{
+	while(UCSR0B & (1 << UDRIE0));
+	while(!(UCSR0A & (1 << UDRE0)));
+
+	_delay_us(100);
+}
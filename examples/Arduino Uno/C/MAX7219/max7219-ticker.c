@@ -0,0 +1,87 @@
+/*
+  uc-Microlab Example: MAX7219 scrolling ticker
+  Repository: uc-Microlab
+
+  Description:
+    Scrolls a message across a 32×8 LED panel made of four cascaded
+    MAX7219 8×8 modules, one column every 20 ms (50 steps per second).
+    The ticker shifts the framebuffer in place and MAX_Flush only sends
+    the rows that changed. Each time the message has left the panel it is
+    rebuilt with the current uptime before it enters again.
+
+    Expected calls shown:
+      - MAX_ChainInit, MAX_ChainDecodeMode, MAX_ChainScanDigits,
+        MAX_ChainSetIntensity, MAX_ChainNormalOperation, MAX_Flush;
+      - MAX_FONT_TickerInit, MAX_FONT_TickerStep;
+      - SCHED_Init, SCHED_Run, SCHED_Millis.
+
+  Hardware: uc-Microlab — version r1
+  Target MCU: ATmega328P (Arduino Uno compatible)
+
+  Connections:
+    - SPI MOSI (MCU PB3 / MOSI, Arduino D11) -> panel DIN
+    - SPI SCK  (MCU PB5 / SCK, Arduino D13)  -> panel CLK
+    - LOAD     (MCU PB2 / SS, Arduino D10)   -> panel CS
+    - Panel VCC -> 5 V (up to 1 A at full brightness), GND -> GND
+
+  Build notes / usage:
+    - Add spi-hal.c, port-hal.c, max7219.c, max7219-font.c, ctc-hal.c and
+      sched.c to the project source files.
+    - The panel input (DIN) is the rightmost module. For modules that show
+      the text mirrored, define MAX_FONT_MSB_LEFT=0.
+    - SPDX-License-Identifier: MIT — see repository LICENSE for full terms.
+
+  Author: otavioacb
+  Date: 2026-10-14
+*/
+
+#define F_CPU 16000000UL
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include <stdio.h>
+
+#include "max7219.h"
+#include "max7219-font.h"
+#include "sched.h"
+
+#define PANEL_MODULES 4
+
+static MAX_Chain_t panel;
+static MAX_FONT_Ticker_t ticker;
+static char message[40];
+
+static void ticker_step(void* ctx)
+{
+	if(MAX_FONT_TickerStep(&panel, &ticker))
+	{
+		snprintf(message, sizeof(message), "uc-MicroLab  up %lu s", (unsigned long) (SCHED_Millis() / 1000));
+	}
+
+	MAX_Flush(&panel);
+}
+
+static const SCHED_Task_t tasks[] =
+{
+	{ticker_step, NULL, 20, 0, 20},
+};
+
+int main(void)
+{
+	MAX_ChainInit(&panel, PANEL_MODULES, &PORTB, &DDRB, PB2);
+	MAX_ChainDecodeMode(&panel, MAX_CHAIN_ALL, MAX_DEC_NOD);
+	MAX_ChainScanDigits(&panel, MAX_CHAIN_ALL, 0x07);
+	MAX_ChainSetIntensity(&panel, MAX_CHAIN_ALL, 0x02);
+	MAX_ChainNormalOperation(&panel, MAX_CHAIN_ALL);
+	MAX_Flush(&panel);
+
+	snprintf(message, sizeof(message), "uc-MicroLab");
+	MAX_FONT_TickerInit(&ticker, message);
+
+	SCHED_Init(tasks, sizeof(tasks) / sizeof(tasks[0]));
+
+	sei();
+
+	SCHED_Run();
+}
@@ -0,0 +1,81 @@
+/*
+  uc-Microlab Example: RGB colour fades
+  Repository: uc-Microlab
+
+  Description:
+    Cycles the RGB LED through red, green, blue and white with one-second
+    fades. The RGB driver (rgb-led.h) gamma-corrects every colour and runs
+    the fade from the Timer1 overflow interrupt, so the main loop only
+    picks the next colour once the current fade has finished. If the
+    driver cannot get the Timer1 overflow (HAL_PWM_TIMER1_ISR missing),
+    the red LED lights steadily instead.
+
+    Expected calls shown:
+      - RGB_Init, RGB_FadeTo, RGB_IsFading.
+
+  Hardware: uc-Microlab — version r1
+  Target MCU: ATmega328P (Arduino Uno compatible)
+
+  Connections:
+    - Red   (MCU PB1 / OC1A, Arduino D9)  -> 330 R -> LED anode R
+    - Green (MCU PB2 / OC1B, Arduino D10) -> 330 R -> LED anode G
+    - Blue  (MCU PB3 / OC2A, Arduino D11) -> 330 R -> LED anode B
+    - LED common cathode -> GND
+
+  Build notes / usage:
+    - Add pwm-hal.c and rgb-led.c to the project source files (the error
+      LED uses the header-only HAL_PIN_* macros of port-hal.h).
+    - Required: define HAL_PWM_TIMER1_ISR=1 in the project compiler
+      symbols so pwm-hal serves the Timer1 overflow used by the driver.
+      Without it RGB_Init returns 0 and nothing fades.
+    - SPDX-License-Identifier: MIT — see repository LICENSE for full terms.
+
+  Author: otavioacb
+  Date: 2026-10-14
+*/
+
+#define F_CPU 16000000UL
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "rgb-led.h"
+#include "port-hal.h"
+
+/* Red channel, Arduino D9: lit directly when RGB_Init fails */
+#define RED_PIN B, 1
+
+/* About 1 s per fade: 250 steps of 2 PWM periods at 490 Hz */
+#define FADE_STEPS 250
+
+static const uint8_t colours[][3] =
+{
+	{255,   0,   0},
+	{  0, 255,   0},
+	{  0,   0, 255},
+	{255, 255, 255},
+};
+
+int main(void)
+{
+	uint8_t next = 0;
+
+	if(!RGB_Init())
+	{
+		HAL_PIN_OUTPUT(RED_PIN);
+		HAL_PIN_SET(RED_PIN);
+
+		while(1);
+	}
+
+	sei();
+
+    while(1)
+    {
+		if(!RGB_IsFading())
+		{
+			RGB_FadeTo(colours[next][0], colours[next][1], colours[next][2], FADE_STEPS);
+			next = (next + 1) % (sizeof(colours) / sizeof(colours[0]));
+		}
+    }
+}
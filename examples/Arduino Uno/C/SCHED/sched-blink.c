@@ -0,0 +1,78 @@
+/*
+  uc-Microlab Example: Cooperative scheduler
+  Repository: uc-Microlab
+
+  Description:
+    Blinks the on-board LED every 500 ms and prints the uptime over UART
+    once per second without any _delay_ms call. Both jobs are periodic
+    tasks of the cooperative scheduler (sched.h); between them the CPU
+    sleeps in idle mode, woken by the 1 ms Timer0 tick.
+
+    Expected calls shown:
+      - HAL_UART_Init(unsigned int baud_rate);
+      - SCHED_Init, SCHED_Run, SCHED_Millis.
+
+  Hardware: uc-Microlab — version r1
+  Target MCU: ATmega328P (Arduino Uno compatible)
+
+  Connections:
+    - LED (MCU PB5, Arduino D13) -> on-board LED
+    - UART TX (MCU PD1 / TXD0) -> serial adapter RX
+
+  Build notes / usage:
+    - Add uart-hal.c, ctc-hal.c and sched.c to the project source files
+      (the LED uses the header-only HAL_PIN_* macros of port-hal.h).
+    - Define HAL_UART_USE_ISR=1 in the project compiler symbols so the
+      report is sent from the UART interrupt instead of inside the task.
+    - Serial monitor settings: 9600 baud, 8N1.
+    - SPDX-License-Identifier: MIT — see repository LICENSE for full terms.
+
+  Author: otavioacb
+  Date: 2026-10-14
+*/
+
+#define F_CPU 16000000UL
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "uart-hal.h"
+#include "port-hal.h"
+#include "sched.h"
+
+/* On-board LED, Arduino D13 */
+#define LED_PIN B, 5
+
+static void blink(void* ctx)
+{
+	HAL_PIN_TOGGLE(LED_PIN);
+}
+
+static void report(void* ctx)
+{
+	char msg[32];
+
+	snprintf(msg, sizeof(msg), "uptime: %lu ms\n", (unsigned long) SCHED_Millis());
+	HAL_UART_TrySend((const unsigned char*) msg, strlen(msg));
+}
+
+static const SCHED_Task_t tasks[] =
+{
+	{blink,  NULL, 500,  0,   0},
+	{report, NULL, 1000, 250, 0},
+};
+
+int main(void)
+{
+	HAL_UART_Init(9600);
+	HAL_PIN_OUTPUT(LED_PIN);
+
+	SCHED_Init(tasks, sizeof(tasks) / sizeof(tasks[0]));
+
+	sei();
+
+	SCHED_Run();
+}
@@ -0,0 +1,494 @@
+/*
+ * uc-Microlab — MAX7219 Text Rendering (header)
+ * File: max7219-font.h / max7219-font.c
+ *
+ * Project: uc-MicroLab
+ * Component: 7-segment and dot-matrix text rendering for MAX7219 chains
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Optional rendering layer on top of the MAX7219 chain API (max7219.h).
+ *   Text and numbers are drawn straight into the chain framebuffer from
+ *   two font tables kept in flash: a 7-segment table for digit displays
+ *   running in no-decode mode and a 5×7 column font for 8×8 LED matrices.
+ *   No intermediate pixel buffer is used; only the framebuffer cells that
+ *   change are written, so the dirty-row tracking of MAX_Flush sends just
+ *   the rows that were touched. Numbers are converted to decimal by
+ *   subtracting a table of powers of ten, without a division loop. A
+ *   matrix panel scrolls by shifting the framebuffer one column to the
+ *   left in place, carrying the bits from module to module, and a ticker
+ *   feeds the columns of a text into that scroll one step at a time.
+ *
+ * Public API:
+ *   uint8_t MAX_FONT_Segments(char c);
+ *     7-segment pattern of c in no-decode bit order (DP A B C D E F G,
+ *     bit 7 to bit 0). Digits, letters (mixed case where the display
+ *     allows it) and a few symbols are covered; other characters are
+ *     blank.
+ *
+ *   uint8_t MAX_FONT_Glyph(char c, uint8_t col);
+ *     Column col (0 to MAX_FONT_WIDTH - 1) of the 5×7 glyph of c, bit n =
+ *     row n (row 0 at the top). Printable ASCII is covered; other
+ *     characters show as '?'. Returns 0 for col >= MAX_FONT_WIDTH.
+ *
+ *   7-segment displays (one digit per row, position 0 = leftmost digit):
+ *   uint8_t MAX_FONT_PutText7(MAX_Chain_t* chain, uint8_t pos, const char* s);
+ *     Write s to the digits starting at position pos. A '.' lights the
+ *     decimal point of the digit before it instead of taking a position.
+ *     Characters beyond the last digit are dropped. Returns the position
+ *     after the text.
+ *
+ *   uint8_t MAX_FONT_PutNumber7(MAX_Chain_t* chain,
+ *                               uint8_t pos,
+ *                               uint8_t width,
+ *                               int32_t value,
+ *                               uint8_t flags);
+ *     Write value right-aligned in the width digits starting at pos.
+ *     flags: MAX_FONT_FRAC(n) shows the last n digits after a decimal
+ *     point (value is then a fixed-point number, e.g. 2375 with
+ *     MAX_FONT_FRAC(2) shows 23.75), MAX_FONT_ZERO_PAD fills the field
+ *     with leading zeros instead of blanks. Returns 1, or 0 when the
+ *     number does not fit; the field then shows dashes.
+ *
+ *   Dot-matrix panels (column 0 = leftmost column of the panel):
+ *   int16_t MAX_FONT_DrawText(MAX_Chain_t* chain, int16_t x, const char* s);
+ *     Draw s with its first column at panel column x, MAX_FONT_SPACING
+ *     blank columns after every glyph. Columns outside the panel are
+ *     clipped, so x may be negative. Every drawn column covers all eight
+ *     rows. Returns the column after the text.
+ *
+ *   int16_t MAX_FONT_DrawNumber(MAX_Chain_t* chain, int16_t x, int32_t value);
+ *     Draw value in decimal like MAX_FONT_DrawText.
+ *
+ *   uint16_t MAX_FONT_TextWidth(const char* s);
+ *     Number of columns MAX_FONT_DrawText advances for s.
+ *
+ *   void MAX_FONT_ScrollLeft(MAX_Chain_t* chain, uint8_t column);
+ *     Shift the whole panel one column to the left and fill the rightmost
+ *     column with column (bit n = row n). Rows that do not change are not
+ *     marked dirty.
+ *
+ *   void MAX_FONT_TickerInit(MAX_FONT_Ticker_t* t, const char* text);
+ *     Start a ticker for text. The text is not copied and must stay valid
+ *     while the ticker runs.
+ *
+ *   uint8_t MAX_FONT_TickerStep(MAX_Chain_t* chain, MAX_FONT_Ticker_t* t);
+ *     Scroll the panel one column and feed in the next column of the text.
+ *     After the last glyph the panel is scrolled empty and the ticker
+ *     starts over. Returns 1 on the step that restarts it, 0 otherwise.
+ *
+ * Public types:
+ *   MAX_FONT_Ticker_t
+ *     Ticker state, owned by the application and set up with
+ *     MAX_FONT_TickerInit:
+ *       const char* text — text being scrolled
+ *       const char* next — character whose columns are being fed in
+ *       uint8_t     col  — next column of that character (including the
+ *                          spacing columns)
+ *       uint8_t     tail — blank columns fed in after the end of the text
+ *
+ * Public constants:
+ *   MAX_FONT_WIDTH      - glyph width of the matrix font in columns (5)
+ *   MAX_FONT_ZERO_PAD   - MAX_FONT_PutNumber7 flag: pad with zeros
+ *   MAX_FONT_FRAC(n)    - MAX_FONT_PutNumber7 flag: n (0 to 7) digits after
+ *                         the decimal point
+ *
+ * Configuration (compile-time, define before building max7219-font.c):
+ *   MAX_FONT_SPACING  - blank columns between matrix glyphs (default 1).
+ *   MAX_FONT_MSB_LEFT - 1 (default): bit 7 of a digit register is the
+ *                       leftmost column of its module, as on the common
+ *                       FC-16 modules. 0 for modules wired mirrored.
+ *
+ * Usage:
+ *   - Include this header where text output is required:
+ *       #include "max7219-font.h"
+ *
+ *   - Temperature on an 8-digit 7-segment module (no-decode mode):
+ *       static MAX_Chain_t disp;
+ *       DS3231_Snapshot_t s;
+ *
+ *       MAX_ChainInit(&disp, 1, &PORTB, &DDRB, PB2);
+ *       MAX_ChainDecodeMode(&disp, MAX_CHAIN_ALL, MAX_DEC_NOD);
+ *       MAX_ChainScanDigits(&disp, MAX_CHAIN_ALL, 0x07);
+ *       MAX_ChainNormalOperation(&disp, MAX_CHAIN_ALL);
+ *
+ *       DS3231_Snapshot(&s);
+ *       MAX_FONT_PutText7(&disp, 0, "t");
+ *       MAX_FONT_PutNumber7(&disp, 1, 6, s.temp_q2 * 25, MAX_FONT_FRAC(2));
+ *       MAX_FONT_PutText7(&disp, 7, "*");     // degree sign
+ *       MAX_Flush(&disp);
+ *
+ *   - Scrolling ticker on four 8×8 modules, one column every 20 ms:
+ *       static MAX_Chain_t panel;
+ *       static MAX_FONT_Ticker_t ticker;
+ *
+ *       MAX_ChainInit(&panel, 4, &PORTB, &DDRB, PB2);
+ *       ...
+ *       MAX_FONT_TickerInit(&ticker, "uc-MicroLab");
+ *
+ *       while(1)
+ *       {
+ *           MAX_FONT_TickerStep(&panel, &ticker);
+ *           MAX_Flush(&panel);
+ *           _delay_ms(20);
+ *       }
+ *
+ *   - Static label, centred:
+ *       MAX_ChainClear(&panel);
+ *       MAX_FONT_DrawText(&panel, (32 - MAX_FONT_TextWidth("12:30")) / 2, "12:30");
+ *       MAX_Flush(&panel);
+ *
+ * Notes:
+ *   - Device 0 (the one wired to the MCU) is taken as the rightmost module
+ *     or digit group, and digit register 1 of a 7-segment module as its
+ *     rightmost digit; position 0 is digit 7 of device devices - 1.
+ *   - 7-segment devices must be in no-decode mode (MAX_DEC_NOD): the
+ *     patterns are raw segment bits. '*' maps to a degree sign; letters
+ *     such as K, M, V, W and X are only approximations.
+ *   - The 5×7 glyphs leave row 7 blank. The ticker never sets it, so that
+ *     row is not resent while scrolling; a step of a 4-module panel costs
+ *     at most seven 8-byte bursts plus about 40 shifts, well under a
+ *     millisecond at the default SPI clock, which leaves room for far more
+ *     than 50 steps per second.
+ *   - Numbers are converted by repeated subtraction of powers of ten: at
+ *     most 9 subtractions per digit, constant code size, no 32-bit
+ *     division routine pulled in from libgcc.
+ *   - The font and power-of-ten tables take about 610 bytes of flash and
+ *     no RAM.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for MAX7219 text rendering
+ *
+ */
+
+#include "max7219-font.h"
+
+#include <avr/pgmspace.h>
+
+#define MAX_FONT_FIRST 0x20   /* First character of the tables */
+#define MAX_FONT_LAST  0x7E   /* Last printable character      */
+#define MAX_FONT_DP    0x80   /* Decimal point segment         */
+
+#if MAX_FONT_MSB_LEFT
+	#define MAX_FONT_COL_MASK(x) (0x80 >> ((x) & 0x07))
+#else
+	#define MAX_FONT_COL_MASK(x) (0x01 << ((x) & 0x07))
+#endif
+
+/* Segment bits DP A B C D E F G, characters 0x20 to 0x7F */
+static const uint8_t max_font_seg[96] PROGMEM =
+{
+	0x00, 0xA0, 0x22, 0x00, 0x5B, 0x00, 0x00, 0x02, 0x4E, 0x78, 0x63, 0x00, 0x80, 0x01, 0x80, 0x25,
+	0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70, 0x7F, 0x7B, 0x00, 0x00, 0x00, 0x09, 0x00, 0x65,
+	0x00, 0x77, 0x1F, 0x4E, 0x3D, 0x4F, 0x47, 0x5E, 0x37, 0x06, 0x38, 0x57, 0x0E, 0x54, 0x76, 0x7E,
+	0x67, 0x73, 0x05, 0x5B, 0x0F, 0x3E, 0x1C, 0x2A, 0x37, 0x3B, 0x6D, 0x4E, 0x13, 0x78, 0x62, 0x08,
+	0x20, 0x7D, 0x1F, 0x0D, 0x3D, 0x6F, 0x47, 0x7B, 0x17, 0x04, 0x18, 0x57, 0x06, 0x54, 0x15, 0x1D,
+	0x67, 0x73, 0x05, 0x5B, 0x0F, 0x1C, 0x1C, 0x2A, 0x37, 0x3B, 0x6D, 0x4E, 0x06, 0x78, 0x40, 0x00,
+};
+
+/* 5×7 glyphs, one byte per column from the left, bit n = row n */
+static const uint8_t max_font_5x7[95][MAX_FONT_WIDTH] PROGMEM =
+{
+	{0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, /*   ! " */
+	{0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, /* # $ % */
+	{0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00}, /* & ' ( */
+	{0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08}, /* ) * + */
+	{0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, /* , - . */
+	{0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, /* / 0 1 */
+	{0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10}, /* 2 3 4 */
+	{0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, /* 5 6 7 */
+	{0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, /* 8 9 : */
+	{0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, /* ; < = */
+	{0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E}, /* > ? @ */
+	{0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, /* A B C */
+	{0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01}, /* D E F */
+	{0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, /* G H I */
+	{0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40}, /* J K L */
+	{0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, /* M N O */
+	{0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, /* P Q R */
+	{0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, /* S T U */
+	{0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63}, /* V W X */
+	{0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, /* Y Z [ */
+	{0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, /* \ ] ^ */
+	{0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, /* _ ` a */
+	{0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F}, /* b c d */
+	{0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x54, 0x54, 0x54, 0x3C}, /* e f g */
+	{0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, /* h i j */
+	{0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, /* k l m */
+	{0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08}, /* n o p */
+	{0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, /* q r s */
+	{0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, /* t u v */
+	{0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, /* w x y */
+	{0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00}, /* z { | */
+	{0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},                                 /* } ~   */
+};
+
+static const uint32_t max_font_pow10[10] PROGMEM =
+{
+	1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+	10000UL, 1000UL, 100UL, 10UL, 1UL,
+};
+
+static uint8_t max_font_decimal(uint32_t value, char* out);
+static uint8_t max_font_format(int32_t value, char* out);
+static void max_font_put7(MAX_Chain_t* chain, uint8_t pos, uint8_t seg);
+static void max_font_put_column(MAX_Chain_t* chain, int16_t x, uint8_t bits);
+
+uint8_t MAX_FONT_Segments(char c)
+{
+	uint8_t i = (uint8_t) c;
+
+	if(i < MAX_FONT_FIRST || i > 0x7F) return 0x00;
+
+	return pgm_read_byte(&max_font_seg[i - MAX_FONT_FIRST]);
+}
+
+uint8_t MAX_FONT_Glyph(char c, uint8_t col)
+{
+	uint8_t i = (uint8_t) c;
+
+	if(col >= MAX_FONT_WIDTH) return 0x00;
+	if(i < MAX_FONT_FIRST || i > MAX_FONT_LAST) i = '?';
+
+	return pgm_read_byte(&max_font_5x7[i - MAX_FONT_FIRST][col]);
+}
+
+/*
+ * A '.' is folded into the digit before it, so "12.5" takes three
+ * positions; a second '.' in a row, or one at pos, gets its own digit.
+ * Writing stops at the end of the chain, so pos never wraps.
+ */
+uint8_t MAX_FONT_PutText7(MAX_Chain_t* chain, uint8_t pos, const char* s)
+{
+	uint8_t start = pos;
+	uint8_t end = chain->devices * MAX_ROWS;
+	uint8_t dot = 1;
+
+	for(; *s && pos < end; ++s)
+	{
+		if(*s == '.' && !dot && pos > start)
+		{
+			max_font_put7(chain, pos - 1, MAX_FONT_Segments(s[-1]) | MAX_FONT_DP);
+			dot = 1;
+			continue;
+		}
+
+		max_font_put7(chain, pos++, MAX_FONT_Segments(*s));
+		dot = 0;
+	}
+
+	/* A '.' right after the last digit still belongs to it */
+	if(*s == '.' && !dot && pos > start) max_font_put7(chain, pos - 1, MAX_FONT_Segments(s[-1]) | MAX_FONT_DP);
+
+	return pos;
+}
+
+uint8_t MAX_FONT_PutNumber7(MAX_Chain_t* chain, uint8_t pos, uint8_t width, int32_t value, uint8_t flags)
+{
+	char buf[10];
+	uint8_t neg  = (value < 0);
+	uint8_t mag  = max_font_decimal(neg ? 0UL - (uint32_t) value : (uint32_t) value, buf);
+	uint8_t frac = flags & MAX_FONT_FRAC(0xFF);
+	uint8_t n    = (mag > frac) ? mag : frac + 1;
+	uint8_t end  = pos + width;
+
+	if(n + neg > width)
+	{
+		while(pos < end) max_font_put7(chain, pos++, MAX_FONT_Segments('-'));
+		return 0;
+	}
+
+	if(flags & MAX_FONT_ZERO_PAD)
+	{
+		if(neg) max_font_put7(chain, pos++, MAX_FONT_Segments('-'));
+		n = end - pos;
+	}
+	else
+	{
+		while(pos < end - n - neg) max_font_put7(chain, pos++, 0x00);
+		if(neg) max_font_put7(chain, pos++, MAX_FONT_Segments('-'));
+	}
+
+	/* n digits left: leading zeros, then the significant digits */
+	for(uint8_t i = n; i > 0; --i)
+	{
+		uint8_t seg = MAX_FONT_Segments(i > mag ? '0' : buf[mag - i]);
+
+		if(frac && i == frac + 1) seg |= MAX_FONT_DP;
+		max_font_put7(chain, pos++, seg);
+	}
+
+	return 1;
+}
+
+int16_t MAX_FONT_DrawText(MAX_Chain_t* chain, int16_t x, const char* s)
+{
+	for(; *s; ++s)
+	{
+		for(uint8_t col = 0; col < MAX_FONT_WIDTH + MAX_FONT_SPACING; ++col)
+			max_font_put_column(chain, x++, MAX_FONT_Glyph(*s, col));
+	}
+
+	return x;
+}
+
+int16_t MAX_FONT_DrawNumber(MAX_Chain_t* chain, int16_t x, int32_t value)
+{
+	char buf[12];
+
+	buf[max_font_format(value, buf)] = '\0';
+
+	return MAX_FONT_DrawText(chain, x, buf);
+}
+
+uint16_t MAX_FONT_TextWidth(const char* s)
+{
+	uint16_t width = 0;
+
+	while(*s++) width += MAX_FONT_WIDTH + MAX_FONT_SPACING;
+
+	return width;
+}
+
+/*
+ * Device 0 is the rightmost module: walking from device 0 up, the column
+ * pushed out of the left edge of one module enters the right edge of the
+ * next one.
+ */
+void MAX_FONT_ScrollLeft(MAX_Chain_t* chain, uint8_t column)
+{
+	for(uint8_t row = 0; row < MAX_ROWS; ++row)
+	{
+		uint8_t* line  = &chain->fb[row * chain->devices];
+		uint8_t  carry = (column >> row) & 0x01;
+		uint8_t  diff  = 0;
+
+		for(uint8_t d = 0; d < chain->devices; ++d)
+		{
+			uint8_t old = line[d];
+
+#if MAX_FONT_MSB_LEFT
+			line[d] = (uint8_t) (old << 1) | carry;
+			carry   = old >> 7;
+#else
+			line[d] = (old >> 1) | (uint8_t) (carry << 7);
+			carry   = old & 0x01;
+#endif
+			diff |= old ^ line[d];
+		}
+
+		if(diff) chain->dirty |= (1 << row);
+	}
+}
+
+void MAX_FONT_TickerInit(MAX_FONT_Ticker_t* t, const char* text)
+{
+	t->text = text;
+	t->next = text;
+	t->col  = 0;
+	t->tail = 0;
+}
+
+/*
+ * Once the text has been fed in, one panel width of blank columns follows
+ * so the last glyph leaves the panel before the text enters again.
+ */
+uint8_t MAX_FONT_TickerStep(MAX_Chain_t* chain, MAX_FONT_Ticker_t* t)
+{
+	uint8_t column = 0x00;
+	uint8_t wrapped = 0;
+
+	if(*t->next)
+	{
+		column = MAX_FONT_Glyph(*t->next, t->col);
+
+		if(++t->col >= MAX_FONT_WIDTH + MAX_FONT_SPACING)
+		{
+			t->col = 0;
+			++t->next;
+		}
+	}
+	else if(++t->tail >= chain->devices * MAX_ROWS)
+	{
+		t->tail = 0;
+		t->next = t->text;
+		wrapped = 1;
+	}
+
+	MAX_FONT_ScrollLeft(chain, column);
+
+	return wrapped;
+}
+
+/*
+ * Decimal digits of value without leading zeros ("0" for 0), returned
+ * count. Each power of ten is subtracted at most 9 times (4 for 10^9).
+ */
+static uint8_t max_font_decimal(uint32_t value, char* out)
+{
+	uint8_t n = 0;
+
+	for(uint8_t i = 0; i < 10; ++i)
+	{
+		uint32_t p = pgm_read_dword(&max_font_pow10[i]);
+		char digit = '0';
+
+		while(value >= p)
+		{
+			value -= p;
+			++digit;
+		}
+
+		if(digit != '0' || n != 0 || i == 9) out[n++] = digit;
+	}
+
+	return n;
+}
+
+/* Signed decimal text of value, not terminated; returns its length */
+static uint8_t max_font_format(int32_t value, char* out)
+{
+	if(value >= 0) return max_font_decimal((uint32_t) value, out);
+
+	out[0] = '-';
+
+	return 1 + max_font_decimal(0UL - (uint32_t) value, out + 1);
+}
+
+/* Position 0 is the leftmost digit: row 7 of device devices - 1 */
+static void max_font_put7(MAX_Chain_t* chain, uint8_t pos, uint8_t seg)
+{
+	MAX_ChainSetRow(chain, chain->devices - 1 - (pos >> 3), 7 - (pos & 0x07), seg);
+}
+
+/*
+ * Write the 8 pixels of panel column x, bit n = row n. Only the cells that
+ * change are written and their rows marked dirty; columns outside the
+ * panel are ignored.
+ */
+static void max_font_put_column(MAX_Chain_t* chain, int16_t x, uint8_t bits)
+{
+	if(x < 0 || x >= chain->devices * MAX_ROWS) return;
+
+	uint8_t dev  = chain->devices - 1 - (uint8_t) (x >> 3);
+	uint8_t mask = MAX_FONT_COL_MASK(x);
+
+	for(uint8_t row = 0; row < MAX_ROWS; ++row, bits >>= 1)
+	{
+		uint8_t* cell = &chain->fb[row * chain->devices + dev];
+		uint8_t value = (bits & 0x01) ? (*cell | mask) : (*cell & ~mask);
+
+		if(*cell == value) continue;
+
+		*cell = value;
+		chain->dirty |= (1 << row);
+	}
+}
@@ -0,0 +1,218 @@
+/*
+ * uc-Microlab — MAX7219 Text Rendering (header)
+ * File: max7219-font.h / max7219-font.c
+ *
+ * Project: uc-MicroLab
+ * Component: 7-segment and dot-matrix text rendering for MAX7219 chains
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Optional rendering layer on top of the MAX7219 chain API (max7219.h).
+ *   Text and numbers are drawn straight into the chain framebuffer from
+ *   two font tables kept in flash: a 7-segment table for digit displays
+ *   running in no-decode mode and a 5×7 column font for 8×8 LED matrices.
+ *   No intermediate pixel buffer is used; only the framebuffer cells that
+ *   change are written, so the dirty-row tracking of MAX_Flush sends just
+ *   the rows that were touched. Numbers are converted to decimal by
+ *   subtracting a table of powers of ten, without a division loop. A
+ *   matrix panel scrolls by shifting the framebuffer one column to the
+ *   left in place, carrying the bits from module to module, and a ticker
+ *   feeds the columns of a text into that scroll one step at a time.
+ *
+ * Public API:
+ *   uint8_t MAX_FONT_Segments(char c);
+ *     7-segment pattern of c in no-decode bit order (DP A B C D E F G,
+ *     bit 7 to bit 0). Digits, letters (mixed case where the display
+ *     allows it) and a few symbols are covered; other characters are
+ *     blank.
+ *
+ *   uint8_t MAX_FONT_Glyph(char c, uint8_t col);
+ *     Column col (0 to MAX_FONT_WIDTH - 1) of the 5×7 glyph of c, bit n =
+ *     row n (row 0 at the top). Printable ASCII is covered; other
+ *     characters show as '?'. Returns 0 for col >= MAX_FONT_WIDTH.
+ *
+ *   7-segment displays (one digit per row, position 0 = leftmost digit):
+ *   uint8_t MAX_FONT_PutText7(MAX_Chain_t* chain, uint8_t pos, const char* s);
+ *     Write s to the digits starting at position pos. A '.' lights the
+ *     decimal point of the digit before it instead of taking a position.
+ *     Characters beyond the last digit are dropped. Returns the position
+ *     after the text.
+ *
+ *   uint8_t MAX_FONT_PutNumber7(MAX_Chain_t* chain,
+ *                               uint8_t pos,
+ *                               uint8_t width,
+ *                               int32_t value,
+ *                               uint8_t flags);
+ *     Write value right-aligned in the width digits starting at pos.
+ *     flags: MAX_FONT_FRAC(n) shows the last n digits after a decimal
+ *     point (value is then a fixed-point number, e.g. 2375 with
+ *     MAX_FONT_FRAC(2) shows 23.75), MAX_FONT_ZERO_PAD fills the field
+ *     with leading zeros instead of blanks. Returns 1, or 0 when the
+ *     number does not fit; the field then shows dashes.
+ *
+ *   Dot-matrix panels (column 0 = leftmost column of the panel):
+ *   int16_t MAX_FONT_DrawText(MAX_Chain_t* chain, int16_t x, const char* s);
+ *     Draw s with its first column at panel column x, MAX_FONT_SPACING
+ *     blank columns after every glyph. Columns outside the panel are
+ *     clipped, so x may be negative. Every drawn column covers all eight
+ *     rows. Returns the column after the text.
+ *
+ *   int16_t MAX_FONT_DrawNumber(MAX_Chain_t* chain, int16_t x, int32_t value);
+ *     Draw value in decimal like MAX_FONT_DrawText.
+ *
+ *   uint16_t MAX_FONT_TextWidth(const char* s);
+ *     Number of columns MAX_FONT_DrawText advances for s.
+ *
+ *   void MAX_FONT_ScrollLeft(MAX_Chain_t* chain, uint8_t column);
+ *     Shift the whole panel one column to the left and fill the rightmost
+ *     column with column (bit n = row n). Rows that do not change are not
+ *     marked dirty.
+ *
+ *   void MAX_FONT_TickerInit(MAX_FONT_Ticker_t* t, const char* text);
+ *     Start a ticker for text. The text is not copied and must stay valid
+ *     while the ticker runs.
+ *
+ *   uint8_t MAX_FONT_TickerStep(MAX_Chain_t* chain, MAX_FONT_Ticker_t* t);
+ *     Scroll the panel one column and feed in the next column of the text.
+ *     After the last glyph the panel is scrolled empty and the ticker
+ *     starts over. Returns 1 on the step that restarts it, 0 otherwise.
+ *
+ * Public types:
+ *   MAX_FONT_Ticker_t
+ *     Ticker state, owned by the application and set up with
+ *     MAX_FONT_TickerInit:
+ *       const char* text — text being scrolled
+ *       const char* next — character whose columns are being fed in
+ *       uint8_t     col  — next column of that character (including the
+ *                          spacing columns)
+ *       uint8_t     tail — blank columns fed in after the end of the text
+ *
+ * Public constants:
+ *   MAX_FONT_WIDTH      - glyph width of the matrix font in columns (5)
+ *   MAX_FONT_ZERO_PAD   - MAX_FONT_PutNumber7 flag: pad with zeros
+ *   MAX_FONT_FRAC(n)    - MAX_FONT_PutNumber7 flag: n (0 to 7) digits after
+ *                         the decimal point
+ *
+ * Configuration (compile-time, define before building max7219-font.c):
+ *   MAX_FONT_SPACING  - blank columns between matrix glyphs (default 1).
+ *   MAX_FONT_MSB_LEFT - 1 (default): bit 7 of a digit register is the
+ *                       leftmost column of its module, as on the common
+ *                       FC-16 modules. 0 for modules wired mirrored.
+ *
+ * Usage:
+ *   - Include this header where text output is required:
+ *       #include "max7219-font.h"
+ *
+ *   - Temperature on an 8-digit 7-segment module (no-decode mode):
+ *       static MAX_Chain_t disp;
+ *       DS3231_Snapshot_t s;
+ *
+ *       MAX_ChainInit(&disp, 1, &PORTB, &DDRB, PB2);
+ *       MAX_ChainDecodeMode(&disp, MAX_CHAIN_ALL, MAX_DEC_NOD);
+ *       MAX_ChainScanDigits(&disp, MAX_CHAIN_ALL, 0x07);
+ *       MAX_ChainNormalOperation(&disp, MAX_CHAIN_ALL);
+ *
+ *       DS3231_Snapshot(&s);
+ *       MAX_FONT_PutText7(&disp, 0, "t");
+ *       MAX_FONT_PutNumber7(&disp, 1, 6, s.temp_q2 * 25, MAX_FONT_FRAC(2));
+ *       MAX_FONT_PutText7(&disp, 7, "*");     // degree sign
+ *       MAX_Flush(&disp);
+ *
+ *   - Scrolling ticker on four 8×8 modules, one column every 20 ms:
+ *       static MAX_Chain_t panel;
+ *       static MAX_FONT_Ticker_t ticker;
+ *
+ *       MAX_ChainInit(&panel, 4, &PORTB, &DDRB, PB2);
+ *       ...
+ *       MAX_FONT_TickerInit(&ticker, "uc-MicroLab");
+ *
+ *       while(1)
+ *       {
+ *           MAX_FONT_TickerStep(&panel, &ticker);
+ *           MAX_Flush(&panel);
+ *           _delay_ms(20);
+ *       }
+ *
+ *   - Static label, centred:
+ *       MAX_ChainClear(&panel);
+ *       MAX_FONT_DrawText(&panel, (32 - MAX_FONT_TextWidth("12:30")) / 2, "12:30");
+ *       MAX_Flush(&panel);
+ *
+ * Notes:
+ *   - Device 0 (the one wired to the MCU) is taken as the rightmost module
+ *     or digit group, and digit register 1 of a 7-segment module as its
+ *     rightmost digit; position 0 is digit 7 of device devices - 1.
+ *   - 7-segment devices must be in no-decode mode (MAX_DEC_NOD): the
+ *     patterns are raw segment bits. '*' maps to a degree sign; letters
+ *     such as K, M, V, W and X are only approximations.
+ *   - The 5×7 glyphs leave row 7 blank. The ticker never sets it, so that
+ *     row is not resent while scrolling; a step of a 4-module panel costs
+ *     at most seven 8-byte bursts plus about 40 shifts, well under a
+ *     millisecond at the default SPI clock, which leaves room for far more
+ *     than 50 steps per second.
+ *   - Numbers are converted by repeated subtraction of powers of ten: at
+ *     most 9 subtractions per digit, constant code size, no 32-bit
+ *     division routine pulled in from libgcc.
+ *   - The font and power-of-ten tables take about 610 bytes of flash and
+ *     no RAM.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for MAX7219 text rendering
+ *
+ */
+
+#ifndef MAX7219_FONT_H_
+#define MAX7219_FONT_H_
+
+#include <stdint.h>
+#include "max7219.h"
+
+#define MAX_FONT_WIDTH     5
+
+#define MAX_FONT_ZERO_PAD  0x80
+#define MAX_FONT_FRAC(n)   ((n) & 0x07)
+
+#ifndef MAX_FONT_SPACING
+	#define MAX_FONT_SPACING 1
+#endif
+
+#ifndef MAX_FONT_MSB_LEFT
+	#define MAX_FONT_MSB_LEFT 1
+#endif
+
+#if (MAX_FONT_SPACING > 8)
+	#error "MAX_FONT_SPACING must be between 0 and 8"
+#endif
+
+typedef struct
+{
+	const char* text;
+	const char* next;
+	uint8_t col;
+	uint8_t tail;
+} MAX_FONT_Ticker_t;
+
+uint8_t MAX_FONT_Segments(char c);
+uint8_t MAX_FONT_Glyph(char c, uint8_t col);
+
+uint8_t MAX_FONT_PutText7(MAX_Chain_t* chain, uint8_t pos, const char* s);
+uint8_t MAX_FONT_PutNumber7(MAX_Chain_t* chain, uint8_t pos, uint8_t width, int32_t value, uint8_t flags);
+
+int16_t MAX_FONT_DrawText(MAX_Chain_t* chain, int16_t x, const char* s);
+int16_t MAX_FONT_DrawNumber(MAX_Chain_t* chain, int16_t x, int32_t value);
+uint16_t MAX_FONT_TextWidth(const char* s);
+
+void MAX_FONT_ScrollLeft(MAX_Chain_t* chain, uint8_t column);
+
+void MAX_FONT_TickerInit(MAX_FONT_Ticker_t* t, const char* text);
+uint8_t MAX_FONT_TickerStep(MAX_Chain_t* chain, MAX_FONT_Ticker_t* t);
+
+#endif /* MAX7219_FONT_H_ */
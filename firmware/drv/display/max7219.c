@@ -11,12 +11,15 @@
  *   display driver. Provides routines to initialize and control the MAX7219
  *   over SPI, including digit decoding, scan-limit configuration, intensity
  *   control, display test, shutdown mode, and raw digit/data writes.
+ *   A chain API drives N daisy-chained devices (DOUT to DIN, shared LOAD/CS)
+ *   through a packed framebuffer of 8 rows × N bytes: every row of the
+ *   whole chain is shifted out as one CS-framed burst of 2·N bytes.
  *   Built on top of the uc-MicroLab SPI HAL (spi-hal.h).
  *
  * Public API:
  *   void MAX_Init(void);
- *     Initialize the MAX7219. Configures the SPI peripheral with mode 1,
- *     MSB-first, SPI format 0, and clock divider 2.
+ *     Initialize the MAX7219. Configures the SPI peripheral in master mode
+ *     (HAL_SPI_MD1), MSB-first, clock divider 2 and SPI format 0.
  *
  *   void MAX_ShutdownMode(void);
  *     Place the MAX7219 in shutdown (low-power) mode. The display is blanked
@@ -62,12 +65,91 @@
  *     array must hold at least 9 elements; index 0 is ignored and indices
  *     1 through 8 map to digits 0 through 7.
  *
+ * Chain API:
+ *   void MAX_ChainInit(MAX_Chain_t *chain,
+ *                      uint8_t devices,
+ *                      volatile uint8_t *cs_port,
+ *                      volatile uint8_t *cs_ddr,
+ *                      uint8_t cs_pin);
+ *     Initialize a chain of devices (1 to MAX_CHAIN_MAX_DEVICES) whose
+ *     LOAD/CS line is cs_pin of cs_port. Configures the pin as an output,
+ *     idle high (set high first, so it never pulses low), initializes the
+ *     SPI peripheral like MAX_Init and clears the framebuffer. Device
+ *     registers are not written.
+ *
+ *   void MAX_ChainCommand(MAX_Chain_t *chain,
+ *                         uint8_t dev,
+ *                         uint8_t reg,
+ *                         uint8_t data);
+ *     Write data to register reg of device dev (0 = the device wired to
+ *     the MCU) or of every device with dev = MAX_CHAIN_ALL. One burst; the
+ *     devices that are not addressed receive a no-op.
+ *
+ *   void MAX_ChainCommandEach(MAX_Chain_t *chain,
+ *                             uint8_t reg,
+ *                             const uint8_t *data);
+ *     Write data[dev] to register reg of every device in one burst.
+ *
+ *   void MAX_ChainShutdownMode(MAX_Chain_t *chain, uint8_t dev);
+ *   void MAX_ChainNormalOperation(MAX_Chain_t *chain, uint8_t dev);
+ *   void MAX_ChainDecodeMode(MAX_Chain_t *chain, uint8_t dev, uint8_t digits);
+ *   void MAX_ChainScanDigits(MAX_Chain_t *chain, uint8_t dev, uint8_t digits);
+ *   void MAX_ChainSetIntensity(MAX_Chain_t *chain, uint8_t dev, uint8_t intensity);
+ *     Chain versions of the single-device commands, addressed to device
+ *     dev or broadcast with MAX_CHAIN_ALL.
+ *
+ *   void MAX_ChainSetRow(MAX_Chain_t *chain,
+ *                        uint8_t dev,
+ *                        uint8_t row,
+ *                        uint8_t value);
+ *     Store value in the framebuffer for digit register row (0–7) of
+ *     device dev and mark the row dirty if the value changed. Nothing is
+ *     transmitted.
+ *
+ *   uint8_t MAX_ChainGetRow(const MAX_Chain_t *chain, uint8_t dev, uint8_t row);
+ *     Return the framebuffer value for row of device dev.
+ *
+ *   void MAX_ChainClear(MAX_Chain_t *chain);
+ *     Clear the framebuffer, marking the rows that were not blank dirty.
+ *     Nothing is transmitted.
+ *
+ *   void MAX_ChainRefresh(MAX_Chain_t *chain);
+ *     Transmit the whole framebuffer: 8 bursts of 2·N bytes, one per row.
+ *     Equivalent to MAX_Invalidate followed by MAX_Flush.
+ *
+ *   uint8_t MAX_Flush(MAX_Chain_t *chain);
+ *     Transmit only the rows changed since the last flush, one burst per
+ *     dirty row, and clear their dirty bits. Returns the number of bursts
+ *     sent (0 when the display is already up to date).
+ *
+ *   void MAX_Invalidate(MAX_Chain_t *chain);
+ *     Mark every row dirty so the next MAX_Flush resends the whole
+ *     framebuffer. Use it after the devices lost power or may otherwise
+ *     have lost their digit registers.
+ *
  * Internal API (use with caution):
  *   void _MAX_WriteCMD(unsigned char *buf);
  *     Transmit a 2-byte command frame (register address + data) over SPI.
  *     This is an internal function used by all public API routines. It may
  *     be called directly only if the full command frame is known.
  *
+ * Public types:
+ *   MAX_Chain_t
+ *     Chain context, owned by the application and set up with
+ *     MAX_ChainInit:
+ *       uint8_t           devices  — number of devices in the chain
+ *       volatile uint8_t *cs_port  — PORTx register of the LOAD/CS pin
+ *       uint8_t           cs_pin   — LOAD/CS bit number in cs_port
+ *       uint8_t           fb[]     — framebuffer, fb[row * devices + dev]
+ *       uint8_t           dirty    — rows changed since the last flush,
+ *                                    bit n = row n
+ *     The remaining members (frame, xfer) are the SPI burst buffer and
+ *     transaction used internally.
+ *
+ * Configuration (compile-time):
+ *   MAX_CHAIN_MAX_DEVICES - largest chain a MAX_Chain_t can hold; sizes the
+ *                           framebuffer and burst buffer (default 8).
+ *
  * Public constants:
  *   Command register addresses:
  *     MAX_CMD_NOOP - No-op register          (0x00)
@@ -80,6 +162,10 @@
  *   Command frame length:
  *     MAX_CMD_LEN  - SPI frame length in bytes (0x02)
  *
+ *   Chain:
+ *     MAX_ROWS      - digit registers (rows) per device (8)
+ *     MAX_CHAIN_ALL - broadcast device index for the MAX_Chain* commands
+ *
  *   Decode mode masks (for MAX_DecodeMode):
  *     MAX_DEC_NOD  - No decode for all digits         (0x00)
  *     MAX_DEC_D00  - Decode digit 0 only              (0x01)
@@ -119,6 +205,20 @@
  *   - Enter low-power mode:
  *       MAX_ShutdownMode();
  *
+ *   - Drive a 32×8 matrix made of four cascaded modules, LOAD on PB2:
+ *       static MAX_Chain_t panel;
+ *       MAX_ChainInit(&panel, 4, &PORTB, &DDRB, PB2);
+ *       MAX_ChainDecodeMode(&panel, MAX_CHAIN_ALL, MAX_DEC_NOD);
+ *       MAX_ChainScanDigits(&panel, MAX_CHAIN_ALL, 0x07);
+ *       MAX_ChainSetIntensity(&panel, MAX_CHAIN_ALL, 0x04);
+ *       MAX_ChainNormalOperation(&panel, MAX_CHAIN_ALL);
+ *       MAX_ChainSetRow(&panel, 3, 0, 0x81);
+ *       MAX_Flush(&panel);
+ *
+ *   - Update a single digit; only the changed row goes out:
+ *       MAX_ChainSetRow(&panel, 0, 7, 0x3E);
+ *       MAX_Flush(&panel);
+ *
  * Notes:
  *   - The MAX7219 uses a 16-bit SPI frame: the upper byte is the register
  *     address and the lower byte is the data. Only bits [11:8] of the
@@ -126,15 +226,27 @@
  *   - The SPI clock polarity and phase must match MAX7219 requirements
  *     (CPOL=0, CPHA=0 — SPI Mode 0). Verify that HAL_SPI_FORMAT0 maps
  *     to this configuration in spi-hal.h.
- *   - Daisy-chaining multiple MAX7219 devices is not supported by this
- *     driver in its current form. Each device requires its own CS line and
- *     separate initialization.
+ *   - The single-device functions do not drive LOAD/CS; the application
+ *     must frame each command itself. The MAX_Chain* functions drive
+ *     LOAD/CS themselves, so a single device is best used as a chain of 1.
+ *   - In a chain the bytes shifted first travel furthest: each burst
+ *     starts with the frame for device devices-1 and ends with device 0.
+ *     LOAD/CS rises once per burst and latches all devices together.
+ *   - Bursts are sent as HAL_SPI_Transaction_t descriptors and waited for,
+ *     so the chain functions block until the burst is out.
+ *   - Dirty tracking is per row across the whole chain: a change in one
+ *     device resends that row to every device, which is what a single
+ *     LOAD pulse requires anyway. MAX_ChainInit marks every row dirty,
+ *     since the digit registers are undefined after power-up.
+ *   - Writing digit registers with MAX_ChainCommand bypasses the
+ *     framebuffer; call MAX_Invalidate afterwards to bring the devices back
+ *     in line with it on the next flush.
  *   - The scan-limit register affects per-digit peak current. Consult the
  *     MAX7219 datasheet (Table 8) when fewer than 8 digits are enabled.
  *   - Intensity steps follow odd PWM duty cycles: 1/32, 3/32, ... 31/32.
  *     Setting 0x00 does NOT blank the display; use MAX_ShutdownMode() for
  *     that purpose.
- *   - All SPI transfers are blocking (the underlying HAL uses polling).
+ *   - All SPI transfers are blocking.
  *
  * Author: otavioacb
  * Created: 2026-02-26
@@ -146,14 +258,23 @@
  *
  * Change log:
  *   2026-02-26  v0.1  Initial header for MAX7219 LED display driver
+ *   2026-10-14  v0.2  Added daisy-chain support with a packed framebuffer (MAX_Chain_t,
+ *                     MAX_Chain* API). Fixed the HAL_SPI_Init argument order in MAX_Init
+ *                     and the MAX_SetIntensity definition name
+ *   2026-10-14  v0.3  Added per-row dirty tracking: MAX_Flush and MAX_Invalidate
+ *   2026-10-14  v0.4  MAX_ChainInit drives LOAD high before making it an output, so
+ *                     no stray LOAD pulse latches a register
  *
  */
 
 #include "max7219.h"
 
+static void max_chain_burst(MAX_Chain_t* chain);
+static void max_chain_send_row(MAX_Chain_t* chain, uint8_t row);
+
 void MAX_Init()
 {
-	HAL_SPI_Init(HAL_SPI_MD1, HAL_SPI_DT_MSB, HAL_SPI_FORMAT0, HAL_SPI_CK_2);
+	HAL_SPI_Init(HAL_SPI_MD1, HAL_SPI_DT_MSB, HAL_SPI_CK_2, HAL_SPI_FORMAT0);
 }
 
 void MAX_ShutdownMode()
@@ -226,9 +347,9 @@ void MAX_StopTest()
  * 3 and going to 31 divided in a range of
  * 0x00 to 0x0F numbers.
  */
-void MAX_SetIntesity(unsigned char intesity)
+void MAX_SetIntensity(unsigned char intensity)
 {
-	unsigned char cmd[2] = {MAX_CMD_INTE, intesity};
+	unsigned char cmd[2] = {MAX_CMD_INTE, intensity};
 		
 	_MAX_WriteCMD(cmd);
 }
@@ -263,3 +384,185 @@ void _MAX_WriteCMD(unsigned char* buf)
 {
 	HAL_SPI_Send(buf, MAX_CMD_LEN);
 }
+
+void MAX_ChainInit(MAX_Chain_t* chain, uint8_t devices, volatile uint8_t* cs_port, volatile uint8_t* cs_ddr, uint8_t cs_pin)
+{
+	if(devices == 0) devices = 1;
+	if(devices > MAX_CHAIN_MAX_DEVICES) devices = MAX_CHAIN_MAX_DEVICES;
+	
+	chain->devices = devices;
+	chain->cs_port = cs_port;
+	chain->cs_pin  = cs_pin;
+	
+	/*
+	 * PORT before DDR: LOAD must not pulse low, or its rising edge would
+	 * latch whatever other SPI traffic left in the shift registers
+	 */
+	HAL_Port_Write(cs_port, cs_pin, HAL_PORT_LEVEL_HIGH);
+	*cs_ddr |= (1 << cs_pin);
+	
+	MAX_Init();
+	
+	chain->xfer.cs_port  = cs_port;
+	chain->xfer.cs_pin   = cs_pin;
+	chain->xfer.tx       = chain->frame;
+	chain->xfer.rx       = NULL;
+	chain->xfer.len      = MAX_CMD_LEN * devices;
+	chain->xfer.callback = NULL;
+	chain->xfer.ctx      = chain;
+	chain->xfer.status   = HAL_SPI_ST_OK;
+	chain->xfer.next     = NULL;
+	
+	for(uint8_t i = 0; i < MAX_ROWS * MAX_CHAIN_MAX_DEVICES; ++i) chain->fb[i] = 0x00;
+	
+	chain->dirty = 0xFF;
+}
+
+/*
+ * The first frame shifted out ends up in the last device of the chain,
+ * so position p of the burst carries device (devices - 1 - p).
+ */
+void MAX_ChainCommand(MAX_Chain_t* chain, uint8_t dev, uint8_t reg, uint8_t data)
+{
+	uint8_t* frame = chain->frame;
+	
+	for(uint8_t d = chain->devices; d-- > 0;)
+	{
+		if(dev == MAX_CHAIN_ALL || dev == d)
+		{
+			*frame++ = reg;
+			*frame++ = data;
+		}
+		else
+		{
+			*frame++ = MAX_CMD_NOOP;
+			*frame++ = 0x00;
+		}
+	}
+	
+	max_chain_burst(chain);
+}
+
+void MAX_ChainCommandEach(MAX_Chain_t* chain, uint8_t reg, const uint8_t* data)
+{
+	uint8_t* frame = chain->frame;
+	
+	for(uint8_t d = chain->devices; d-- > 0;)
+	{
+		*frame++ = reg;
+		*frame++ = data[d];
+	}
+	
+	max_chain_burst(chain);
+}
+
+void MAX_ChainShutdownMode(MAX_Chain_t* chain, uint8_t dev)
+{
+	MAX_ChainCommand(chain, dev, MAX_CMD_LOWP, 0x00);
+}
+
+void MAX_ChainNormalOperation(MAX_Chain_t* chain, uint8_t dev)
+{
+	MAX_ChainCommand(chain, dev, MAX_CMD_LOWP, 0x01);
+}
+
+void MAX_ChainDecodeMode(MAX_Chain_t* chain, uint8_t dev, uint8_t digits)
+{
+	MAX_ChainCommand(chain, dev, MAX_CMD_DECM, digits);
+}
+
+void MAX_ChainScanDigits(MAX_Chain_t* chain, uint8_t dev, uint8_t digits)
+{
+	MAX_ChainCommand(chain, dev, MAX_CMD_SCAN, digits);
+}
+
+void MAX_ChainSetIntensity(MAX_Chain_t* chain, uint8_t dev, uint8_t intensity)
+{
+	MAX_ChainCommand(chain, dev, MAX_CMD_INTE, intensity);
+}
+
+void MAX_ChainSetRow(MAX_Chain_t* chain, uint8_t dev, uint8_t row, uint8_t value)
+{
+	if(dev >= chain->devices || row >= MAX_ROWS) return;
+	
+	uint8_t* cell = &chain->fb[row * chain->devices + dev];
+	
+	if(*cell == value) return;
+	
+	*cell = value;
+	chain->dirty |= (1 << row);
+}
+
+uint8_t MAX_ChainGetRow(const MAX_Chain_t* chain, uint8_t dev, uint8_t row)
+{
+	if(dev >= chain->devices || row >= MAX_ROWS) return 0x00;
+	
+	return chain->fb[row * chain->devices + dev];
+}
+
+void MAX_ChainClear(MAX_Chain_t* chain)
+{
+	for(uint8_t row = 0; row < MAX_ROWS; ++row)
+	{
+		uint8_t* line = &chain->fb[row * chain->devices];
+		
+		for(uint8_t d = 0; d < chain->devices; ++d)
+		{
+			if(line[d] == 0x00) continue;
+			
+			line[d] = 0x00;
+			chain->dirty |= (1 << row);
+		}
+	}
+}
+
+void MAX_ChainRefresh(MAX_Chain_t* chain)
+{
+	MAX_Invalidate(chain);
+	MAX_Flush(chain);
+}
+
+uint8_t MAX_Flush(MAX_Chain_t* chain)
+{
+	uint8_t sent = 0;
+	
+	for(uint8_t row = 0; chain->dirty != 0 && row < MAX_ROWS; ++row)
+	{
+		if(!(chain->dirty & (1 << row))) continue;
+		
+		chain->dirty &= ~(1 << row);
+		max_chain_send_row(chain, row);
+		++sent;
+	}
+	
+	return sent;
+}
+
+void MAX_Invalidate(MAX_Chain_t* chain)
+{
+	chain->dirty = 0xFF;
+}
+
+/*
+ * One burst per row: digit register (row + 1) of every device is written
+ * with a single LOAD pulse.
+ */
+static void max_chain_send_row(MAX_Chain_t* chain, uint8_t row)
+{
+	const uint8_t* line = &chain->fb[row * chain->devices];
+	uint8_t* frame = chain->frame;
+	
+	for(uint8_t d = chain->devices; d-- > 0;)
+	{
+		*frame++ = row + 1;
+		*frame++ = line[d];
+	}
+	
+	max_chain_burst(chain);
+}
+
+static void max_chain_burst(MAX_Chain_t* chain)
+{
+	HAL_SPI_Submit(&chain->xfer);
+	HAL_SPI_Wait(&chain->xfer);
+}
@@ -11,12 +11,15 @@
  *   display driver. Provides routines to initialize and control the MAX7219
  *   over SPI, including digit decoding, scan-limit configuration, intensity
  *   control, display test, shutdown mode, and raw digit/data writes.
+ *   A chain API drives N daisy-chained devices (DOUT to DIN, shared LOAD/CS)
+ *   through a packed framebuffer of 8 rows × N bytes: every row of the
+ *   whole chain is shifted out as one CS-framed burst of 2·N bytes.
  *   Built on top of the uc-MicroLab SPI HAL (spi-hal.h).
  *
  * Public API:
  *   void MAX_Init(void);
- *     Initialize the MAX7219. Configures the SPI peripheral with mode 1,
- *     MSB-first, SPI format 0, and clock divider 2.
+ *     Initialize the MAX7219. Configures the SPI peripheral in master mode
+ *     (HAL_SPI_MD1), MSB-first, clock divider 2 and SPI format 0.
  *
  *   void MAX_ShutdownMode(void);
  *     Place the MAX7219 in shutdown (low-power) mode. The display is blanked
@@ -62,12 +65,91 @@
  *     array must hold at least 9 elements; index 0 is ignored and indices
  *     1 through 8 map to digits 0 through 7.
  *
+ * Chain API:
+ *   void MAX_ChainInit(MAX_Chain_t *chain,
+ *                      uint8_t devices,
+ *                      volatile uint8_t *cs_port,
+ *                      volatile uint8_t *cs_ddr,
+ *                      uint8_t cs_pin);
+ *     Initialize a chain of devices (1 to MAX_CHAIN_MAX_DEVICES) whose
+ *     LOAD/CS line is cs_pin of cs_port. Configures the pin as an output,
+ *     idle high (set high first, so it never pulses low), initializes the
+ *     SPI peripheral like MAX_Init and clears the framebuffer. Device
+ *     registers are not written.
+ *
+ *   void MAX_ChainCommand(MAX_Chain_t *chain,
+ *                         uint8_t dev,
+ *                         uint8_t reg,
+ *                         uint8_t data);
+ *     Write data to register reg of device dev (0 = the device wired to
+ *     the MCU) or of every device with dev = MAX_CHAIN_ALL. One burst; the
+ *     devices that are not addressed receive a no-op.
+ *
+ *   void MAX_ChainCommandEach(MAX_Chain_t *chain,
+ *                             uint8_t reg,
+ *                             const uint8_t *data);
+ *     Write data[dev] to register reg of every device in one burst.
+ *
+ *   void MAX_ChainShutdownMode(MAX_Chain_t *chain, uint8_t dev);
+ *   void MAX_ChainNormalOperation(MAX_Chain_t *chain, uint8_t dev);
+ *   void MAX_ChainDecodeMode(MAX_Chain_t *chain, uint8_t dev, uint8_t digits);
+ *   void MAX_ChainScanDigits(MAX_Chain_t *chain, uint8_t dev, uint8_t digits);
+ *   void MAX_ChainSetIntensity(MAX_Chain_t *chain, uint8_t dev, uint8_t intensity);
+ *     Chain versions of the single-device commands, addressed to device
+ *     dev or broadcast with MAX_CHAIN_ALL.
+ *
+ *   void MAX_ChainSetRow(MAX_Chain_t *chain,
+ *                        uint8_t dev,
+ *                        uint8_t row,
+ *                        uint8_t value);
+ *     Store value in the framebuffer for digit register row (0–7) of
+ *     device dev and mark the row dirty if the value changed. Nothing is
+ *     transmitted.
+ *
+ *   uint8_t MAX_ChainGetRow(const MAX_Chain_t *chain, uint8_t dev, uint8_t row);
+ *     Return the framebuffer value for row of device dev.
+ *
+ *   void MAX_ChainClear(MAX_Chain_t *chain);
+ *     Clear the framebuffer, marking the rows that were not blank dirty.
+ *     Nothing is transmitted.
+ *
+ *   void MAX_ChainRefresh(MAX_Chain_t *chain);
+ *     Transmit the whole framebuffer: 8 bursts of 2·N bytes, one per row.
+ *     Equivalent to MAX_Invalidate followed by MAX_Flush.
+ *
+ *   uint8_t MAX_Flush(MAX_Chain_t *chain);
+ *     Transmit only the rows changed since the last flush, one burst per
+ *     dirty row, and clear their dirty bits. Returns the number of bursts
+ *     sent (0 when the display is already up to date).
+ *
+ *   void MAX_Invalidate(MAX_Chain_t *chain);
+ *     Mark every row dirty so the next MAX_Flush resends the whole
+ *     framebuffer. Use it after the devices lost power or may otherwise
+ *     have lost their digit registers.
+ *
  * Internal API (use with caution):
  *   void _MAX_WriteCMD(unsigned char *buf);
  *     Transmit a 2-byte command frame (register address + data) over SPI.
  *     This is an internal function used by all public API routines. It may
  *     be called directly only if the full command frame is known.
  *
+ * Public types:
+ *   MAX_Chain_t
+ *     Chain context, owned by the application and set up with
+ *     MAX_ChainInit:
+ *       uint8_t           devices  — number of devices in the chain
+ *       volatile uint8_t *cs_port  — PORTx register of the LOAD/CS pin
+ *       uint8_t           cs_pin   — LOAD/CS bit number in cs_port
+ *       uint8_t           fb[]     — framebuffer, fb[row * devices + dev]
+ *       uint8_t           dirty    — rows changed since the last flush,
+ *                                    bit n = row n
+ *     The remaining members (frame, xfer) are the SPI burst buffer and
+ *     transaction used internally.
+ *
+ * Configuration (compile-time):
+ *   MAX_CHAIN_MAX_DEVICES - largest chain a MAX_Chain_t can hold; sizes the
+ *                           framebuffer and burst buffer (default 8).
+ *
  * Public constants:
  *   Command register addresses:
  *     MAX_CMD_NOOP - No-op register          (0x00)
@@ -80,6 +162,10 @@
  *   Command frame length:
  *     MAX_CMD_LEN  - SPI frame length in bytes (0x02)
  *
+ *   Chain:
+ *     MAX_ROWS      - digit registers (rows) per device (8)
+ *     MAX_CHAIN_ALL - broadcast device index for the MAX_Chain* commands
+ *
  *   Decode mode masks (for MAX_DecodeMode):
  *     MAX_DEC_NOD  - No decode for all digits         (0x00)
  *     MAX_DEC_D00  - Decode digit 0 only              (0x01)
@@ -119,6 +205,20 @@
  *   - Enter low-power mode:
  *       MAX_ShutdownMode();
  *
+ *   - Drive a 32×8 matrix made of four cascaded modules, LOAD on PB2:
+ *       static MAX_Chain_t panel;
+ *       MAX_ChainInit(&panel, 4, &PORTB, &DDRB, PB2);
+ *       MAX_ChainDecodeMode(&panel, MAX_CHAIN_ALL, MAX_DEC_NOD);
+ *       MAX_ChainScanDigits(&panel, MAX_CHAIN_ALL, 0x07);
+ *       MAX_ChainSetIntensity(&panel, MAX_CHAIN_ALL, 0x04);
+ *       MAX_ChainNormalOperation(&panel, MAX_CHAIN_ALL);
+ *       MAX_ChainSetRow(&panel, 3, 0, 0x81);
+ *       MAX_Flush(&panel);
+ *
+ *   - Update a single digit; only the changed row goes out:
+ *       MAX_ChainSetRow(&panel, 0, 7, 0x3E);
+ *       MAX_Flush(&panel);
+ *
  * Notes:
  *   - The MAX7219 uses a 16-bit SPI frame: the upper byte is the register
  *     address and the lower byte is the data. Only bits [11:8] of the
@@ -126,15 +226,27 @@
  *   - The SPI clock polarity and phase must match MAX7219 requirements
  *     (CPOL=0, CPHA=0 — SPI Mode 0). Verify that HAL_SPI_FORMAT0 maps
  *     to this configuration in spi-hal.h.
- *   - Daisy-chaining multiple MAX7219 devices is not supported by this
- *     driver in its current form. Each device requires its own CS line and
- *     separate initialization.
+ *   - The single-device functions do not drive LOAD/CS; the application
+ *     must frame each command itself. The MAX_Chain* functions drive
+ *     LOAD/CS themselves, so a single device is best used as a chain of 1.
+ *   - In a chain the bytes shifted first travel furthest: each burst
+ *     starts with the frame for device devices-1 and ends with device 0.
+ *     LOAD/CS rises once per burst and latches all devices together.
+ *   - Bursts are sent as HAL_SPI_Transaction_t descriptors and waited for,
+ *     so the chain functions block until the burst is out.
+ *   - Dirty tracking is per row across the whole chain: a change in one
+ *     device resends that row to every device, which is what a single
+ *     LOAD pulse requires anyway. MAX_ChainInit marks every row dirty,
+ *     since the digit registers are undefined after power-up.
+ *   - Writing digit registers with MAX_ChainCommand bypasses the
+ *     framebuffer; call MAX_Invalidate afterwards to bring the devices back
+ *     in line with it on the next flush.
  *   - The scan-limit register affects per-digit peak current. Consult the
  *     MAX7219 datasheet (Table 8) when fewer than 8 digits are enabled.
  *   - Intensity steps follow odd PWM duty cycles: 1/32, 3/32, ... 31/32.
  *     Setting 0x00 does NOT blank the display; use MAX_ShutdownMode() for
  *     that purpose.
- *   - All SPI transfers are blocking (the underlying HAL uses polling).
+ *   - All SPI transfers are blocking.
  *
  * Author: otavioacb
  * Created: 2026-02-26
@@ -146,13 +258,26 @@
  *
  * Change log:
  *   2026-02-26  v0.1  Initial header for MAX7219 LED display driver
+ *   2026-10-14  v0.2  Added daisy-chain support with a packed framebuffer (MAX_Chain_t,
+ *                     MAX_Chain* API). Fixed the HAL_SPI_Init argument order in MAX_Init
+ *                     and the MAX_SetIntensity definition name
+ *   2026-10-14  v0.3  Added per-row dirty tracking: MAX_Flush and MAX_Invalidate
+ *   2026-10-14  v0.4  MAX_ChainInit drives LOAD high before making it an output, so
+ *                     no stray LOAD pulse latches a register
  *
  */
 
 #ifndef MAX7219_H_
 #define MAX7219_H_
 
+#include <stdint.h>
+
 #include "spi-hal.h"
+#include "port-hal.h"
+
+#ifndef MAX_CHAIN_MAX_DEVICES
+	#define MAX_CHAIN_MAX_DEVICES 8
+#endif
 
 #define MAX_CMD_NOOP 0x00   /* No-op                */
 #define MAX_CMD_DECM 0x09   /* Decode mode          */
@@ -163,6 +288,9 @@
 
 #define MAX_CMD_LEN  0x02   /* SPI frame length (bytes) */
 
+#define MAX_ROWS      8     /* Digit registers per device */
+#define MAX_CHAIN_ALL 0xFF  /* Broadcast to every device  */
+
 #define MAX_DEC_NOD  0x00   /* No decode for all digits   */
 #define MAX_DEC_D00  0x01   /* Decode digit 0 only        */
 #define MAX_DEC_D01  0x03   /* Decode digits 1 to 0       */
@@ -189,6 +317,36 @@ void MAX_SetIntensity(unsigned char intensity);
 void MAX_WriteDigit(unsigned char digit, unsigned char value);
 void MAX_SendData(unsigned char *values);
 
+typedef struct
+{
+	uint8_t devices;
+	volatile uint8_t* cs_port;
+	uint8_t cs_pin;
+	uint8_t fb[MAX_ROWS * MAX_CHAIN_MAX_DEVICES];
+	uint8_t dirty;
+	uint8_t frame[MAX_CMD_LEN * MAX_CHAIN_MAX_DEVICES];
+	HAL_SPI_Transaction_t xfer;
+} MAX_Chain_t;
+
+void MAX_ChainInit(MAX_Chain_t* chain, uint8_t devices, volatile uint8_t* cs_port, volatile uint8_t* cs_ddr, uint8_t cs_pin);
+
+void MAX_ChainCommand(MAX_Chain_t* chain, uint8_t dev, uint8_t reg, uint8_t data);
+void MAX_ChainCommandEach(MAX_Chain_t* chain, uint8_t reg, const uint8_t* data);
+
+void MAX_ChainShutdownMode(MAX_Chain_t* chain, uint8_t dev);
+void MAX_ChainNormalOperation(MAX_Chain_t* chain, uint8_t dev);
+void MAX_ChainDecodeMode(MAX_Chain_t* chain, uint8_t dev, uint8_t digits);
+void MAX_ChainScanDigits(MAX_Chain_t* chain, uint8_t dev, uint8_t digits);
+void MAX_ChainSetIntensity(MAX_Chain_t* chain, uint8_t dev, uint8_t intensity);
+
+void MAX_ChainSetRow(MAX_Chain_t* chain, uint8_t dev, uint8_t row, uint8_t value);
+uint8_t MAX_ChainGetRow(const MAX_Chain_t* chain, uint8_t dev, uint8_t row);
+void MAX_ChainClear(MAX_Chain_t* chain);
+void MAX_ChainRefresh(MAX_Chain_t* chain);
+
+uint8_t MAX_Flush(MAX_Chain_t* chain);
+void MAX_Invalidate(MAX_Chain_t* chain);
+
 void _MAX_WriteCMD(unsigned char *buf);
 
 #endif /* MAX7219_H_ */
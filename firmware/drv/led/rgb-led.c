@@ -0,0 +1,274 @@
+/*
+ * uc-Microlab — RGB LED Driver (header)
+ * File: rgb-led.h / rgb-led.c
+ *
+ * Project: uc-MicroLab
+ * Component: Gamma-corrected RGB LED on three PWM channels
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Drives a common-cathode RGB LED from three channels of the PWM HAL
+ *   (pwm-hal.h). Colours are given as perceived brightness 0–255 and
+ *   mapped through a gamma 2.2 table in flash, so equal steps look equal
+ *   to the eye. New compare values are staged in a back buffer and all
+ *   three are written from one timer overflow interrupt, so a colour
+ *   change never shows an intermediate mix of old and new channels. Fades
+ *   run in the same interrupt with fixed-point per-step increments: one
+ *   division per channel when the fade starts, additions afterwards.
+ *
+ * Public API:
+ *   uint8_t RGB_Init(void);
+ *     Configure the three channels for 8-bit phase-correct PWM at about
+ *     490 Hz, start their timers in step and switch the LED off. Returns
+ *     1 on success, 0 if the overflow interrupt of the RGB_CH_R timer is
+ *     not enabled in pwm-hal (HAL_PWM_TIMERn_ISR).
+ *
+ *   void RGB_Set(uint8_t r, uint8_t g, uint8_t b);
+ *     Show the colour (r, g, b) from the next PWM period, cancelling a
+ *     running fade.
+ *
+ *   void RGB_FadeTo(uint8_t r, uint8_t g, uint8_t b, uint16_t steps);
+ *     Fade linearly (in perceived brightness) from the current colour to
+ *     (r, g, b) in steps steps of RGB_FADE_DIV PWM periods each; the last
+ *     step lands exactly on the target. 0 or 1 steps act as RGB_Set.
+ *
+ *   uint8_t RGB_IsFading(void);
+ *     Return 1 while a fade is running.
+ *
+ * Configuration (compile-time, define before building rgb-led.c):
+ *   RGB_CH_R, RGB_CH_G, RGB_CH_B - HAL_PWM_CHnx channel of each colour
+ *                                  (default CH1A / PB1, CH1B / PB2 and
+ *                                  CH2A / PB3).
+ *   RGB_FADE_DIV                 - PWM periods per fade step, 1 to 255
+ *                                  (default 2, about 4 ms per step).
+ *
+ * Usage:
+ *   - Include this header where the RGB LED is required:
+ *       #include "rgb-led.h"
+ *
+ *   - Build pwm-hal.c with HAL_PWM_TIMER1_ISR=1 (the timer of RGB_CH_R),
+ *     then:
+ *       RGB_Init();
+ *       sei();
+ *       RGB_Set(255, 64, 0);            // orange
+ *       RGB_FadeTo(0, 0, 255, 250);     // to blue in about 1 s
+ *
+ * Notes:
+ *   - The overflow callback of the RGB_CH_R timer (HAL_PWM_SetOverflowCallback)
+ *     is owned by this driver. It is only registered while an update or a
+ *     fade is pending, so an idle LED costs no interrupts.
+ *   - Phase-correct PWM latches new compare values at TOP, half a period
+ *     after the overflow at BOTTOM, which leaves the interrupt about 1 ms
+ *     to write all three registers. It also gives a true 0 % output.
+ *   - RGB_Init stops every prescaler with GTCCR.TSM while the timers are
+ *     configured and cleared, so channels on different timers share the
+ *     same BOTTOM / TOP and latch their updates in the same period.
+ *   - The timers used here (default Timer1 and Timer2) are not available
+ *     for other purposes: the DS3231 sub-second tick (Timer2) and the
+ *     scheduler (Timer0) need other RGB_CH_* choices.
+ *   - Reinitialising one of the timers through the PWM or CTC HAL later on
+ *     may break the phase alignment; call RGB_Init again afterwards.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for RGB LED driver
+ *
+ */
+
+
+#include "rgb-led.h"
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+/* Generated by firmware/tools/gamma-lut.py -g 2.2 -m 255 */
+static const uint8_t rgb_gamma[256] PROGMEM =
+{
+	  0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+	  3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+	  6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+	 12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+	 20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+	 30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+	 42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+	 56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+	 73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+	 91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+	113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+	137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+	163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+	192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+	223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+/*
+ * Levels are Q8.8 perceived brightness; the integer part indexes the gamma
+ * table. back[] holds the staged compare values, loaded by the overflow
+ * callback while pending is set.
+ */
+static uint16_t rgb_level[3];
+static int16_t  rgb_delta[3];
+static uint8_t  rgb_target[3];
+static uint8_t  rgb_back[3];
+
+static volatile uint16_t rgb_steps = 0;
+static volatile uint8_t  rgb_pending = 0;
+static uint8_t rgb_div = 0;
+
+static const uint8_t rgb_ch[3] = {RGB_CH_R, RGB_CH_G, RGB_CH_B};
+
+static void rgb_on_overflow(void);
+static void rgb_stage(void);
+
+uint8_t RGB_Init(void)
+{
+	/* Probe that pwm-hal serves the overflow of the RGB_CH_R timer */
+	if(!HAL_PWM_SetOverflowCallback(RGB_CH_R, NULL)) return 0;
+	
+	/* Hold every prescaler in reset while the timers are set up */
+	GTCCR = (1 << TSM) | (1 << PSRASY) | (1 << PSRSYNC);
+	
+	for(uint8_t i = 0; i < 3; ++i)
+	{
+		const uint8_t ch = rgb_ch[i];
+		
+		switch(ch >> 1)
+		{
+			case 0:
+				HAL_PWM_Init(ch, HAL_PWM_CH0_PHASE, HAL_PWM_CH0_CK_64);
+				TCNT0 = 0;
+				break;
+			case 1:
+				HAL_PWM_Init(ch, HAL_PWM_CH1_PHASE, HAL_PWM_CH1_CK_64);
+				TCNT1 = 0;
+				break;
+			default:
+				HAL_PWM_Init(ch, HAL_PWM_CH2_PHASE, HAL_PWM_CH2_CK_64);
+				TCNT2 = 0;
+				break;
+		}
+		
+		HAL_PWM_SetCompare(ch, 0);
+	}
+	
+	GTCCR = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(uint8_t i = 0; i < 3; ++i)
+		{
+			rgb_level[i] = 0;
+			rgb_back[i]  = 0;
+		}
+		
+		rgb_steps   = 0;
+		rgb_pending = 0;
+	}
+	
+	return 1;
+}
+
+void RGB_Set(uint8_t r, uint8_t g, uint8_t b)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		rgb_target[0] = r;
+		rgb_target[1] = g;
+		rgb_target[2] = b;
+		
+		for(uint8_t i = 0; i < 3; ++i) rgb_level[i] = (uint16_t) rgb_target[i] << 8;
+		
+		rgb_steps = 0;
+		rgb_stage();
+		HAL_PWM_SetOverflowCallback(RGB_CH_R, rgb_on_overflow);
+	}
+}
+
+void RGB_FadeTo(uint8_t r, uint8_t g, uint8_t b, uint16_t steps)
+{
+	if(steps <= 1)
+	{
+		RGB_Set(r, g, b);
+		return;
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		rgb_target[0] = r;
+		rgb_target[1] = g;
+		rgb_target[2] = b;
+		
+		/* |diff| < 2^16 and steps >= 2, so every delta fits 16 bits */
+		for(uint8_t i = 0; i < 3; ++i)
+		{
+			int32_t diff = ((int32_t) rgb_target[i] << 8) - (int32_t) rgb_level[i];
+			
+			rgb_delta[i] = (int16_t) (diff / (int32_t) steps);
+		}
+		
+		rgb_steps = steps;
+		rgb_div   = 0;
+		HAL_PWM_SetOverflowCallback(RGB_CH_R, rgb_on_overflow);
+	}
+}
+
+uint8_t RGB_IsFading(void)
+{
+	return (rgb_steps != 0);
+}
+
+/*
+ * Overflow callback of the RGB_CH_R timer: advance the fade every
+ * RGB_FADE_DIV periods, then load the staged values into all three
+ * compare registers at once. Removes itself when there is nothing left.
+ */
+static void rgb_on_overflow(void)
+{
+	if(rgb_steps != 0 && ++rgb_div >= RGB_FADE_DIV)
+	{
+		rgb_div = 0;
+		
+		if(--rgb_steps == 0)
+		{
+			for(uint8_t i = 0; i < 3; ++i) rgb_level[i] = (uint16_t) rgb_target[i] << 8;
+		}
+		else
+		{
+			for(uint8_t i = 0; i < 3; ++i) rgb_level[i] += (uint16_t) rgb_delta[i];
+		}
+		
+		rgb_stage();
+	}
+	
+	if(rgb_pending)
+	{
+		for(uint8_t i = 0; i < 3; ++i) HAL_PWM_SetCompare(rgb_ch[i], rgb_back[i]);
+		rgb_pending = 0;
+	}
+	
+	if(rgb_steps == 0) HAL_PWM_SetOverflowCallback(RGB_CH_R, NULL);
+}
+
+/* Map the current levels through the gamma table into the back buffer */
+static void rgb_stage(void)
+{
+	for(uint8_t i = 0; i < 3; ++i)
+	{
+		uint8_t value = pgm_read_byte(&rgb_gamma[rgb_level[i] >> 8]);
+		
+		if(value != rgb_back[i])
+		{
+			rgb_back[i] = value;
+			rgb_pending = 1;
+		}
+	}
+}
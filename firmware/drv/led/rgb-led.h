@@ -0,0 +1,118 @@
+/*
+ * uc-Microlab — RGB LED Driver (header)
+ * File: rgb-led.h / rgb-led.c
+ *
+ * Project: uc-MicroLab
+ * Component: Gamma-corrected RGB LED on three PWM channels
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Drives a common-cathode RGB LED from three channels of the PWM HAL
+ *   (pwm-hal.h). Colours are given as perceived brightness 0–255 and
+ *   mapped through a gamma 2.2 table in flash, so equal steps look equal
+ *   to the eye. New compare values are staged in a back buffer and all
+ *   three are written from one timer overflow interrupt, so a colour
+ *   change never shows an intermediate mix of old and new channels. Fades
+ *   run in the same interrupt with fixed-point per-step increments: one
+ *   division per channel when the fade starts, additions afterwards.
+ *
+ * Public API:
+ *   uint8_t RGB_Init(void);
+ *     Configure the three channels for 8-bit phase-correct PWM at about
+ *     490 Hz, start their timers in step and switch the LED off. Returns
+ *     1 on success, 0 if the overflow interrupt of the RGB_CH_R timer is
+ *     not enabled in pwm-hal (HAL_PWM_TIMERn_ISR).
+ *
+ *   void RGB_Set(uint8_t r, uint8_t g, uint8_t b);
+ *     Show the colour (r, g, b) from the next PWM period, cancelling a
+ *     running fade.
+ *
+ *   void RGB_FadeTo(uint8_t r, uint8_t g, uint8_t b, uint16_t steps);
+ *     Fade linearly (in perceived brightness) from the current colour to
+ *     (r, g, b) in steps steps of RGB_FADE_DIV PWM periods each; the last
+ *     step lands exactly on the target. 0 or 1 steps act as RGB_Set.
+ *
+ *   uint8_t RGB_IsFading(void);
+ *     Return 1 while a fade is running.
+ *
+ * Configuration (compile-time, define before building rgb-led.c):
+ *   RGB_CH_R, RGB_CH_G, RGB_CH_B - HAL_PWM_CHnx channel of each colour
+ *                                  (default CH1A / PB1, CH1B / PB2 and
+ *                                  CH2A / PB3).
+ *   RGB_FADE_DIV                 - PWM periods per fade step, 1 to 255
+ *                                  (default 2, about 4 ms per step).
+ *
+ * Usage:
+ *   - Include this header where the RGB LED is required:
+ *       #include "rgb-led.h"
+ *
+ *   - Build pwm-hal.c with HAL_PWM_TIMER1_ISR=1 (the timer of RGB_CH_R),
+ *     then:
+ *       RGB_Init();
+ *       sei();
+ *       RGB_Set(255, 64, 0);            // orange
+ *       RGB_FadeTo(0, 0, 255, 250);     // to blue in about 1 s
+ *
+ * Notes:
+ *   - The overflow callback of the RGB_CH_R timer (HAL_PWM_SetOverflowCallback)
+ *     is owned by this driver. It is only registered while an update or a
+ *     fade is pending, so an idle LED costs no interrupts.
+ *   - Phase-correct PWM latches new compare values at TOP, half a period
+ *     after the overflow at BOTTOM, which leaves the interrupt about 1 ms
+ *     to write all three registers. It also gives a true 0 % output.
+ *   - RGB_Init stops every prescaler with GTCCR.TSM while the timers are
+ *     configured and cleared, so channels on different timers share the
+ *     same BOTTOM / TOP and latch their updates in the same period.
+ *   - The timers used here (default Timer1 and Timer2) are not available
+ *     for other purposes: the DS3231 sub-second tick (Timer2) and the
+ *     scheduler (Timer0) need other RGB_CH_* choices.
+ *   - Reinitialising one of the timers through the PWM or CTC HAL later on
+ *     may break the phase alignment; call RGB_Init again afterwards.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for RGB LED driver
+ *
+ */
+
+#ifndef RGB_LED_H_
+#define RGB_LED_H_
+
+#include <stdint.h>
+#include "pwm-hal.h"
+
+#ifndef RGB_CH_R
+	#define RGB_CH_R HAL_PWM_CH1A
+#endif
+
+#ifndef RGB_CH_G
+	#define RGB_CH_G HAL_PWM_CH1B
+#endif
+
+#ifndef RGB_CH_B
+	#define RGB_CH_B HAL_PWM_CH2A
+#endif
+
+#ifndef RGB_FADE_DIV
+	#define RGB_FADE_DIV 2U
+#endif
+
+#if (RGB_FADE_DIV < 1) || (RGB_FADE_DIV > 255)
+	#error "RGB_FADE_DIV must be between 1 and 255"
+#endif
+
+uint8_t RGB_Init(void);
+
+void RGB_Set(uint8_t r, uint8_t g, uint8_t b);
+void RGB_FadeTo(uint8_t r, uint8_t g, uint8_t b, uint16_t steps);
+
+uint8_t RGB_IsFading(void);
+
+#endif /* RGB_LED_H_ */
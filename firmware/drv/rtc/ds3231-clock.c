@@ -0,0 +1,331 @@
+/*
+ * uc-Microlab — DS3231 Software Clock (header)
+ * File: ds3231-clock.h / ds3231-clock.c
+ *
+ * Project: uc-MicroLab
+ * Component: DS3231 SQW-disciplined software clock
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Optional time-keeping layer on top of the DS3231 driver (ds3231.h).
+ *   The date and time are read from the DS3231 once, then a local copy is
+ *   advanced on every edge of the 1 Hz INT/SQW square wave. A CTC timer
+ *   provides a millisecond sub-second tick between edges. Reading the
+ *   current time is a few instructions with interrupts briefly masked,
+ *   instead of a full 8-byte I2C transaction plus seven BCD decodes.
+ *   The local copy is resynchronized with the DS3231 periodically.
+ *
+ * Public API:
+ *   void DS3231_CLK_Init(void);
+ *     Read the current time from the DS3231, select the 1 Hz square wave
+ *     (DS3231_SetSQWFreq(DS3231_SQW_1HZ) + DS3231_EnableSQW()), register
+ *     the PD2 (INT0) edge callback and start the Timer2 sub-second tick. DS3231_Init()
+ *     must have been called before. Global interrupts must be enabled by
+ *     the application.
+ *
+ *   void DS3231_CLK_OnEdge(void);
+ *     Advance the local clock by one second. Called from the PD2 edge
+ *     callback of this module, or by the application's own handler when built
+ *     with DS3231_CLK_USE_INT0 = 0. Must be called with interrupts
+ *     disabled (ISR context).
+ *
+ *   void DS3231_CLK_Service(void);
+ *     Run pending work outside interrupt context: when a resync is due,
+ *     re-read the time from the DS3231 and load it into the local clock.
+ *     Call it from the main loop.
+ *
+ *   uint16_t DS3231_CLK_Now(DS3231_Datetime_t *now);
+ *     Copy the local date and time into now and return the milliseconds
+ *     elapsed in the current second (0–999, always 0 when
+ *     DS3231_CLK_USE_SUBSEC = 0).
+ *
+ *   uint32_t DS3231_CLK_Seconds(void);
+ *     Monotonic seconds counter, incremented on every SQW edge since
+ *     DS3231_CLK_Init. Unaffected by resyncs; use it for interval math.
+ *
+ *   void DS3231_CLK_RequestResync(void);
+ *     Force a resync on the next DS3231_CLK_Service call.
+ *
+ * Configuration (compile-time, define before building ds3231-clock.c):
+ *   DS3231_CLK_RESYNC_PERIOD - seconds between automatic resyncs
+ *                              (default 3600).
+ *   DS3231_CLK_USE_INT0      - 1 (default): INT/SQW is wired to INT0 (PD2)
+ *                              and this module attaches to it through the
+ *                              port interrupt dispatcher (port-irq.h;
+ *                              link port-irq.c). 0: the application calls
+ *                              DS3231_CLK_OnEdge itself.
+ *   DS3231_CLK_USE_SUBSEC    - 1 (default): Timer2 in CTC mode generates a
+ *                              1 kHz tick and this module owns
+ *                              TIMER2_COMPA_vect. 0: no sub-second tick.
+ *
+ * Usage:
+ *   - Include this header where the software clock is required:
+ *       #include "ds3231-clock.h"
+ *
+ *   - Start the clock:
+ *       DS3231_Init();
+ *       DS3231_CLK_Init();
+ *       sei();
+ *
+ *   - Timestamp samples in the main loop:
+ *       DS3231_Datetime_t now;
+ *       uint16_t ms = DS3231_CLK_Now(&now);
+ *       DS3231_CLK_Service();
+ *
+ *   - Measure an interval:
+ *       uint32_t t0 = DS3231_CLK_Seconds();
+ *       ...
+ *       uint32_t elapsed = DS3231_CLK_Seconds() - t0;
+ *
+ * Notes:
+ *   - INT/SQW is an open-drain output. DS3231_CLK_Init enables the PD2
+ *     internal pull-up; add an external pull-up for long wires.
+ *   - The local clock counts falling edges of the 1 Hz square wave. The
+ *     sub-second counter restarts at each edge and saturates at 999.
+ *   - A resync read that overlaps an edge is discarded and repeated: the
+ *     chip may have latched its seconds before or after that edge, so the
+ *     read is only trusted when no edge arrived while it ran. Edges are a
+ *     second apart and the read takes about 1 ms, so the retry succeeds;
+ *     after three overlapping reads the resync stays pending for the next
+ *     DS3231_CLK_Service call.
+ *   - Only the 24-hour mode of the DS3231 is supported.
+ *   - Using the Alarm interrupt output (INTCN = 1) is not possible while
+ *     this module is running, because INT/SQW carries the square wave.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for DS3231 software clock
+ *   2026-10-14  v0.2  SQW edges come from HAL_Port_Attach instead of a private INT0_vect
+ *   2026-10-14  v0.3  Sub-second tick prescaler and compare value come from the CTC HAL solver
+ *   2026-10-14  v0.4  Sub-second tick holds IDLE on Timer2 (power-hal.h)
+ *   2026-10-14  v0.5  A resync read that overlaps an SQW edge is retried instead of
+ *                     corrected, which could leave the clock one second fast
+ *
+ */
+
+#include "ds3231-clock.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "port-hal.h"
+#include "ctc-hal.h"
+#include "power-hal.h"
+
+#if DS3231_CLK_USE_INT0
+	#include "port-irq.h"
+#endif
+
+#ifndef F_CPU
+	#define F_CPU 16000000UL
+#endif
+
+/* Timer2 clock selection and OCR2A for a 1 kHz compare match */
+#define CLK_SUBSEC_CK  HAL_CTC_CH2_CK(1000UL)
+#define CLK_SUBSEC_OCR HAL_CTC_CH2_OCR(1000UL)
+
+/* Resync reads tried before giving up until the next Service call */
+#define CLK_RESYNC_TRIES 3U
+
+#if DS3231_CLK_USE_SUBSEC && (CLK_SUBSEC_CK == 0)
+	#error "F_CPU does not allow a 1 kHz Timer2 tick"
+#endif
+
+/*
+ * clk_time is only touched in ISR context or inside ATOMIC_BLOCKs, whose
+ * cli/sei act as compiler memory barriers, so it needs no volatile.
+ */
+static DS3231_Datetime_t clk_time;
+static volatile uint32_t clk_seconds = 0;
+static volatile uint16_t clk_subsec  = 0;
+static volatile uint16_t clk_resync_in = 0;
+static volatile uint8_t  clk_resync_due = 0;
+
+static const uint8_t clk_month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static void clk_advance(DS3231_Datetime_t* t);
+static void clk_load(const DS3231_Datetime_t* t);
+
+#if DS3231_CLK_USE_INT0
+static void clk_on_sqw(unsigned char level, uint32_t stamp);
+#endif
+
+void DS3231_CLK_Init(void)
+{
+	DS3231_Datetime_t now;
+	
+	DS3231_GetTime(&now);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		clk_load(&now);
+		clk_seconds    = 0;
+		clk_subsec     = 0;
+		clk_resync_in  = 1;   /* re-read right after the first edge */
+		clk_resync_due = 0;
+	}
+	
+	DS3231_SetSQWFreq(DS3231_SQW_1HZ);
+	DS3231_EnableSQW();
+	
+#if DS3231_CLK_USE_SUBSEC
+	HAL_CTC_Init(HAL_CTC_SRC_2, HAL_CTC_CH_A, 0, CLK_SUBSEC_CK);
+	HAL_CTC_SetValue(HAL_CTC_SRC_2, HAL_CTC_CH_A, CLK_SUBSEC_OCR);
+	HAL_CTC_EnableInterrupt(HAL_CTC_SRC_2, HAL_CTC_CH_A);
+	HAL_PWR_HOLD(HAL_PWR_ID_TIMER2, HAL_PWR_IDLE);
+#endif
+	
+#if DS3231_CLK_USE_INT0
+	HAL_Port_SetMode(&PORTD, &DDRD, PD2, HAL_PORT_INPUT, HAL_PORT_EN_PULLUP);
+	HAL_Port_Attach(&PIND, PD2, HAL_PORT_EDGE_FALLING, clk_on_sqw);
+#endif
+}
+
+void DS3231_CLK_OnEdge(void)
+{
+	clk_advance(&clk_time);
+	
+	clk_seconds++;
+	clk_subsec = 0;
+	
+	if(--clk_resync_in == 0)
+	{
+		clk_resync_in  = DS3231_CLK_RESYNC_PERIOD;
+		clk_resync_due = 1;
+	}
+}
+
+/*
+ * Seqlock-style resync: an edge during the I2C read may or may not be in
+ * the registers read, so such a read is thrown away. The check and the
+ * load share one atomic section, so no edge can slip in between.
+ */
+void DS3231_CLK_Service(void)
+{
+	DS3231_Datetime_t now;
+	uint32_t before;
+	
+	if(!clk_resync_due) return;
+	
+	clk_resync_due = 0;
+	
+	for(uint8_t i = 0; i < CLK_RESYNC_TRIES; ++i)
+	{
+		uint8_t loaded = 0;
+		
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) before = clk_seconds;
+		
+		DS3231_GetTime(&now);
+		
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			if(clk_seconds == before)
+			{
+				clk_load(&now);
+				loaded = 1;
+			}
+		}
+		
+		if(loaded) return;
+	}
+	
+	clk_resync_due = 1;
+}
+
+uint16_t DS3231_CLK_Now(DS3231_Datetime_t* now)
+{
+	uint16_t ms;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		now->sec   = clk_time.sec;
+		now->min   = clk_time.min;
+		now->hour  = clk_time.hour;
+		now->day   = clk_time.day;
+		now->date  = clk_time.date;
+		now->month = clk_time.month;
+		now->year  = clk_time.year;
+		ms = clk_subsec;
+	}
+	
+	return ms;
+}
+
+uint32_t DS3231_CLK_Seconds(void)
+{
+	uint32_t secs;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) secs = clk_seconds;
+	
+	return secs;
+}
+
+void DS3231_CLK_RequestResync(void)
+{
+	clk_resync_due = 1;
+}
+
+#if DS3231_CLK_USE_INT0
+static void clk_on_sqw(unsigned char level, uint32_t stamp)
+{
+	DS3231_CLK_OnEdge();
+}
+#endif
+
+#if DS3231_CLK_USE_SUBSEC
+ISR(TIMER2_COMPA_vect)
+{
+	if(clk_subsec < 999U) clk_subsec++;
+}
+#endif
+
+/*
+ * Add one second to t, rolling over minutes, hours, day of week, date,
+ * month and year (Gregorian leap years).
+ */
+static void clk_advance(DS3231_Datetime_t* t)
+{
+	uint8_t mdays;
+	
+	if(++t->sec < 60U) return;
+	t->sec = 0;
+	
+	if(++t->min < 60U) return;
+	t->min = 0;
+	
+	if(++t->hour < 24U) return;
+	t->hour = 0;
+	
+	if(++t->day > 7U) t->day = 1;
+	
+	mdays = clk_month_days[(t->month - 1U) % 12U];
+	
+	if(t->month == 2U && (t->year % 4U) == 0U && ((t->year % 100U) != 0U || (t->year % 400U) == 0U)) mdays = 29;
+	
+	if(++t->date <= mdays) return;
+	t->date = 1;
+	
+	if(++t->month <= 12U) return;
+	t->month = 1;
+	
+	t->year++;
+}
+
+static void clk_load(const DS3231_Datetime_t* t)
+{
+	clk_time.sec   = t->sec;
+	clk_time.min   = t->min;
+	clk_time.hour  = t->hour;
+	clk_time.day   = t->day;
+	clk_time.date  = t->date;
+	clk_time.month = t->month;
+	clk_time.year  = t->year;
+}
@@ -0,0 +1,141 @@
+/*
+ * uc-Microlab — DS3231 Software Clock (header)
+ * File: ds3231-clock.h / ds3231-clock.c
+ *
+ * Project: uc-MicroLab
+ * Component: DS3231 SQW-disciplined software clock
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Optional time-keeping layer on top of the DS3231 driver (ds3231.h).
+ *   The date and time are read from the DS3231 once, then a local copy is
+ *   advanced on every edge of the 1 Hz INT/SQW square wave. A CTC timer
+ *   provides a millisecond sub-second tick between edges. Reading the
+ *   current time is a few instructions with interrupts briefly masked,
+ *   instead of a full 8-byte I2C transaction plus seven BCD decodes.
+ *   The local copy is resynchronized with the DS3231 periodically.
+ *
+ * Public API:
+ *   void DS3231_CLK_Init(void);
+ *     Read the current time from the DS3231, select the 1 Hz square wave
+ *     (DS3231_SetSQWFreq(DS3231_SQW_1HZ) + DS3231_EnableSQW()), register
+ *     the PD2 (INT0) edge callback and start the Timer2 sub-second tick. DS3231_Init()
+ *     must have been called before. Global interrupts must be enabled by
+ *     the application.
+ *
+ *   void DS3231_CLK_OnEdge(void);
+ *     Advance the local clock by one second. Called from the PD2 edge
+ *     callback of this module, or by the application's own handler when built
+ *     with DS3231_CLK_USE_INT0 = 0. Must be called with interrupts
+ *     disabled (ISR context).
+ *
+ *   void DS3231_CLK_Service(void);
+ *     Run pending work outside interrupt context: when a resync is due,
+ *     re-read the time from the DS3231 and load it into the local clock.
+ *     Call it from the main loop.
+ *
+ *   uint16_t DS3231_CLK_Now(DS3231_Datetime_t *now);
+ *     Copy the local date and time into now and return the milliseconds
+ *     elapsed in the current second (0–999, always 0 when
+ *     DS3231_CLK_USE_SUBSEC = 0).
+ *
+ *   uint32_t DS3231_CLK_Seconds(void);
+ *     Monotonic seconds counter, incremented on every SQW edge since
+ *     DS3231_CLK_Init. Unaffected by resyncs; use it for interval math.
+ *
+ *   void DS3231_CLK_RequestResync(void);
+ *     Force a resync on the next DS3231_CLK_Service call.
+ *
+ * Configuration (compile-time, define before building ds3231-clock.c):
+ *   DS3231_CLK_RESYNC_PERIOD - seconds between automatic resyncs
+ *                              (default 3600).
+ *   DS3231_CLK_USE_INT0      - 1 (default): INT/SQW is wired to INT0 (PD2)
+ *                              and this module attaches to it through the
+ *                              port interrupt dispatcher (port-irq.h;
+ *                              link port-irq.c). 0: the application calls
+ *                              DS3231_CLK_OnEdge itself.
+ *   DS3231_CLK_USE_SUBSEC    - 1 (default): Timer2 in CTC mode generates a
+ *                              1 kHz tick and this module owns
+ *                              TIMER2_COMPA_vect. 0: no sub-second tick.
+ *
+ * Usage:
+ *   - Include this header where the software clock is required:
+ *       #include "ds3231-clock.h"
+ *
+ *   - Start the clock:
+ *       DS3231_Init();
+ *       DS3231_CLK_Init();
+ *       sei();
+ *
+ *   - Timestamp samples in the main loop:
+ *       DS3231_Datetime_t now;
+ *       uint16_t ms = DS3231_CLK_Now(&now);
+ *       DS3231_CLK_Service();
+ *
+ *   - Measure an interval:
+ *       uint32_t t0 = DS3231_CLK_Seconds();
+ *       ...
+ *       uint32_t elapsed = DS3231_CLK_Seconds() - t0;
+ *
+ * Notes:
+ *   - INT/SQW is an open-drain output. DS3231_CLK_Init enables the PD2
+ *     internal pull-up; add an external pull-up for long wires.
+ *   - The local clock counts falling edges of the 1 Hz square wave. The
+ *     sub-second counter restarts at each edge and saturates at 999.
+ *   - A resync read that overlaps an edge is discarded and repeated: the
+ *     chip may have latched its seconds before or after that edge, so the
+ *     read is only trusted when no edge arrived while it ran. Edges are a
+ *     second apart and the read takes about 1 ms, so the retry succeeds;
+ *     after three overlapping reads the resync stays pending for the next
+ *     DS3231_CLK_Service call.
+ *   - Only the 24-hour mode of the DS3231 is supported.
+ *   - Using the Alarm interrupt output (INTCN = 1) is not possible while
+ *     this module is running, because INT/SQW carries the square wave.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for DS3231 software clock
+ *   2026-10-14  v0.2  SQW edges come from HAL_Port_Attach instead of a private INT0_vect
+ *   2026-10-14  v0.3  Sub-second tick prescaler and compare value come from the CTC HAL solver
+ *   2026-10-14  v0.4  Sub-second tick holds IDLE on Timer2 (power-hal.h)
+ *   2026-10-14  v0.5  A resync read that overlaps an SQW edge is retried instead of
+ *                     corrected, which could leave the clock one second fast
+ *
+ */
+
+#ifndef DS3231_CLOCK_H_
+#define DS3231_CLOCK_H_
+
+#include <stdint.h>
+#include "ds3231.h"
+
+#ifndef DS3231_CLK_RESYNC_PERIOD
+	#define DS3231_CLK_RESYNC_PERIOD 3600U
+#endif
+
+#ifndef DS3231_CLK_USE_INT0
+	#define DS3231_CLK_USE_INT0 1
+#endif
+
+#ifndef DS3231_CLK_USE_SUBSEC
+	#define DS3231_CLK_USE_SUBSEC 1
+#endif
+
+void DS3231_CLK_Init(void);
+
+void DS3231_CLK_OnEdge(void);
+void DS3231_CLK_Service(void);
+
+uint16_t DS3231_CLK_Now(DS3231_Datetime_t* now);
+uint32_t DS3231_CLK_Seconds(void);
+
+void DS3231_CLK_RequestResync(void);
+
+#endif /* DS3231_CLOCK_H_ */
@@ -15,14 +15,21 @@
  *
  * Public API:
  *   void DS3231_Init(void);
- *     Initialize the DS3231. Configures the I2C bus at 400 kHz and
- *     clears the EOSC bit in the control register to ensure the
+ *     Initialize the DS3231. Configures the I2C bus at the fastest rate up
+ *     to 400 kHz (the DS3231 maximum) that F_CPU allows, primes the
+ *     driver's shadow copies of the control, status and aging registers
+ *     and clears the EOSC bit in the control register to ensure the
  *     oscillator is running.
  *
+ *   void DS3231_Resync(void);
+ *     Re-read the control, status and aging registers into the driver's
+ *     shadow copies. Call it when the chip may have been modified by
+ *     another I2C controller or lost power while the MCU kept running.
+ *
  *   void DS3231_SetTime(DS3231_Datetime_t *time);
  *     Write the date and time to the DS3231 timekeeping registers.
  *     The century bit (bit 7 of the month register) is set automatically
- *     when year >= 2100.
+ *     when year >= 2100; time is not modified.
  *
  *   void DS3231_GetTime(DS3231_Datetime_t *time);
  *     Read the current date and time from the DS3231 timekeeping registers
@@ -30,7 +37,8 @@
  *
  *   void DS3231_SetAlarm1(DS3231_Datetime_t *time, uint8_t mode);
  *     Configure and enable Alarm 1. The mode parameter selects one of the
- *     six alarm match conditions defined by DS3231_ALM1_* constants.
+ *     six alarm match conditions defined by DS3231_ALM1_* constants. Day
+ *     matches use time->day (day of week), date matches time->date.
  *
  *   void DS3231_DisableAlarm1(void);
  *     Disable Alarm 1 interrupt by clearing the A1IE bit in the control
@@ -42,7 +50,8 @@
  *
  *   void DS3231_SetAlarm2(DS3231_Datetime_t *time, uint8_t mode);
  *     Configure and enable Alarm 2. The mode parameter selects one of the
- *     five alarm match conditions defined by DS3231_ALM2_* constants.
+ *     five alarm match conditions defined by DS3231_ALM2_* constants. Day
+ *     and date matches work as for DS3231_SetAlarm1.
  *
  *   void DS3231_DisableAlarm2(void);
  *     Disable Alarm 2 interrupt by clearing the A2IE bit in the control
@@ -52,21 +61,53 @@
  *     Enable Alarm 2 interrupt by setting the A2IE bit in the control
  *     register.
  *
+ *   uint8_t DS3231_Configure(const DS3231_Config_t *cfg);
+ *     Write time, both alarms, control and status (registers 0x00-0x0F)
+ *     in one auto-incrementing I2C burst of 17 bytes, clearing the status
+ *     flags selected in cfg->clear. Replaces DS3231_SetTime, both
+ *     DS3231_SetAlarmN, the control and status updates and the flag
+ *     clear, each a transaction of its own. Returns the I2C status
+ *     (HAL_I2C_ST_*); the shadow registers are updated on success.
+ *
+ *   uint8_t DS3231_Snapshot(DS3231_Snapshot_t *snap);
+ *     Read all 19 registers (0x00-0x12) in one repeated-START burst and
+ *     decode them into snap. The shadow registers are refreshed as by
+ *     DS3231_Resync. Returns the I2C status; snap is untouched on error.
+ *
+ *   int16_t DS3231_GetTempQ2(void);
+ *     Read the internal temperature sensor. Returns the raw signed 10-bit
+ *     value in quarter degrees Celsius (e.g. 101 = 25.25 °C).
+ *
+ *   int16_t DS3231_GetTempCenti(void);
+ *     Read the internal temperature sensor. Returns the temperature in
+ *     hundredths of a degree Celsius (e.g. 2525 = 25.25 °C).
+ *
  *   float DS3231_GetTemp(void);
  *     Read the internal temperature sensor. Returns the temperature in
- *     degrees Celsius with 0.25 °C resolution.
+ *     degrees Celsius with 0.25 °C resolution. Only available when
+ *     DS3231_USE_FLOAT is non-zero.
+ *
+ *   uint8_t DS3231_StartTempConversion(void);
+ *     Start a temperature conversion by setting the CONV bit, without
+ *     waiting for it. Returns 1 if the conversion was started, or 0 if the
+ *     chip is busy with a conversion of its own (BSY set); retry later.
+ *
+ *   uint8_t DS3231_IsTempReady(void);
+ *     Return 1 once the conversion started by DS3231_StartTempConversion
+ *     has finished (CONV cleared by the chip), 0 while it is running.
  *
  *   void DS3231_SetSQWFreq(uint8_t freq);
  *     Set the square-wave output frequency using one of the DS3231_SQW_*
  *     constants (1 Hz, 1.024 kHz, 4.096 kHz, or 8.192 kHz).
  *
  *   void DS3231_EnableSQW(void);
- *     Enable the square-wave output on the INT/SQW pin by setting the
+ *     Enable the square-wave output on the INT/SQW pin by clearing the
  *     INTCN bit in the control register.
  *
  *   void DS3231_DisableSQW(void);
- *     Disable the square-wave output on the INT/SQW pin by clearing the
- *     INTCN bit in the control register.
+ *     Disable the square-wave output on the INT/SQW pin by setting the
+ *     INTCN bit in the control register. INT/SQW then acts as the alarm
+ *     interrupt output.
  *
  *   void DS3231_Enable32khz(void);
  *     Enable the 32 kHz output pin by setting the EN32KHZ bit in the
@@ -90,8 +131,8 @@
  *     the oscillator frequency.
  *
  *   int8_t DS3231_GetAging(void);
- *     Read and return the current aging offset register value as a
- *     signed 8-bit integer.
+ *     Return the current aging offset register value as a signed 8-bit
+ *     integer (served from the shadow copy, no I2C traffic).
  *
  * Public types:
  *   DS3231_Datetime_t
@@ -104,10 +145,43 @@
  *       uint8_t  month — month         (1–12)
  *       uint16_t year  — full year     (2000–2199)
  *
+ *   DS3231_Config_t
+ *     Register file 0x00-0x0F as written by DS3231_Configure:
+ *       DS3231_Datetime_t time        — current date and time
+ *       DS3231_Datetime_t alarm1      — alarm 1 sec, min, hour, day or date
+ *       uint8_t           alarm1_mode — DS3231_ALM1_* match mode
+ *       DS3231_Datetime_t alarm2      — alarm 2 min, hour, day or date
+ *       uint8_t           alarm2_mode — DS3231_ALM2_* match mode
+ *       uint8_t           control     — control register (DS3231_CTRL_*;
+ *                                       CONV is ignored)
+ *       uint8_t           status      — status register; only
+ *                                       DS3231_STAT_EN32KHZ is written
+ *       uint8_t           clear       — flags to clear (DS3231_STAT_A1F,
+ *                                       _A2F, _OSF); the others are kept
+ *
+ *   DS3231_Snapshot_t
+ *     Whole register file as read by DS3231_Snapshot:
+ *       DS3231_Config_t cfg     — registers 0x00-0x0F; cfg.status holds
+ *                                 the raw status register with its flags,
+ *                                 cfg.clear is 0, alarm fields that are
+ *                                 not matched read back as 0
+ *       int8_t          aging   — aging offset
+ *       int16_t         temp_q2 — temperature in quarter degrees Celsius
+ *
+ * Configuration (compile-time):
+ *   DS3231_USE_FLOAT        - 1 (default) provides the float
+ *                             DS3231_GetTemp(). Build with
+ *                             -DDS3231_USE_FLOAT=0 to keep floating point
+ *                             out of images that only use the integer API.
+ *
  * Public constants:
  *   Device address:
  *     DS3231_ADDR             - 7-bit I2C address (0x68)
  *
+ *   Burst sizes:
+ *     DS3231_CONFIG_REGS      - registers written by DS3231_Configure (16)
+ *     DS3231_SNAPSHOT_REGS    - registers read by DS3231_Snapshot (19)
+ *
  *   Register map:
  *     DS3231_REG_SECONDS      - Seconds register         (0x00)
  *     DS3231_REG_MINUTES      - Minutes register         (0x01)
@@ -186,8 +260,35 @@
  *       DS3231_Datetime_t alarm = {0, 0, 7, 0, 0, 0, 0};
  *       DS3231_SetAlarm1(&alarm, DS3231_ALM1_MTC_HR_MIN_SEC);
  *
- *   - Read the temperature:
- *       float temp = DS3231_GetTemp();
+ *   - Boot-time setup in a single transfer: set the clock, wake up every
+ *     day at 07:00:00 on alarm 1, INT/SQW as alarm output, clear OSF and
+ *     any pending alarm flags:
+ *       DS3231_Config_t cfg =
+ *       {
+ *           .time        = {0, 30, 14, 4, 26, 2, 2026},
+ *           .alarm1      = {0, 0, 7, 0, 0, 0, 0},
+ *           .alarm1_mode = DS3231_ALM1_MTC_HR_MIN_SEC,
+ *           .alarm2_mode = DS3231_ALM2_PER_MIN,
+ *           .control     = DS3231_CTRL_INTCN | DS3231_CTRL_A1IE,
+ *           .clear       = DS3231_STAT_A1F | DS3231_STAT_A2F | DS3231_STAT_OSF
+ *       };
+ *       DS3231_Configure(&cfg);
+ *
+ *   - Dump the whole chip state:
+ *       DS3231_Snapshot_t snap;
+ *       if(DS3231_Snapshot(&snap) == HAL_I2C_ST_OK) print_rtc(&snap);
+ *
+ *   - Read the temperature in quarter degrees:
+ *       int16_t temp_q2 = DS3231_GetTempQ2();
+ *
+ *   - Refresh the temperature without waiting for the 64 s automatic
+ *     conversion:
+ *       if(DS3231_StartTempConversion())
+ *       {
+ *           // ... do other work ...
+ *           while(!DS3231_IsTempReady());
+ *           int16_t temp_c100 = DS3231_GetTempCenti();
+ *       }
  *
  *   - Enable a 1 Hz square wave on the INT/SQW pin:
  *       DS3231_SetSQWFreq(DS3231_SQW_1HZ);
@@ -203,9 +304,24 @@
  *   - The EOSC bit is active-low: clearing it enables the oscillator.
  *   - Temperature resolution is 0.25 °C (10-bit signed value, two MSBs of
  *     the LSB register).
- *   - All operations are blocking. The underlying I2C HAL uses polling.
+ *   - All operations are blocking. Register reads use a single
+ *     repeated-START write-then-read transaction (HAL_I2C_ReadReg /
+ *     HAL_I2C_ReadRegs).
+ *   - The control, status (EN32KHZ) and aging registers are cached in
+ *     write-through shadow copies primed by DS3231_Init. Enable/Disable/
+ *     Set calls apply the change to the shadow and issue a single write,
+ *     or no I2C traffic at all when the value does not change. A shadow
+ *     is only updated when its write succeeds, so a failed call is retried
+ *     in full next time. Use DS3231_Resync() if the chip may have been
+ *     modified externally.
+ *   - DS3231_IsOSCStopped always reads the status register, because the
+ *     flag bits (A1F, A2F, BSY, OSF) are updated by the chip itself.
  *   - Alarm flag bits (A1F, A2F) in the status register must be cleared
  *     by the application after each alarm event.
+ *   - DS3231_Configure writes the seconds register, which restarts the
+ *     chip's one-second countdown: call it to set the clock, not to
+ *     change an alarm on a running clock.
+ *   - Hours are always written and decoded in 24-hour mode.
  *
  * Author: otavioacb
  * Created: 2026-02-26
@@ -217,6 +333,21 @@
  *
  * Change log:
  *   2026-02-26  v0.1  Initial header for DS3231 RTC driver
+ *   2026-10-14  v0.2  Ported register access onto repeated-START I2C helpers
+ *                     Fixed DS3231_DisableAlarm1 clearing every bit except A1IE
+ *   2026-10-14  v0.3  Added write-through shadow registers and DS3231_Resync
+ *   2026-10-14  v0.4  Fixed inverted INTCN handling in DS3231_EnableSQW / DS3231_DisableSQW
+ *                     Added the SQW-disciplined software clock (ds3231-clock.h)
+ *   2026-10-14  v0.5  Added fixed-point temperature API (DS3231_GetTempQ2, DS3231_GetTempCenti),
+ *                     DS3231_StartTempConversion / DS3231_IsTempReady and the DS3231_USE_FLOAT option
+ *   2026-10-14  v0.6  DS3231_Init requests HAL_I2C_FREQ_FAST, the fastest rate up to 400 kHz for any F_CPU
+ *   2026-10-14  v0.7  Added DS3231_Configure (0x00-0x0F in one burst) and DS3231_Snapshot
+ *                     (all 19 registers). Fixed the year register from 2056 on, the century
+ *                     bit leaking into the month on read and write, and date-match alarms
+ *                     using the day of week. SetAlarmN writes the alarm before enabling it
+ *   2026-10-14  v0.8  DS3231_SetAlarm1 / DS3231_SetAlarm2 now encode through the DS3231_Configure
+ *                     alarm helper: registers written before the enable, date matches use time->date
+ *                     Shadow registers are no longer updated when their I2C write fails
  *
  */
 
@@ -225,33 +356,52 @@
 #define TO_BCD(val) ((uint8_t)((((val) / 10U) << 4U) | ((val) % 10U)))
 #define TO_BIN(val) ((uint8_t)((((val) >> 4U) * 10U) + ((val) & 0x0FU)))
 
+/*
+ * Write-through shadow copies of the configuration registers. The flag
+ * bits of the status register (A1F, A2F, BSY, OSF) are owned by the chip
+ * and are not cached; DS3231_STAT_FLAGS are written back as 1, which
+ * leaves them unchanged.
+ */
+#define DS3231_STAT_FLAGS (DS3231_STAT_A1F | DS3231_STAT_A2F | DS3231_STAT_OSF)
+
+static uint8_t ds3231_ctrl   = 0x00;
+static uint8_t ds3231_status = 0x00;
+static uint8_t ds3231_aging  = 0x00;
+
+static void ds3231_update_ctrl(uint8_t mask, uint8_t value);
+static void ds3231_update_status(uint8_t mask, uint8_t value);
+
+static void ds3231_encode_time(uint8_t* regs, const DS3231_Datetime_t* time);
+static void ds3231_decode_time(const uint8_t* regs, DS3231_Datetime_t* time);
+static void ds3231_encode_alarm(uint8_t* regs, uint8_t n, const DS3231_Datetime_t* time, uint8_t mode);
+static uint8_t ds3231_decode_alarm(const uint8_t* regs, uint8_t n, DS3231_Datetime_t* time);
+
 void DS3231_Init(void)
 {
-	HAL_I2C_InitController(400000U);
+	HAL_I2C_InitController(HAL_I2C_FREQ_FAST);
 	
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
+	DS3231_Resync();
 	
-	reg_ctrl &= ~DS3231_CTRL_EOSC;
+	ds3231_update_ctrl(DS3231_CTRL_EOSC, 0x00);
+}
+
+void DS3231_Resync(void)
+{
+	uint8_t regs[3];
+	
+	HAL_I2C_ReadRegs(DS3231_ADDR, DS3231_REG_CONTROL, regs, 3);
 	
-	uint8_t buff[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	ds3231_ctrl   = regs[0] & ~DS3231_CTRL_CONV;
+	ds3231_status = regs[1] & DS3231_STAT_EN32KHZ;
+	ds3231_aging  = regs[2];
 }
 
 void DS3231_SetTime(DS3231_Datetime_t* time)
 {
 	uint8_t buff[8];
 	
-	if(time->year >= 2100U) time->month |= 0x80U;
-	
 	buff[0] = DS3231_REG_SECONDS;
-	buff[1] = TO_BCD(time->sec);
-	buff[2] = TO_BCD(time->min);
-	buff[3] = TO_BCD(time->hour);
-	buff[4] = TO_BCD(time->day);
-	buff[5] = TO_BCD(time->date);
-	buff[6] = TO_BCD(time->month);
-	buff[7] = TO_BCD((uint8_t)time->year % 100U);
+	ds3231_encode_time(&buff[1], time);
 	
 	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 8);
 }
@@ -260,237 +410,317 @@ void DS3231_GetTime(DS3231_Datetime_t* time)
 {
 	uint8_t reg_vals[7];
 
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_SECONDS);
-	HAL_I2C_ControllerReceive(DS3231_ADDR, reg_vals, 7);
+	HAL_I2C_ReadRegs(DS3231_ADDR, DS3231_REG_SECONDS, reg_vals, 7);
 
-	time->sec   = TO_BIN(reg_vals[0]);
-	time->min   = TO_BIN(reg_vals[1]);
-	time->hour  = TO_BIN(reg_vals[2]);
-	time->day   = reg_vals[3];
-	time->date  = TO_BIN(reg_vals[4]);
-	time->month = TO_BIN(reg_vals[5]);
-	time->year  = TO_BIN(reg_vals[6]);
-	
-	if (reg_vals[5] & 0x80U) time->year += 2100U;
-	else time->year += 2000U;
+	ds3231_decode_time(reg_vals, time);
 }
 
 void DS3231_SetAlarm1(DS3231_Datetime_t* time, uint8_t mode)
 {
-	DS3231_EnableAlarm1();
-	
-	uint8_t buff[5] = {
-		DS3231_REG_ALM1_SEC,
-		TO_BCD(time->sec),
-		TO_BCD(time->min),
-		TO_BCD(time->hour),
-		TO_BCD(time->day)
-	};
-	
-	switch(mode)
-	{
-		case DS3231_ALM1_PER_SEC:
-			buff[1] = 0x80;
-			buff[2] = 0x80;
-			buff[3] = 0x80;
-			buff[4] = 0x80; 
-			break;
-		case DS3231_ALM1_MTC_SECS:
-			buff[2] |= 0x80U;
-			buff[3] |= 0x80U;
-			buff[4] |= 0x80U;
-			break;
-		case DS3231_ALM1_MTC_MIN_SEC:
-			buff[3] |= 0x80U;
-			buff[4] |= 0x80U;
-			break;
-		case DS3231_ALM1_MTC_HR_MIN_SEC:
-			buff[4] |= 0x80U;
-			break;
-		case DS3231_ALM1_MTC_DT_HR_MIN_SEC:
-			break;
-		case DS3231_ALM1_MTC_DY_DT_HR_MIN_SEC:
-			buff[4] |= 0x40U;
-			break;
-		default:
-			break;
-	}
+	uint8_t buff[5] = {DS3231_REG_ALM1_SEC};
 	
+	ds3231_encode_alarm(&buff[1], 4, time, mode);
 	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 5);
+	
+	DS3231_EnableAlarm1();
 }
 
 void DS3231_DisableAlarm1(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_ctrl &= DS3231_CTRL_A1IE;
-	uint8_t cmd[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, cmd, 2);
+	ds3231_update_ctrl(DS3231_CTRL_A1IE, 0x00);
 }
 
 void DS3231_EnableAlarm1(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_ctrl |= DS3231_CTRL_A1IE;
-	uint8_t cmd[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, cmd, 2);
+	ds3231_update_ctrl(DS3231_CTRL_A1IE, DS3231_CTRL_A1IE);
 }
 
 void DS3231_SetAlarm2(DS3231_Datetime_t* time, uint8_t mode)
 {
-	DS3231_EnableAlarm2();
-	
-	uint8_t buff[4] = {
-		DS3231_REG_ALM2_MIN,
-		TO_BCD(time->min),
-		TO_BCD(time->hour),
-		TO_BCD(time->day)
-	};
-	
-	switch(mode)
-	{
-		case DS3231_ALM2_PER_MIN:
-			buff[1] = 0x80;
-			buff[2] = 0x80;
-			buff[3] = 0x80;
-			break;
-		case DS3231_ALM2_MTC_MIN:
-			buff[2] |= 0x80U;
-			buff[3] |= 0x80U;
-			break;
-		case DS3231_ALM2_MTC_HR_MIN:
-			buff[3] |= 0x80U;
-			break;
-		case DS3231_ALM2_MTC_DT_HR_MIN:
-			break;
-		case DS3231_ALM2_MTC_DY_DT_HR_MIN:
-			buff[3] |= 0x40U; 
-			break;
-		default:
-			break;
-	}
+	uint8_t buff[4] = {DS3231_REG_ALM2_MIN};
 	
+	ds3231_encode_alarm(&buff[1], 3, time, mode);
 	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 4);
+	
+	DS3231_EnableAlarm2();
 }
 
 void DS3231_DisableAlarm2(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_ctrl &= ~DS3231_CTRL_A2IE;
-	uint8_t cmd[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, cmd, 2);
+	ds3231_update_ctrl(DS3231_CTRL_A2IE, 0x00);
 }
 
 void DS3231_EnableAlarm2(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
+	ds3231_update_ctrl(DS3231_CTRL_A2IE, DS3231_CTRL_A2IE);
+}
+
+uint8_t DS3231_Configure(const DS3231_Config_t* cfg)
+{
+	uint8_t buff[1 + DS3231_CONFIG_REGS];
+	uint8_t status;
 	
-	reg_ctrl |= DS3231_CTRL_A2IE;
-	uint8_t cmd[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, cmd, 2);
+	buff[0] = DS3231_REG_SECONDS;
+	ds3231_encode_time(&buff[1 + DS3231_REG_SECONDS], &cfg->time);
+	ds3231_encode_alarm(&buff[1 + DS3231_REG_ALM1_SEC], 4, &cfg->alarm1, cfg->alarm1_mode);
+	ds3231_encode_alarm(&buff[1 + DS3231_REG_ALM2_MIN], 3, &cfg->alarm2, cfg->alarm2_mode);
+	
+	/* CONV is never set here; flags written as 1 are left unchanged */
+	buff[1 + DS3231_REG_CONTROL] = cfg->control & ~DS3231_CTRL_CONV;
+	buff[1 + DS3231_REG_STATUS]  = (cfg->status & DS3231_STAT_EN32KHZ) | (DS3231_STAT_FLAGS & ~cfg->clear);
+	
+	status = HAL_I2C_ControllerWriteRead(DS3231_ADDR, buff, sizeof(buff), NULL, 0);
+	
+	if(status == HAL_I2C_ST_OK)
+	{
+		ds3231_ctrl   = buff[1 + DS3231_REG_CONTROL];
+		ds3231_status = buff[1 + DS3231_REG_STATUS] & DS3231_STAT_EN32KHZ;
+	}
+	
+	return status;
 }
 
-float DS3231_GetTemp()
+uint8_t DS3231_Snapshot(DS3231_Snapshot_t* snap)
+{
+	uint8_t regs[DS3231_SNAPSHOT_REGS];
+	uint8_t status = HAL_I2C_ReadRegs(DS3231_ADDR, DS3231_REG_SECONDS, regs, sizeof(regs));
+	
+	if(status != HAL_I2C_ST_OK) return status;
+	
+	ds3231_decode_time(&regs[DS3231_REG_SECONDS], &snap->cfg.time);
+	snap->cfg.alarm1_mode = ds3231_decode_alarm(&regs[DS3231_REG_ALM1_SEC], 4, &snap->cfg.alarm1);
+	snap->cfg.alarm2_mode = ds3231_decode_alarm(&regs[DS3231_REG_ALM2_MIN], 3, &snap->cfg.alarm2);
+	
+	snap->cfg.control = regs[DS3231_REG_CONTROL];
+	snap->cfg.status  = regs[DS3231_REG_STATUS];
+	snap->cfg.clear   = 0x00;
+	
+	snap->aging   = (int8_t) regs[DS3231_REG_AGING];
+	snap->temp_q2 = (int16_t) (((uint16_t) regs[DS3231_REG_TEMP_MSB] << 2U) | (regs[DS3231_REG_TEMP_LSB] >> 6U));
+	
+	if(snap->temp_q2 & 0x0200) snap->temp_q2 |= (int16_t) 0xFC00;
+	
+	/* The whole register file was read: refresh the shadows as well */
+	ds3231_ctrl   = regs[DS3231_REG_CONTROL] & ~DS3231_CTRL_CONV;
+	ds3231_status = regs[DS3231_REG_STATUS] & DS3231_STAT_EN32KHZ;
+	ds3231_aging  = regs[DS3231_REG_AGING];
+	
+	return HAL_I2C_ST_OK;
+}
+
+int16_t DS3231_GetTempQ2(void)
 {
 	uint8_t temp_bytes[2];
 	int16_t raw_temp;
 	
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_TEMP_MSB);
-	HAL_I2C_ControllerReceive(DS3231_ADDR, temp_bytes, 2);
+	HAL_I2C_ReadRegs(DS3231_ADDR, DS3231_REG_TEMP_MSB, temp_bytes, 2);
 	
 	raw_temp = (int16_t) (((uint16_t)temp_bytes[0] << 2U) | (temp_bytes[1] >> 6U));
 
 	if(raw_temp & 0x0200) raw_temp |= (int16_t) 0xFC00;
 	
-	return (float) raw_temp * 0.25f;
+	return raw_temp;
 }
 
-void DS3231_SetSQWFreq(uint8_t freq)
+int16_t DS3231_GetTempCenti(void)
+{
+	return DS3231_GetTempQ2() * 25;
+}
+
+#if DS3231_USE_FLOAT
+float DS3231_GetTemp()
+{
+	return (float) DS3231_GetTempQ2() * 0.25f;
+}
+#endif
+
+/*
+ * A conversion must not be forced while the chip is busy with its own
+ * (automatic, every 64 s) TCXO cycle, so BSY is checked first.
+ */
+uint8_t DS3231_StartTempConversion(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
+	uint8_t reg_status = HAL_I2C_ReadReg(DS3231_ADDR, DS3231_REG_STATUS);
+	
+	if(reg_status & DS3231_STAT_BSY) return 0U;
 	
-	reg_ctrl = (reg_ctrl & 0xE7) | freq;
+	ds3231_update_ctrl(DS3231_CTRL_CONV, DS3231_CTRL_CONV);
 	
-	uint8_t buff[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	return 1U;
 }
 
-void DS3231_EnableSQW(void)
+uint8_t DS3231_IsTempReady(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
+	uint8_t reg_ctrl = HAL_I2C_ReadReg(DS3231_ADDR, DS3231_REG_CONTROL);
 	
-	reg_ctrl |= DS3231_CTRL_INTCN;
-	uint8_t buff[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	return (reg_ctrl & DS3231_CTRL_CONV) ? 0U : 1U;
+}
+
+void DS3231_SetSQWFreq(uint8_t freq)
+{
+	ds3231_update_ctrl(DS3231_CTRL_RS2 | DS3231_CTRL_RS1, freq);
+}
+
+/*
+ * INTCN = 0 routes the square wave to INT/SQW; INTCN = 1 turns the
+ * pin into the (active-low) alarm interrupt output.
+ */
+void DS3231_EnableSQW(void)
+{
+	ds3231_update_ctrl(DS3231_CTRL_INTCN, 0x00);
 }
 
 void DS3231_DisableSQW(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_ctrl &= ~DS3231_CTRL_INTCN;
-	uint8_t buff[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	ds3231_update_ctrl(DS3231_CTRL_INTCN, DS3231_CTRL_INTCN);
 }
 
 void DS3231_Enable32khz(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_STATUS);
-	uint8_t reg_status = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_status |= DS3231_STAT_EN32KHZ;
-	uint8_t buff[2] = {DS3231_REG_STATUS, reg_status};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	ds3231_update_status(DS3231_STAT_EN32KHZ, DS3231_STAT_EN32KHZ);
 }
 
 void DS3231_Disable32khz(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_STATUS);
-	uint8_t reg_status = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_status &= ~DS3231_STAT_EN32KHZ;
-	uint8_t buff[2] = {DS3231_REG_STATUS, reg_status};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	ds3231_update_status(DS3231_STAT_EN32KHZ, 0x00);
 }
 
 void DS3231_EnableOSC(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_CONTROL);
-	uint8_t reg_ctrl = HAL_I2C_ControllerRead(DS3231_ADDR);
-	
-	reg_ctrl &= ~DS3231_CTRL_EOSC;
-	uint8_t buff[2] = {DS3231_REG_CONTROL, reg_ctrl};
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	ds3231_update_ctrl(DS3231_CTRL_EOSC, 0x00);
 }
 
 uint8_t DS3231_IsOSCStopped(void)
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_STATUS);
-	uint8_t reg_status = HAL_I2C_ControllerRead(DS3231_ADDR);
+	uint8_t reg_status = HAL_I2C_ReadReg(DS3231_ADDR, DS3231_REG_STATUS);
 	
 	return (reg_status & DS3231_STAT_OSF) ? 1U : 0U;
 }
 
 void DS3231_SetAging(int8_t offset)
 {
-	uint8_t buff[2] = {DS3231_REG_AGING, (uint8_t) offset};
-		
-	HAL_I2C_ControllerTransmit(DS3231_ADDR, buff, 2);
+	if((uint8_t) offset == ds3231_aging) return;
+	
+	if(HAL_I2C_WriteReg(DS3231_ADDR, DS3231_REG_AGING, (uint8_t) offset) == HAL_I2C_ST_OK)
+	{
+		ds3231_aging = (uint8_t) offset;
+	}
 }
 
 int8_t DS3231_GetAging()
 {
-	HAL_I2C_ControllerSend(DS3231_ADDR, DS3231_REG_AGING);
-	uint8_t raw_aging = HAL_I2C_ControllerRead(DS3231_ADDR);
+	return (int8_t) ds3231_aging;
+}
+
+/*
+ * Apply a bit change to the control shadow and write it only if it
+ * differs. CONV is self-clearing on the chip, so it is never kept in
+ * the shadow (otherwise every later write would start a conversion).
+ * The shadow is only committed when the write succeeds.
+ */
+static void ds3231_update_ctrl(uint8_t mask, uint8_t value)
+{
+	uint8_t reg_ctrl = (ds3231_ctrl & ~mask) | (value & mask);
+	
+	if(reg_ctrl == ds3231_ctrl) return;
+	
+	if(HAL_I2C_WriteReg(DS3231_ADDR, DS3231_REG_CONTROL, reg_ctrl) == HAL_I2C_ST_OK)
+	{
+		ds3231_ctrl = reg_ctrl & ~DS3231_CTRL_CONV;
+	}
+}
+
+static void ds3231_update_status(uint8_t mask, uint8_t value)
+{
+	uint8_t reg_status = (ds3231_status & ~mask) | (value & mask);
+	
+	reg_status &= DS3231_STAT_EN32KHZ;
+	
+	if(reg_status == ds3231_status) return;
+	
+	if(HAL_I2C_WriteReg(DS3231_ADDR, DS3231_REG_STATUS, reg_status | DS3231_STAT_FLAGS) == HAL_I2C_ST_OK)
+	{
+		ds3231_status = reg_status;
+	}
+}
+
+/*
+ * Seconds to year registers (0x00-0x06). The century bit (bit 7 of the
+ * month register) is set for years from 2100 on.
+ */
+static void ds3231_encode_time(uint8_t* regs, const DS3231_Datetime_t* time)
+{
+	regs[0] = TO_BCD(time->sec);
+	regs[1] = TO_BCD(time->min);
+	regs[2] = TO_BCD(time->hour);
+	regs[3] = TO_BCD(time->day);
+	regs[4] = TO_BCD(time->date);
+	regs[5] = TO_BCD(time->month) | ((time->year >= 2100U) ? 0x80U : 0x00U);
+	regs[6] = TO_BCD(time->year % 100U);
+}
+
+static void ds3231_decode_time(const uint8_t* regs, DS3231_Datetime_t* time)
+{
+	time->sec   = TO_BIN(regs[0]);
+	time->min   = TO_BIN(regs[1]);
+	time->hour  = TO_BIN(regs[2]);
+	time->day   = regs[3];
+	time->date  = TO_BIN(regs[4]);
+	time->month = TO_BIN(regs[5] & 0x1FU);
+	time->year  = TO_BIN(regs[6]) + ((regs[5] & 0x80U) ? 2100U : 2000U);
+}
+
+/*
+ * Alarm registers: n = 4 for alarm 1 (seconds, minutes, hours, day/date),
+ * n = 3 for alarm 2 (no seconds). Bit i of mode is the mask bit AxM(i+1)
+ * (bit 7 of register i); bit n of mode selects day of week (DY/DT = 1,
+ * bit 6 of the last register) instead of day of month.
+ */
+static void ds3231_encode_alarm(uint8_t* regs, uint8_t n, const DS3231_Datetime_t* time, uint8_t mode)
+{
+	uint8_t i = 0;
+	
+	if(n == 4) regs[i++] = TO_BCD(time->sec);
+	regs[i++] = TO_BCD(time->min);
+	regs[i++] = TO_BCD(time->hour);
+	regs[i]   = (mode & (1U << n)) ? (TO_BCD(time->day) | 0x40U) : TO_BCD(time->date);
+	
+	for(i = 0; i < n; ++i)
+	{
+		if(mode & (1U << i)) regs[i] |= 0x80U;
+	}
+}
+
+/*
+ * Inverse of ds3231_encode_alarm; returns the match mode. The matched
+ * field of the last register goes to day or date, the other one is 0.
+ */
+static uint8_t ds3231_decode_alarm(const uint8_t* regs, uint8_t n, DS3231_Datetime_t* time)
+{
+	uint8_t mode = 0;
+	
+	time->sec   = (n == 4) ? TO_BIN(regs[0] & 0x7FU) : 0;
+	time->min   = TO_BIN(regs[n - 3] & 0x7FU);
+	time->hour  = TO_BIN(regs[n - 2] & 0x3FU);
+	time->day   = 0;
+	time->date  = 0;
+	time->month = 0;
+	time->year  = 0;
+	
+	if(regs[n - 1] & 0x40U)
+	{
+		time->day = TO_BIN(regs[n - 1] & 0x0FU);
+		mode |= (1U << n);
+	}
+	else
+	{
+		time->date = TO_BIN(regs[n - 1] & 0x3FU);
+	}
+	
+	for(uint8_t i = 0; i < n; ++i)
+	{
+		if(regs[i] & 0x80U) mode |= (1U << i);
+	}
 	
-	return (int8_t) raw_aging;
+	return mode;
 }
@@ -15,14 +15,21 @@
  *
  * Public API:
  *   void DS3231_Init(void);
- *     Initialize the DS3231. Configures the I2C bus at 400 kHz and
- *     clears the EOSC bit in the control register to ensure the
+ *     Initialize the DS3231. Configures the I2C bus at the fastest rate up
+ *     to 400 kHz (the DS3231 maximum) that F_CPU allows, primes the
+ *     driver's shadow copies of the control, status and aging registers
+ *     and clears the EOSC bit in the control register to ensure the
  *     oscillator is running.
  *
+ *   void DS3231_Resync(void);
+ *     Re-read the control, status and aging registers into the driver's
+ *     shadow copies. Call it when the chip may have been modified by
+ *     another I2C controller or lost power while the MCU kept running.
+ *
  *   void DS3231_SetTime(DS3231_Datetime_t *time);
  *     Write the date and time to the DS3231 timekeeping registers.
  *     The century bit (bit 7 of the month register) is set automatically
- *     when year >= 2100.
+ *     when year >= 2100; time is not modified.
  *
  *   void DS3231_GetTime(DS3231_Datetime_t *time);
  *     Read the current date and time from the DS3231 timekeeping registers
@@ -30,7 +37,8 @@
  *
  *   void DS3231_SetAlarm1(DS3231_Datetime_t *time, uint8_t mode);
  *     Configure and enable Alarm 1. The mode parameter selects one of the
- *     six alarm match conditions defined by DS3231_ALM1_* constants.
+ *     six alarm match conditions defined by DS3231_ALM1_* constants. Day
+ *     matches use time->day (day of week), date matches time->date.
  *
  *   void DS3231_DisableAlarm1(void);
  *     Disable Alarm 1 interrupt by clearing the A1IE bit in the control
@@ -42,7 +50,8 @@
  *
  *   void DS3231_SetAlarm2(DS3231_Datetime_t *time, uint8_t mode);
  *     Configure and enable Alarm 2. The mode parameter selects one of the
- *     five alarm match conditions defined by DS3231_ALM2_* constants.
+ *     five alarm match conditions defined by DS3231_ALM2_* constants. Day
+ *     and date matches work as for DS3231_SetAlarm1.
  *
  *   void DS3231_DisableAlarm2(void);
  *     Disable Alarm 2 interrupt by clearing the A2IE bit in the control
@@ -52,21 +61,53 @@
  *     Enable Alarm 2 interrupt by setting the A2IE bit in the control
  *     register.
  *
+ *   uint8_t DS3231_Configure(const DS3231_Config_t *cfg);
+ *     Write time, both alarms, control and status (registers 0x00-0x0F)
+ *     in one auto-incrementing I2C burst of 17 bytes, clearing the status
+ *     flags selected in cfg->clear. Replaces DS3231_SetTime, both
+ *     DS3231_SetAlarmN, the control and status updates and the flag
+ *     clear, each a transaction of its own. Returns the I2C status
+ *     (HAL_I2C_ST_*); the shadow registers are updated on success.
+ *
+ *   uint8_t DS3231_Snapshot(DS3231_Snapshot_t *snap);
+ *     Read all 19 registers (0x00-0x12) in one repeated-START burst and
+ *     decode them into snap. The shadow registers are refreshed as by
+ *     DS3231_Resync. Returns the I2C status; snap is untouched on error.
+ *
+ *   int16_t DS3231_GetTempQ2(void);
+ *     Read the internal temperature sensor. Returns the raw signed 10-bit
+ *     value in quarter degrees Celsius (e.g. 101 = 25.25 °C).
+ *
+ *   int16_t DS3231_GetTempCenti(void);
+ *     Read the internal temperature sensor. Returns the temperature in
+ *     hundredths of a degree Celsius (e.g. 2525 = 25.25 °C).
+ *
  *   float DS3231_GetTemp(void);
  *     Read the internal temperature sensor. Returns the temperature in
- *     degrees Celsius with 0.25 °C resolution.
+ *     degrees Celsius with 0.25 °C resolution. Only available when
+ *     DS3231_USE_FLOAT is non-zero.
+ *
+ *   uint8_t DS3231_StartTempConversion(void);
+ *     Start a temperature conversion by setting the CONV bit, without
+ *     waiting for it. Returns 1 if the conversion was started, or 0 if the
+ *     chip is busy with a conversion of its own (BSY set); retry later.
+ *
+ *   uint8_t DS3231_IsTempReady(void);
+ *     Return 1 once the conversion started by DS3231_StartTempConversion
+ *     has finished (CONV cleared by the chip), 0 while it is running.
  *
  *   void DS3231_SetSQWFreq(uint8_t freq);
  *     Set the square-wave output frequency using one of the DS3231_SQW_*
  *     constants (1 Hz, 1.024 kHz, 4.096 kHz, or 8.192 kHz).
  *
  *   void DS3231_EnableSQW(void);
- *     Enable the square-wave output on the INT/SQW pin by setting the
+ *     Enable the square-wave output on the INT/SQW pin by clearing the
  *     INTCN bit in the control register.
  *
  *   void DS3231_DisableSQW(void);
- *     Disable the square-wave output on the INT/SQW pin by clearing the
- *     INTCN bit in the control register.
+ *     Disable the square-wave output on the INT/SQW pin by setting the
+ *     INTCN bit in the control register. INT/SQW then acts as the alarm
+ *     interrupt output.
  *
  *   void DS3231_Enable32khz(void);
  *     Enable the 32 kHz output pin by setting the EN32KHZ bit in the
@@ -90,8 +131,8 @@
  *     the oscillator frequency.
  *
  *   int8_t DS3231_GetAging(void);
- *     Read and return the current aging offset register value as a
- *     signed 8-bit integer.
+ *     Return the current aging offset register value as a signed 8-bit
+ *     integer (served from the shadow copy, no I2C traffic).
  *
  * Public types:
  *   DS3231_Datetime_t
@@ -104,10 +145,43 @@
  *       uint8_t  month — month         (1–12)
  *       uint16_t year  — full year     (2000–2199)
  *
+ *   DS3231_Config_t
+ *     Register file 0x00-0x0F as written by DS3231_Configure:
+ *       DS3231_Datetime_t time        — current date and time
+ *       DS3231_Datetime_t alarm1      — alarm 1 sec, min, hour, day or date
+ *       uint8_t           alarm1_mode — DS3231_ALM1_* match mode
+ *       DS3231_Datetime_t alarm2      — alarm 2 min, hour, day or date
+ *       uint8_t           alarm2_mode — DS3231_ALM2_* match mode
+ *       uint8_t           control     — control register (DS3231_CTRL_*;
+ *                                       CONV is ignored)
+ *       uint8_t           status      — status register; only
+ *                                       DS3231_STAT_EN32KHZ is written
+ *       uint8_t           clear       — flags to clear (DS3231_STAT_A1F,
+ *                                       _A2F, _OSF); the others are kept
+ *
+ *   DS3231_Snapshot_t
+ *     Whole register file as read by DS3231_Snapshot:
+ *       DS3231_Config_t cfg     — registers 0x00-0x0F; cfg.status holds
+ *                                 the raw status register with its flags,
+ *                                 cfg.clear is 0, alarm fields that are
+ *                                 not matched read back as 0
+ *       int8_t          aging   — aging offset
+ *       int16_t         temp_q2 — temperature in quarter degrees Celsius
+ *
+ * Configuration (compile-time):
+ *   DS3231_USE_FLOAT        - 1 (default) provides the float
+ *                             DS3231_GetTemp(). Build with
+ *                             -DDS3231_USE_FLOAT=0 to keep floating point
+ *                             out of images that only use the integer API.
+ *
  * Public constants:
  *   Device address:
  *     DS3231_ADDR             - 7-bit I2C address (0x68)
  *
+ *   Burst sizes:
+ *     DS3231_CONFIG_REGS      - registers written by DS3231_Configure (16)
+ *     DS3231_SNAPSHOT_REGS    - registers read by DS3231_Snapshot (19)
+ *
  *   Register map:
  *     DS3231_REG_SECONDS      - Seconds register         (0x00)
  *     DS3231_REG_MINUTES      - Minutes register         (0x01)
@@ -186,8 +260,35 @@
  *       DS3231_Datetime_t alarm = {0, 0, 7, 0, 0, 0, 0};
  *       DS3231_SetAlarm1(&alarm, DS3231_ALM1_MTC_HR_MIN_SEC);
  *
- *   - Read the temperature:
- *       float temp = DS3231_GetTemp();
+ *   - Boot-time setup in a single transfer: set the clock, wake up every
+ *     day at 07:00:00 on alarm 1, INT/SQW as alarm output, clear OSF and
+ *     any pending alarm flags:
+ *       DS3231_Config_t cfg =
+ *       {
+ *           .time        = {0, 30, 14, 4, 26, 2, 2026},
+ *           .alarm1      = {0, 0, 7, 0, 0, 0, 0},
+ *           .alarm1_mode = DS3231_ALM1_MTC_HR_MIN_SEC,
+ *           .alarm2_mode = DS3231_ALM2_PER_MIN,
+ *           .control     = DS3231_CTRL_INTCN | DS3231_CTRL_A1IE,
+ *           .clear       = DS3231_STAT_A1F | DS3231_STAT_A2F | DS3231_STAT_OSF
+ *       };
+ *       DS3231_Configure(&cfg);
+ *
+ *   - Dump the whole chip state:
+ *       DS3231_Snapshot_t snap;
+ *       if(DS3231_Snapshot(&snap) == HAL_I2C_ST_OK) print_rtc(&snap);
+ *
+ *   - Read the temperature in quarter degrees:
+ *       int16_t temp_q2 = DS3231_GetTempQ2();
+ *
+ *   - Refresh the temperature without waiting for the 64 s automatic
+ *     conversion:
+ *       if(DS3231_StartTempConversion())
+ *       {
+ *           // ... do other work ...
+ *           while(!DS3231_IsTempReady());
+ *           int16_t temp_c100 = DS3231_GetTempCenti();
+ *       }
  *
  *   - Enable a 1 Hz square wave on the INT/SQW pin:
  *       DS3231_SetSQWFreq(DS3231_SQW_1HZ);
@@ -203,9 +304,24 @@
  *   - The EOSC bit is active-low: clearing it enables the oscillator.
  *   - Temperature resolution is 0.25 °C (10-bit signed value, two MSBs of
  *     the LSB register).
- *   - All operations are blocking. The underlying I2C HAL uses polling.
+ *   - All operations are blocking. Register reads use a single
+ *     repeated-START write-then-read transaction (HAL_I2C_ReadReg /
+ *     HAL_I2C_ReadRegs).
+ *   - The control, status (EN32KHZ) and aging registers are cached in
+ *     write-through shadow copies primed by DS3231_Init. Enable/Disable/
+ *     Set calls apply the change to the shadow and issue a single write,
+ *     or no I2C traffic at all when the value does not change. A shadow
+ *     is only updated when its write succeeds, so a failed call is retried
+ *     in full next time. Use DS3231_Resync() if the chip may have been
+ *     modified externally.
+ *   - DS3231_IsOSCStopped always reads the status register, because the
+ *     flag bits (A1F, A2F, BSY, OSF) are updated by the chip itself.
  *   - Alarm flag bits (A1F, A2F) in the status register must be cleared
  *     by the application after each alarm event.
+ *   - DS3231_Configure writes the seconds register, which restarts the
+ *     chip's one-second countdown: call it to set the clock, not to
+ *     change an alarm on a running clock.
+ *   - Hours are always written and decoded in 24-hour mode.
  *
  * Author: otavioacb
  * Created: 2026-02-26
@@ -217,6 +333,21 @@
  *
  * Change log:
  *   2026-02-26  v0.1  Initial header for DS3231 RTC driver
+ *   2026-10-14  v0.2  Ported register access onto repeated-START I2C helpers
+ *                     Fixed DS3231_DisableAlarm1 clearing every bit except A1IE
+ *   2026-10-14  v0.3  Added write-through shadow registers and DS3231_Resync
+ *   2026-10-14  v0.4  Fixed inverted INTCN handling in DS3231_EnableSQW / DS3231_DisableSQW
+ *                     Added the SQW-disciplined software clock (ds3231-clock.h)
+ *   2026-10-14  v0.5  Added fixed-point temperature API (DS3231_GetTempQ2, DS3231_GetTempCenti),
+ *                     DS3231_StartTempConversion / DS3231_IsTempReady and the DS3231_USE_FLOAT option
+ *   2026-10-14  v0.6  DS3231_Init requests HAL_I2C_FREQ_FAST, the fastest rate up to 400 kHz for any F_CPU
+ *   2026-10-14  v0.7  Added DS3231_Configure (0x00-0x0F in one burst) and DS3231_Snapshot
+ *                     (all 19 registers). Fixed the year register from 2056 on, the century
+ *                     bit leaking into the month on read and write, and date-match alarms
+ *                     using the day of week. SetAlarmN writes the alarm before enabling it
+ *   2026-10-14  v0.8  DS3231_SetAlarm1 / DS3231_SetAlarm2 now encode through the DS3231_Configure
+ *                     alarm helper: registers written before the enable, date matches use time->date
+ *                     Shadow registers are no longer updated when their I2C write fails
  *
  */
 
@@ -226,8 +357,15 @@
 #include <stdint.h>
 #include "i2c-hal.h"
 
+#ifndef DS3231_USE_FLOAT
+	#define DS3231_USE_FLOAT 1
+#endif
+
 #define DS3231_ADDR             0x68 
 
+#define DS3231_CONFIG_REGS      16U
+#define DS3231_SNAPSHOT_REGS    19U
+
 #define DS3231_REG_SECONDS      0x00
 #define DS3231_REG_MINUTES      0x01
 #define DS3231_REG_HOURS        0x02
@@ -292,7 +430,27 @@ typedef struct
 	uint16_t year;
 } DS3231_Datetime_t;
 
+typedef struct
+{
+	DS3231_Datetime_t time;
+	DS3231_Datetime_t alarm1;
+	uint8_t alarm1_mode;
+	DS3231_Datetime_t alarm2;
+	uint8_t alarm2_mode;
+	uint8_t control;
+	uint8_t status;
+	uint8_t clear;
+} DS3231_Config_t;
+
+typedef struct
+{
+	DS3231_Config_t cfg;
+	int8_t aging;
+	int16_t temp_q2;
+} DS3231_Snapshot_t;
+
 void DS3231_Init(void);
+void DS3231_Resync(void);
 
 void DS3231_SetTime(DS3231_Datetime_t* time);
 void DS3231_GetTime(DS3231_Datetime_t* time);
@@ -305,7 +463,18 @@ void DS3231_SetAlarm2(DS3231_Datetime_t* time, uint8_t mode);
 void DS3231_DisableAlarm2(void);
 void DS3231_EnableAlarm2(void);
 
+uint8_t DS3231_Configure(const DS3231_Config_t* cfg);
+uint8_t DS3231_Snapshot(DS3231_Snapshot_t* snap);
+
+int16_t DS3231_GetTempQ2(void);
+int16_t DS3231_GetTempCenti(void);
+
+#if DS3231_USE_FLOAT
 float DS3231_GetTemp();
+#endif
+
+uint8_t DS3231_StartTempConversion(void);
+uint8_t DS3231_IsTempReady(void);
 
 void DS3231_SetSQWFreq(uint8_t freq);
 void DS3231_EnableSQW(void);
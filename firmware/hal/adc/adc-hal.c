@@ -23,12 +23,24 @@
  *   - void HAL_ADC_SetChannel(unsigned char ch);
  *       Select ADC input channel.
  *
+ *   - void HAL_ADC_SetMux(unsigned char ref, unsigned char ch);
+ *       Write reference and input channel in a single ADMUX write, keeping
+ *       the data adjustment. Does not wait for a running conversion, so it
+ *       can be used from the ADC interrupt to prepare the next conversion.
+ *
  *   - void HAL_ADC_SetPrescaler(unsigned char pre);
  *       Set ADC clock prescaler to control ADC conversion speed.
  *
  *   - void HAL_ADC_EnableInterrupt();
  *       Enable ADC conversion complete interrupt.
  *
+ *   - void HAL_ADC_DisableInterrupt();
+ *       Disable ADC conversion complete interrupt.
+ *
+ *   - void HAL_ADC_SetCallback(void (*callback)(uint16_t value));
+ *       Register the function called from the ADC interrupt with each
+ *       conversion result (NULL to remove it).
+ *
  *   - void HAL_ADC_StartConversion();
  *       Start a single ADC conversion.
  *
@@ -38,6 +50,9 @@
  *   - void HAL_ADC_StartAutoTrigger(unsigned char src);
  *       Enable auto-triggering and select the trigger source.
  *
+ *   - void HAL_ADC_StopAutoTrigger();
+ *       Disable auto-triggering. A conversion in progress still completes.
+ *
  *   - void HAL_ADC_DisableChannel(unsigned char ch);
  *       Disable a specific ADC channel (platform-specific behavior).
  *
@@ -63,6 +78,8 @@
  *   HAL_ADC_RIGHT      - right adjust result
  *
  *   HAL_ADC_CH_XX      - channel selection constants (CH00..CH07, TEMP)
+ *   HAL_ADC_VBG        - internal 1.1 V bandgap as input
+ *   HAL_ADC_GND        - GND as input
  *
  *   HAL_ADC_DF_*       - prescaler/divisor constants (DF2..DF128)
  *
@@ -78,8 +95,14 @@
  *       HAL_ADC_Enable();
  *       HAL_ADC_SetChannel(HAL_ADC_CH00);
  *       HAL_ADC_StartConversion();
- *       while (HAL_ADC_isRunning()) {  }
+ *       while (HAL_ADC_isRunning()) { wait  }
  *       uint16_t v = HAL_ADC_Read();
+ *   - Interrupt-driven sequence:
+ *       HAL_ADC_SetCallback(on_sample);
+ *       HAL_ADC_EnableInterrupt();
+ *       HAL_ADC_StartAutoTrigger(HAL_ADC_TRSC_FREE);
+ *       HAL_ADC_StartConversion();
+ *       sei();
  *
  * Notes:
  *   - This header uses <avr/io.h> types and register definitions. Platform-
@@ -89,6 +112,8 @@
  *   - The enable/disable channel functions are provided for boards that
  *     require explicit channel gating; on many AVR devices channel selection
  *     is done only by writing the MUX bits.
+ *   - adc-hal.c owns ADC_vect; the application must not define it. The
+ *     interrupt reads the result and passes it to the registered callback.
  *
  * Author: otavioacb
  * Created: 2025-11-09
@@ -100,10 +125,23 @@
  *
  * Change log:
  *   2025-11-09  v0.1  Initial header for ADC HAL
+ *   2026-10-14  v0.2  Added ADC_vect dispatch (HAL_ADC_SetCallback), HAL_ADC_DisableInterrupt
+ *                     and HAL_ADC_StopAutoTrigger
+ *   2026-10-14  v0.3  Added HAL_ADC_SetMux and the HAL_ADC_VBG / HAL_ADC_GND inputs
+ *   2026-10-14  v0.4  Power management hooks (power-hal.h): conversions hold ADC
+ *                     noise reduction
+ *   2026-10-14  v0.5  Cycle trace hook (trace-hal.h) in ADC_vect
  *
  */
 #include "adc-hal.h"
 
+#include <avr/interrupt.h>
+
+#include "power-hal.h"
+#include "trace-hal.h"
+
+static void (*volatile adc_callback)(uint16_t value) = NULL;
+
 void HAL_ADC_SetReference(unsigned char ref)
 {
 	while(HAL_ADC_isRunning());
@@ -125,6 +163,11 @@ void HAL_ADC_SetChannel(unsigned char ch)
 	ADMUX = (ADMUX & ~HAL_ADC_CH_MASK) | ch;
 }
 
+void HAL_ADC_SetMux(unsigned char ref, unsigned char ch)
+{
+	ADMUX = (ADMUX & HAL_ADC_LEFT) | (ref & HAL_ADC_REF_MASK) | (ch & HAL_ADC_CH_MASK);
+}
+
 void HAL_ADC_SetPrescaler(unsigned char pre)
 {
 	ADCSRA = (ADCSRA & ~HAL_ADC_DF_MASK) | pre;	
@@ -135,23 +178,43 @@ void HAL_ADC_EnableInterrupt()
 	ADCSRA |= (1 << ADIE);
 }
 
+void HAL_ADC_DisableInterrupt()
+{
+	ADCSRA &= ~(1 << ADIE);
+}
+
+void HAL_ADC_SetCallback(void (*callback)(uint16_t value))
+{
+	adc_callback = callback;
+}
+
 
 void HAL_ADC_StartConversion()
 {
+	HAL_PWR_HOLD(HAL_PWR_ID_ADC, HAL_PWR_ADC_NR);
 	ADCSRA |= (1 << ADSC);
 }
 
 void HAL_ADC_Enable()
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_ADC);
 	ADCSRA |= (1 << ADEN);
 }
 
 void HAL_ADC_StartAutoTrigger(unsigned char src)
 {	
+	/* Free running needs only the ADC; the other triggers need the I/O clock */
+	HAL_PWR_HOLD(HAL_PWR_ID_ADC, (src == 0) ? HAL_PWR_ADC_NR : HAL_PWR_IDLE);
 	ADCSRA |= (1 << ADATE);
 	ADCSRB  = (ADCSRB & ~HAL_ADC_TRSC_MASK) | src;	
 }
 
+void HAL_ADC_StopAutoTrigger()
+{
+	ADCSRA &= ~(1 << ADATE);
+	HAL_PWR_DROP(HAL_PWR_ID_ADC);
+}
+
 void HAL_ADC_DisableChannel(unsigned char ch)
 {
 	DIDR0 |= (1 << ch);
@@ -177,6 +240,22 @@ uint16_t HAL_ADC_Read()
 	uint8_t low  = ADCL;
 	uint8_t high = ADCH;
 	
+	/* A single conversion is over once its result is read */
+	if(!(ADCSRA & (1 << ADATE))) HAL_PWR_DROP(HAL_PWR_ID_ADC);
+	
 	if (ADMUX & (1 << ADLAR)) return ((uint16_t)high << 2) | (low >> 6);
 	else return ((uint16_t)high << 8) | low;
 }
+
+ISR(ADC_vect)
+{
+	void (*callback)(uint16_t value) = adc_callback;
+	uint16_t value;
+	
+	HAL_TRACE_ENTER(HAL_TRACE_ID_ADC);
+	
+	value = HAL_ADC_Read();
+	if(callback) callback(value);
+	
+	HAL_TRACE_EXIT(HAL_TRACE_ID_ADC);
+}
@@ -23,12 +23,24 @@
  *   - void HAL_ADC_SetChannel(unsigned char ch);
  *       Select ADC input channel.
  *
+ *   - void HAL_ADC_SetMux(unsigned char ref, unsigned char ch);
+ *       Write reference and input channel in a single ADMUX write, keeping
+ *       the data adjustment. Does not wait for a running conversion, so it
+ *       can be used from the ADC interrupt to prepare the next conversion.
+ *
  *   - void HAL_ADC_SetPrescaler(unsigned char pre);
  *       Set ADC clock prescaler to control ADC conversion speed.
  *
  *   - void HAL_ADC_EnableInterrupt();
  *       Enable ADC conversion complete interrupt.
  *
+ *   - void HAL_ADC_DisableInterrupt();
+ *       Disable ADC conversion complete interrupt.
+ *
+ *   - void HAL_ADC_SetCallback(void (*callback)(uint16_t value));
+ *       Register the function called from the ADC interrupt with each
+ *       conversion result (NULL to remove it).
+ *
  *   - void HAL_ADC_StartConversion();
  *       Start a single ADC conversion.
  *
@@ -38,6 +50,9 @@
  *   - void HAL_ADC_StartAutoTrigger(unsigned char src);
  *       Enable auto-triggering and select the trigger source.
  *
+ *   - void HAL_ADC_StopAutoTrigger();
+ *       Disable auto-triggering. A conversion in progress still completes.
+ *
  *   - void HAL_ADC_DisableChannel(unsigned char ch);
  *       Disable a specific ADC channel (platform-specific behavior).
  *
@@ -63,6 +78,8 @@
  *   HAL_ADC_RIGHT      - right adjust result
  *
  *   HAL_ADC_CH_XX      - channel selection constants (CH00..CH07, TEMP)
+ *   HAL_ADC_VBG        - internal 1.1 V bandgap as input
+ *   HAL_ADC_GND        - GND as input
  *
  *   HAL_ADC_DF_*       - prescaler/divisor constants (DF2..DF128)
  *
@@ -80,6 +97,12 @@
  *       HAL_ADC_StartConversion();
  *       while (HAL_ADC_isRunning()) { wait  }
  *       uint16_t v = HAL_ADC_Read();
+ *   - Interrupt-driven sequence:
+ *       HAL_ADC_SetCallback(on_sample);
+ *       HAL_ADC_EnableInterrupt();
+ *       HAL_ADC_StartAutoTrigger(HAL_ADC_TRSC_FREE);
+ *       HAL_ADC_StartConversion();
+ *       sei();
  *
  * Notes:
  *   - This header uses <avr/io.h> types and register definitions. Platform-
@@ -89,6 +112,8 @@
  *   - The enable/disable channel functions are provided for boards that
  *     require explicit channel gating; on many AVR devices channel selection
  *     is done only by writing the MUX bits.
+ *   - adc-hal.c owns ADC_vect; the application must not define it. The
+ *     interrupt reads the result and passes it to the registered callback.
  *
  * Author: otavioacb
  * Created: 2025-11-09
@@ -100,6 +125,12 @@
  *
  * Change log:
  *   2025-11-09  v0.1  Initial header for ADC HAL
+ *   2026-10-14  v0.2  Added ADC_vect dispatch (HAL_ADC_SetCallback), HAL_ADC_DisableInterrupt
+ *                     and HAL_ADC_StopAutoTrigger
+ *   2026-10-14  v0.3  Added HAL_ADC_SetMux and the HAL_ADC_VBG / HAL_ADC_GND inputs
+ *   2026-10-14  v0.4  Power management hooks (power-hal.h): conversions hold ADC
+ *                     noise reduction
+ *   2026-10-14  v0.5  Cycle trace hook (trace-hal.h) in ADC_vect
  *
  */
 
@@ -107,6 +138,8 @@
 #define ADC_HAL_H
 
 #include <avr/io.h>
+#include <stdint.h>
+#include <stddef.h>
 
 #define HAL_ADC_REF_MASK 0xC0
 #define HAL_ADC_AREF  0x00
@@ -126,6 +159,8 @@
 #define HAL_ADC_CH06  0x06
 #define HAL_ADC_CH07  0x07
 #define HAL_ADC_TEMP  0x08
+#define HAL_ADC_VBG   0x0E
+#define HAL_ADC_GND   0x0F
 
 #define HAL_ADC_DF_MASK 0x07
 #define HAL_ADC_DF2    0x01
@@ -149,12 +184,16 @@
 void HAL_ADC_SetReference(unsigned char ref);
 void HAL_ADC_SetAdjustment(unsigned char adj);
 void HAL_ADC_SetChannel(unsigned char ch);
+void HAL_ADC_SetMux(unsigned char ref, unsigned char ch);
 void HAL_ADC_SetPrescaler(unsigned char pre);
 
 void HAL_ADC_EnableInterrupt();
+void HAL_ADC_DisableInterrupt();
+void HAL_ADC_SetCallback(void (*callback)(uint16_t value));
 void HAL_ADC_StartConversion();
 void HAL_ADC_Enable();
 void HAL_ADC_StartAutoTrigger(unsigned char src);
+void HAL_ADC_StopAutoTrigger();
 void HAL_ADC_DisableChannel(unsigned char ch);
 void HAL_ADC_EnableChannel(unsigned char ch);
 
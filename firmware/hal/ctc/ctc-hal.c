@@ -18,8 +18,27 @@
  *       Initialize the timer for CTC mode with the specified timer source, 
  *       channel, compare mode, and clock selection prescaler.
  *
- *   - void HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp);
- *       Sets the compare value for the given timer and channel.
+ *   - uint8_t HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp);
+ *       Sets the compare value for the given timer and channel. Timers 0
+ *       and 2 are 8-bit: a larger cmp is clamped to 0xFF and 0 is returned
+ *       (1 otherwise).
+ *
+ *   - uint32_t HAL_CTC_SetFrequency(uint8_t src, uint8_t ch, uint32_t hz);
+ *       Select the prescaler and compare value giving compare matches
+ *       closest to hz from F_CPU, searching every prescaler of the timer,
+ *       and program them (OCRnA is TOP in CTC mode; for HAL_CTC_CH_B OCRnB
+ *       gets the same value). Call it after HAL_CTC_Init, whose clock
+ *       selection it replaces. Returns the achieved match rate in Hz
+ *       (rounded), 0 if hz cannot be generated. A toggled OCnx pin runs
+ *       at half that rate.
+ *
+ *   - void HAL_CTC_EnableInterrupt(uint8_t src, uint8_t ch);
+ *       Enable the compare-match interrupt of the given timer and channel
+ *       (TIMERn_COMPA_vect / TIMERn_COMPB_vect). The ISR is provided by the
+ *       application or by the module that owns the timer.
+ *
+ *   - void HAL_CTC_DisableInterrupt(uint8_t src, uint8_t ch);
+ *       Disable the compare-match interrupt of the given timer and channel.
  *
  *   - void HAL_CTC_ConfigCH0(uint8_t ch, uint8_t mode, uint8_t clk);
  *       Configures Timer/Counter 0 with the specified channel, compare mode, 
@@ -33,6 +52,20 @@
  *       Configures Timer/Counter 2 with the specified channel, compare mode, 
  *       and clock prescaler.
  *
+ * Compile-time solver (F_CPU must be defined, hz a constant expression):
+ *   - HAL_CTC_CH0_CK(hz),  HAL_CTC_CH1_CK(hz),  HAL_CTC_CH2_CK(hz)
+ *   - HAL_CTC_CH0_OCR(hz), HAL_CTC_CH1_OCR(hz), HAL_CTC_CH2_OCR(hz)
+ *       Clock selection and compare value for hz compare matches per
+ *       second, using the smallest prescaler whose compare value fits the
+ *       timer (the finest resolution; HAL_CTC_SetFrequency also tries the
+ *       other prescalers). Both fold to constants, suitable for #if and
+ *       for HAL_CTC_Init / HAL_CTC_SetValue. _CK is 0 when hz is out of
+ *       range.
+ *   - HAL_CTC_CH0_DIV(hz), HAL_CTC_CH1_DIV(hz), HAL_CTC_CH2_DIV(hz)
+ *       The prescaler division chosen by _CK (0 when out of range).
+ *   - HAL_CTC_HZ(div, ocr)
+ *       Compare-match rate of a prescaler division and compare value.
+ *
  * Notes:
  *   - This header uses <avr/io.h> types and register definitions. Platform-
  *     specific implementations may be required for non-AVR targets.
@@ -42,6 +75,9 @@
  *     interrupts used in the application.
  *   - All setup and configuration functions must be called while the timer is 
  *     stopped, and values must be set appropriately to prevent undefined behavior.
+ *   - The OCnx pin is only configured as output when a compare output mode is
+ *     requested (mode != 0). Pass mode = 0 to use a timer purely as a time base
+ *     (compare-match interrupt) without driving its pin.
  *
  * Example usage:
  *   - Include this header in application code:
@@ -49,6 +85,12 @@
  *   - Initialize a timer and its channel:
  *       HAL_CTC_Init(HAL_CTC_SRC_1, HAL_CTC_CH_A, HAL_CTCA_COMP_MODE_TOGGLE, HAL_CTC_CH1_CK_64);
  *       HAL_CTC_SetValue(HAL_CTC_SRC_1, HAL_CTC_CH_A, 25000);
+ *   - 44.1 kHz on Timer1, solved at run time:
+ *       HAL_CTC_Init(HAL_CTC_SRC_1, HAL_CTC_CH_A, 0, HAL_CTC_CH1_CK_1);
+ *       achieved = HAL_CTC_SetFrequency(HAL_CTC_SRC_1, HAL_CTC_CH_A, 44100UL);
+ *   - 1 kHz on Timer0, solved at compile time:
+ *       HAL_CTC_Init(HAL_CTC_SRC_0, HAL_CTC_CH_A, 0, HAL_CTC_CH0_CK(1000UL));
+ *       HAL_CTC_SetValue(HAL_CTC_SRC_0, HAL_CTC_CH_A, HAL_CTC_CH0_OCR(1000UL));
  *
  * Author: otavioacb
  * Created: 2025-12-21
@@ -60,9 +102,23 @@
  *
  * Change log:
  *   2025-12-21  v0.1  Initial header for uc-Microlab CTC HAL
+ *   2026-10-14  v0.2  Added HAL_CTC_EnableInterrupt / HAL_CTC_DisableInterrupt
+ *                     OCnx pins are left untouched when mode = 0
+ *   2026-10-14  v0.3  Added HAL_CTC_SetFrequency and the compile-time solver
+ *                     macros; HAL_CTC_SetValue clamps 8-bit compare values
+ *                     instead of truncating them and reports it
+ *   2026-10-14  v0.4  Config functions re-enable the timer clock in PRR (power-hal.h)
  *
  */
 #include "ctc-hal.h"
+#include "power-hal.h"
+
+#ifndef F_CPU
+	#define F_CPU 16000000UL
+#endif
+
+static const uint16_t ctc_div01[5] = {1, 8, 64, 256, 1024};
+static const uint16_t ctc_div2[7]  = {1, 8, 32, 64, 128, 256, 1024};
 
 void HAL_CTC_Init(uint8_t src, uint8_t ch, uint8_t mode, uint8_t clk)
 {
@@ -84,21 +140,136 @@ void HAL_CTC_Init(uint8_t src, uint8_t ch, uint8_t mode, uint8_t clk)
 	
 }
 
-void HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp)
+uint8_t HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp)
 {
+	uint8_t exact = 1;
+	
+	if(src != HAL_CTC_SRC_1 && cmp > 0xFF)
+	{
+		cmp = 0xFF;
+		exact = 0;
+	}
+	
 	switch(src)
 	{
 		case HAL_CTC_SRC_0:
-			if(ch == HAL_CTC_CH_A) OCR0A = (uint8_t) (0xFF & cmp);
-			if(ch == HAL_CTC_CH_B) OCR0B = (uint8_t) (0xFF & cmp);
+			if(ch == HAL_CTC_CH_A) OCR0A = (uint8_t) cmp;
+			if(ch == HAL_CTC_CH_B) OCR0B = (uint8_t) cmp;
 			break;
 		case HAL_CTC_SRC_1:
 			if(ch == HAL_CTC_CH_A) OCR1A = cmp;
 			if(ch == HAL_CTC_CH_B) OCR1B = cmp;
 			break;
 		case HAL_CTC_SRC_2:
-			if(ch == HAL_CTC_CH_A) OCR2A = (uint8_t) (0xFF & cmp);
-			if(ch == HAL_CTC_CH_B) OCR2B = (uint8_t) (0xFF & cmp);
+			if(ch == HAL_CTC_CH_A) OCR2A = (uint8_t) cmp;
+			if(ch == HAL_CTC_CH_B) OCR2B = (uint8_t) cmp;
+			break;
+		default:
+			break;
+	}
+	
+	return exact;
+}
+
+uint32_t HAL_CTC_SetFrequency(uint8_t src, uint8_t ch, uint32_t hz)
+{
+	const uint16_t* div = (src == HAL_CTC_SRC_2) ? ctc_div2 : ctc_div01;
+	const uint8_t n = (src == HAL_CTC_SRC_2) ? 7 : 5;
+	const uint32_t max = (src == HAL_CTC_SRC_1) ? 65536UL : 256UL;
+	uint8_t best = 0xFF;
+	uint32_t best_counts = 0;
+	uint32_t best_err = 0;
+	
+	if(src > HAL_CTC_SRC_2 || hz == 0) return 0;
+	
+	/*
+	 * For each prescaler d the nearest count c gives F_CPU / (d * c). Its
+	 * error is |F_CPU - hz * d * c| / (d * c); compare candidates by cross-
+	 * multiplying. On a tie the smaller prescaler (finer step) wins.
+	 */
+	for(uint8_t i = 0; i < n; ++i)
+	{
+		uint32_t step;
+		uint32_t counts;
+		uint32_t err;
+		
+		/* Larger prescalers only get further from hz */
+		if(hz > F_CPU / div[i]) break;
+		
+		step = (uint32_t) div[i] * hz;
+		counts = (F_CPU + step / 2U) / step;
+		
+		if(counts > max) continue;
+		
+		err = (F_CPU > step * counts) ? (F_CPU - step * counts) : (step * counts - F_CPU);
+		
+		if(best == 0xFF ||
+		   (uint64_t) err * ((uint32_t) div[best] * best_counts) < (uint64_t) best_err * ((uint32_t) div[i] * counts))
+		{
+			best = i;
+			best_counts = counts;
+			best_err = err;
+		}
+	}
+	
+	if(best == 0xFF) return 0;
+	
+	switch(src)
+	{
+		case HAL_CTC_SRC_0:
+			TCCR0B = (TCCR0B & ~0x07) | (best + 1U);
+			break;
+		case HAL_CTC_SRC_1:
+			TCCR1B = (TCCR1B & ~0x07) | (best + 1U);
+			break;
+		default:
+			TCCR2B = (TCCR2B & ~0x07) | (best + 1U);
+			break;
+	}
+	
+	HAL_CTC_SetValue(src, HAL_CTC_CH_A, (uint16_t) (best_counts - 1U));
+	if(ch == HAL_CTC_CH_B) HAL_CTC_SetValue(src, HAL_CTC_CH_B, (uint16_t) (best_counts - 1U));
+	
+	return (F_CPU + (uint32_t) div[best] * best_counts / 2U) / ((uint32_t) div[best] * best_counts);
+}
+
+void HAL_CTC_EnableInterrupt(uint8_t src, uint8_t ch)
+{
+	uint8_t bit = (ch == HAL_CTC_CH_A) ? 1 : 2; /* OCIEnA = 1, OCIEnB = 2 */
+	
+	switch(src)
+	{
+		case HAL_CTC_SRC_0:
+			TIFR0  = (1 << bit);
+			TIMSK0 |= (1 << bit);
+			break;
+		case HAL_CTC_SRC_1:
+			TIFR1  = (1 << bit);
+			TIMSK1 |= (1 << bit);
+			break;
+		case HAL_CTC_SRC_2:
+			TIFR2  = (1 << bit);
+			TIMSK2 |= (1 << bit);
+			break;
+		default:
+			break;
+	}
+}
+
+void HAL_CTC_DisableInterrupt(uint8_t src, uint8_t ch)
+{
+	uint8_t bit = (ch == HAL_CTC_CH_A) ? 1 : 2;
+	
+	switch(src)
+	{
+		case HAL_CTC_SRC_0:
+			TIMSK0 &= ~(1 << bit);
+			break;
+		case HAL_CTC_SRC_1:
+			TIMSK1 &= ~(1 << bit);
+			break;
+		case HAL_CTC_SRC_2:
+			TIMSK2 &= ~(1 << bit);
 			break;
 		default:
 			break;
@@ -107,6 +278,8 @@ void HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp)
 
 void HAL_CTC_ConfigCH0(uint8_t ch, uint8_t mode, uint8_t clk)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER0);
+	
 	TCCR0A = 0;
 	TCCR0B = 0;
 	
@@ -114,12 +287,16 @@ void HAL_CTC_ConfigCH0(uint8_t ch, uint8_t mode, uint8_t clk)
 	TCCR0A |= mode;
 	TCCR0B |= clk;	
 	
+	if(mode == 0) return;
+	
 	if(ch == HAL_CTC_CH_A) DDRD   |= (1 << PD6);
 	if(ch == HAL_CTC_CH_B) DDRD   |= (1 << PD5);
 }
 
 void HAL_CTC_ConfigCH1(uint8_t ch, uint8_t mode, uint8_t clk)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER1);
+	
 	TCCR1A = 0;
 	TCCR1B = 0;
 	
@@ -127,12 +304,16 @@ void HAL_CTC_ConfigCH1(uint8_t ch, uint8_t mode, uint8_t clk)
 	TCCR1B |= (1 << WGM12);
 	TCCR1B |= clk;
 	
+	if(mode == 0) return;
+	
 	if(ch == HAL_CTC_CH_A) DDRB   |= (1 << PB1);
 	if(ch == HAL_CTC_CH_B) DDRB   |= (1 << PB2);
 }
 
 void HAL_CTC_ConfigCH2(uint8_t ch, uint8_t mode, uint8_t clk)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER2);
+	
 	TCCR2A = 0;
 	TCCR2B = 0;
 	
@@ -140,6 +321,8 @@ void HAL_CTC_ConfigCH2(uint8_t ch, uint8_t mode, uint8_t clk)
 	TCCR2A |= mode;
 	TCCR2B |= clk;
 	
+	if(mode == 0) return;
+	
 	if(ch == HAL_CTC_CH_A) DDRB   |= (1 << PB3);	
 	if(ch == HAL_CTC_CH_B) DDRD   |= (1 << PD3);
 }
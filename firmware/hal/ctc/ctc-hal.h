@@ -18,8 +18,27 @@
  *       Initialize the timer for CTC mode with the specified timer source, 
  *       channel, compare mode, and clock selection prescaler.
  *
- *   - void HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp);
- *       Sets the compare value for the given timer and channel.
+ *   - uint8_t HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp);
+ *       Sets the compare value for the given timer and channel. Timers 0
+ *       and 2 are 8-bit: a larger cmp is clamped to 0xFF and 0 is returned
+ *       (1 otherwise).
+ *
+ *   - uint32_t HAL_CTC_SetFrequency(uint8_t src, uint8_t ch, uint32_t hz);
+ *       Select the prescaler and compare value giving compare matches
+ *       closest to hz from F_CPU, searching every prescaler of the timer,
+ *       and program them (OCRnA is TOP in CTC mode; for HAL_CTC_CH_B OCRnB
+ *       gets the same value). Call it after HAL_CTC_Init, whose clock
+ *       selection it replaces. Returns the achieved match rate in Hz
+ *       (rounded), 0 if hz cannot be generated. A toggled OCnx pin runs
+ *       at half that rate.
+ *
+ *   - void HAL_CTC_EnableInterrupt(uint8_t src, uint8_t ch);
+ *       Enable the compare-match interrupt of the given timer and channel
+ *       (TIMERn_COMPA_vect / TIMERn_COMPB_vect). The ISR is provided by the
+ *       application or by the module that owns the timer.
+ *
+ *   - void HAL_CTC_DisableInterrupt(uint8_t src, uint8_t ch);
+ *       Disable the compare-match interrupt of the given timer and channel.
  *
  *   - void HAL_CTC_ConfigCH0(uint8_t ch, uint8_t mode, uint8_t clk);
  *       Configures Timer/Counter 0 with the specified channel, compare mode, 
@@ -33,6 +52,20 @@
  *       Configures Timer/Counter 2 with the specified channel, compare mode, 
  *       and clock prescaler.
  *
+ * Compile-time solver (F_CPU must be defined, hz a constant expression):
+ *   - HAL_CTC_CH0_CK(hz),  HAL_CTC_CH1_CK(hz),  HAL_CTC_CH2_CK(hz)
+ *   - HAL_CTC_CH0_OCR(hz), HAL_CTC_CH1_OCR(hz), HAL_CTC_CH2_OCR(hz)
+ *       Clock selection and compare value for hz compare matches per
+ *       second, using the smallest prescaler whose compare value fits the
+ *       timer (the finest resolution; HAL_CTC_SetFrequency also tries the
+ *       other prescalers). Both fold to constants, suitable for #if and
+ *       for HAL_CTC_Init / HAL_CTC_SetValue. _CK is 0 when hz is out of
+ *       range.
+ *   - HAL_CTC_CH0_DIV(hz), HAL_CTC_CH1_DIV(hz), HAL_CTC_CH2_DIV(hz)
+ *       The prescaler division chosen by _CK (0 when out of range).
+ *   - HAL_CTC_HZ(div, ocr)
+ *       Compare-match rate of a prescaler division and compare value.
+ *
  * Notes:
  *   - This header uses <avr/io.h> types and register definitions. Platform-
  *     specific implementations may be required for non-AVR targets.
@@ -42,6 +75,9 @@
  *     interrupts used in the application.
  *   - All setup and configuration functions must be called while the timer is 
  *     stopped, and values must be set appropriately to prevent undefined behavior.
+ *   - The OCnx pin is only configured as output when a compare output mode is
+ *     requested (mode != 0). Pass mode = 0 to use a timer purely as a time base
+ *     (compare-match interrupt) without driving its pin.
  *
  * Example usage:
  *   - Include this header in application code:
@@ -49,6 +85,12 @@
  *   - Initialize a timer and its channel:
  *       HAL_CTC_Init(HAL_CTC_SRC_1, HAL_CTC_CH_A, HAL_CTCA_COMP_MODE_TOGGLE, HAL_CTC_CH1_CK_64);
  *       HAL_CTC_SetValue(HAL_CTC_SRC_1, HAL_CTC_CH_A, 25000);
+ *   - 44.1 kHz on Timer1, solved at run time:
+ *       HAL_CTC_Init(HAL_CTC_SRC_1, HAL_CTC_CH_A, 0, HAL_CTC_CH1_CK_1);
+ *       achieved = HAL_CTC_SetFrequency(HAL_CTC_SRC_1, HAL_CTC_CH_A, 44100UL);
+ *   - 1 kHz on Timer0, solved at compile time:
+ *       HAL_CTC_Init(HAL_CTC_SRC_0, HAL_CTC_CH_A, 0, HAL_CTC_CH0_CK(1000UL));
+ *       HAL_CTC_SetValue(HAL_CTC_SRC_0, HAL_CTC_CH_A, HAL_CTC_CH0_OCR(1000UL));
  *
  * Author: otavioacb
  * Created: 2025-12-21
@@ -60,12 +102,19 @@
  *
  * Change log:
  *   2025-12-21  v0.1  Initial header for uc-Microlab CTC HAL
+ *   2026-10-14  v0.2  Added HAL_CTC_EnableInterrupt / HAL_CTC_DisableInterrupt
+ *                     OCnx pins are left untouched when mode = 0
+ *   2026-10-14  v0.3  Added HAL_CTC_SetFrequency and the compile-time solver
+ *                     macros; HAL_CTC_SetValue clamps 8-bit compare values
+ *                     instead of truncating them and reports it
+ *   2026-10-14  v0.4  Config functions re-enable the timer clock in PRR (power-hal.h)
  *
  */
 #ifndef CTC_HAL_H_
 #define CTC_HAL_H_
 
 #include <avr/io.h>
+#include <stdint.h>
 
 #define HAL_CTC_CH_A              0x00
 #define HAL_CTC_CH_B              0x01
@@ -106,9 +155,48 @@
 #define HAL_CTC_CH2_CK_256        0x06
 #define HAL_CTC_CH2_CK_1024       0x07
 
+/* Compare value giving hz matches per second with prescaler div (rounded) */
+#define HAL_CTC_OCR_FOR(hz, div)  (((F_CPU) + (div) * (hz) / 2UL) / ((div) * (hz)) - 1UL)
+#define HAL_CTC_FITS(hz, div, max) (HAL_CTC_OCR_FOR(hz, div) <= (max))
+#define HAL_CTC_HZ(div, ocr)      ((F_CPU) / ((div) * ((ocr) + 1UL)))
+
+#define HAL_CTC_CH0_DIV(hz) \
+	(HAL_CTC_FITS(hz, 1UL, 255UL)    ? 1UL    : HAL_CTC_FITS(hz, 8UL, 255UL)    ? 8UL   : \
+	 HAL_CTC_FITS(hz, 64UL, 255UL)   ? 64UL   : HAL_CTC_FITS(hz, 256UL, 255UL)  ? 256UL : \
+	 HAL_CTC_FITS(hz, 1024UL, 255UL) ? 1024UL : 0UL)
+
+#define HAL_CTC_CH1_DIV(hz) \
+	(HAL_CTC_FITS(hz, 1UL, 65535UL)    ? 1UL    : HAL_CTC_FITS(hz, 8UL, 65535UL)   ? 8UL   : \
+	 HAL_CTC_FITS(hz, 64UL, 65535UL)   ? 64UL   : HAL_CTC_FITS(hz, 256UL, 65535UL) ? 256UL : \
+	 HAL_CTC_FITS(hz, 1024UL, 65535UL) ? 1024UL : 0UL)
+
+#define HAL_CTC_CH2_DIV(hz) \
+	(HAL_CTC_FITS(hz, 1UL, 255UL)    ? 1UL    : HAL_CTC_FITS(hz, 8UL, 255UL)   ? 8UL   : \
+	 HAL_CTC_FITS(hz, 32UL, 255UL)   ? 32UL   : HAL_CTC_FITS(hz, 64UL, 255UL)  ? 64UL  : \
+	 HAL_CTC_FITS(hz, 128UL, 255UL)  ? 128UL  : HAL_CTC_FITS(hz, 256UL, 255UL) ? 256UL : \
+	 HAL_CTC_FITS(hz, 1024UL, 255UL) ? 1024UL : 0UL)
+
+/* CSn2:0 encoding of a prescaler division; timers 0 and 1 share it */
+#define HAL_CTC_CK01_OF(div) \
+	((div) == 0 ? 0 : 1 + ((div) >= 8) + ((div) >= 64) + ((div) >= 256) + ((div) >= 1024))
+#define HAL_CTC_CK2_OF(div) \
+	((div) == 0 ? 0 : 1 + ((div) >= 8) + ((div) >= 32) + ((div) >= 64) + ((div) >= 128) + ((div) >= 256) + ((div) >= 1024))
+
+#define HAL_CTC_CH0_CK(hz)  HAL_CTC_CK01_OF(HAL_CTC_CH0_DIV(hz))
+#define HAL_CTC_CH1_CK(hz)  HAL_CTC_CK01_OF(HAL_CTC_CH1_DIV(hz))
+#define HAL_CTC_CH2_CK(hz)  HAL_CTC_CK2_OF(HAL_CTC_CH2_DIV(hz))
+
+#define HAL_CTC_CH0_OCR(hz) (HAL_CTC_CH0_DIV(hz) ? HAL_CTC_OCR_FOR(hz, HAL_CTC_CH0_DIV(hz)) : 0UL)
+#define HAL_CTC_CH1_OCR(hz) (HAL_CTC_CH1_DIV(hz) ? HAL_CTC_OCR_FOR(hz, HAL_CTC_CH1_DIV(hz)) : 0UL)
+#define HAL_CTC_CH2_OCR(hz) (HAL_CTC_CH2_DIV(hz) ? HAL_CTC_OCR_FOR(hz, HAL_CTC_CH2_DIV(hz)) : 0UL)
+
 void HAL_CTC_Init(uint8_t src, uint8_t ch, uint8_t mode, uint8_t clk);
 
-void HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp);
+uint8_t HAL_CTC_SetValue(uint8_t src, uint8_t ch, uint16_t cmp);
+uint32_t HAL_CTC_SetFrequency(uint8_t src, uint8_t ch, uint32_t hz);
+
+void HAL_CTC_EnableInterrupt(uint8_t src, uint8_t ch);
+void HAL_CTC_DisableInterrupt(uint8_t src, uint8_t ch);
 
 void HAL_CTC_ConfigCH0(uint8_t ch, uint8_t mode, uint8_t clk);
 void HAL_CTC_ConfigCH1(uint8_t ch, uint8_t mode, uint8_t clk);
@@ -21,8 +21,40 @@
  *       Write multiple bytes (buffer) to EEPROM starting at the specified address.
  *       Returns the next available address after the written data.
  *
+ *   - uint8_t HAL_EEPROM_Update(unsigned int addr, unsigned char data);
+ *       Write a single byte only if it differs from the stored value, using
+ *       the shortest programming mode that produces it: erase-only when the
+ *       new value is 0xFF, write-only when it only clears bits, erase+write
+ *       otherwise. Returns 1 if the byte was programmed, 0 if skipped.
+ *
+ *   - size_t HAL_EEPROM_UpdateBlock(unsigned int addr, const unsigned char* data, size_t len);
+ *       HAL_EEPROM_Update for len bytes starting at addr. Returns the number
+ *       of bytes actually programmed (0 when the block was already stored).
+ *
+ *   - uint8_t HAL_EEPROM_SaveAsync(unsigned int addr,
+ *                                  const unsigned char* data,
+ *                                  size_t len,
+ *                                  void (*callback)(unsigned int addr));
+ *       Copy len bytes into the write queue and return at once; the bytes
+ *       are programmed one per EE_READY interrupt, unchanged bytes skipped.
+ *       callback (may be NULL) runs from the interrupt with the start
+ *       address once the last byte is done. Returns HAL_EEPROM_ST_PENDING
+ *       when queued, HAL_EEPROM_ST_BUSY if the queue has no room for the
+ *       whole block (nothing queued), HAL_EEPROM_ST_OK for len = 0 (no
+ *       callback). With HAL_EEPROM_USE_ISR = 0 the block is written before
+ *       returning, callback included, and HAL_EEPROM_ST_OK is returned.
+ *
+ *   - size_t HAL_EEPROM_Pending(void);
+ *       Number of queued bytes not yet programmed, including the one in
+ *       progress.
+ *
+ *   - void HAL_EEPROM_Flush(void);
+ *       Block until the queue is empty and no write is in progress (e.g.
+ *       before sleeping or on a brown-out warning).
+ *
  *   - unsigned char HAL_EEPROM_Read(unsigned int addr);
- *       Read a single byte from the specified EEPROM address.
+ *       Read a single byte from the specified EEPROM address. A byte still
+ *       in the write queue is returned from the queue.
  *
  *   - void HAL_EEPROM_Get(unsigned int addr, unsigned char* data, size_t len);
  *       Read multiple bytes from EEPROM starting at the specified address into
@@ -36,6 +68,15 @@
  *   - Write a buffer:
  *       unsigned char buffer[4] = {0x01, 0x02, 0x03, 0x04};
  *       unsigned int next_addr = HAL_EEPROM_Save(0x0020, buffer, 4);
+ *   - Store a configuration block, programming only the bytes that changed:
+ *       HAL_EEPROM_UpdateBlock(0x0040, (const unsigned char*) &config, sizeof(config));
+ *   - Save without stalling the main loop (HAL_EEPROM_USE_ISR = 1):
+ *       if(HAL_EEPROM_SaveAsync(0x0040, (const unsigned char*) &config, sizeof(config), on_saved) == HAL_EEPROM_ST_BUSY)
+ *       {
+ *           // retry later
+ *       }
+ *       ...
+ *       HAL_EEPROM_Flush();                   // before power-down
  *   - Read a single byte:
  *       unsigned char value = HAL_EEPROM_Read(0x0010);
  *   - Read a buffer:
@@ -47,7 +88,20 @@
  *     Ensure proper timing or use interrupt-driven approaches for time-critical
  *     applications.
  *   - EEPROM has a limited write endurance (typically ~100,000 cycles). Avoid
- *     excessive writes to the same address.
+ *     excessive writes to the same address; see nvstore.h for a wear-leveled
+ *     record store.
+ *   - An erase+write cycle takes about 3.4 ms, erase-only and write-only about
+ *     1.8 ms each. HAL_EEPROM_Update costs one read (a few cycles) for a byte
+ *     that is already stored, so prefer it over HAL_EEPROM_Write/Save for
+ *     data that is rewritten with mostly unchanged content.
+ *   - Interrupts are disabled for the few cycles between setting EEMPE and
+ *     EEPE, which must be no more than four clock cycles apart.
+ *   - With HAL_EEPROM_USE_ISR = 1, eeprom-hal.c owns EE_READY_vect. The
+ *     blocking writes first wait for the queue to drain, so all writes land
+ *     in call order. Reads of addresses that are not queued wait while a
+ *     queued byte is being programmed.
+ *   - The blocking calls service the queue by polling when called with
+ *     interrupts disabled, so they never dead-lock.
  *   - Address range is device-specific. Consult the target MCU datasheet for
  *     EEPROM size and valid address ranges.
  *   - Functions may block or wait for EEPROM ready status. Consider disabling
@@ -56,6 +110,20 @@
  *   - This header uses <avr/io.h> types and register definitions. Platform-
  *     specific implementations may be required for non-AVR targets.
  *
+ * Public constants:
+ *   HAL_EEPROM_SIZE       - EEPROM size in bytes (E2END + 1, 1024 on ATmega328P)
+ *   HAL_EEPROM_ST_OK      - nothing to do / written
+ *   HAL_EEPROM_ST_PENDING - queued, callback follows
+ *   HAL_EEPROM_ST_BUSY    - write queue full
+ *
+ * Configuration (compile-time, define before building eeprom-hal.c):
+ *   HAL_EEPROM_USE_ISR     - 1 enables the interrupt-driven write queue, 0
+ *                            (default) keeps every write blocking.
+ *   HAL_EEPROM_QUEUE_SIZE  - bytes in the write queue, 1 to 255 (default
+ *                            32); each takes 3 bytes of RAM.
+ *   HAL_EEPROM_QUEUE_REQS  - HAL_EEPROM_SaveAsync requests in flight,
+ *                            1 to 255 (default 4).
+ *
  * Author: otavioacb
  * Created: 2026-02-12
  *
@@ -66,19 +134,73 @@
  *
  * Change log:
  *   2026-02-12  v0.1  Initial header for EEPROM HAL
+ *   2026-10-14  v0.2  Added HAL_EEPROM_Update / HAL_EEPROM_UpdateBlock (compare before
+ *                     write, erase-only / write-only modes) and HAL_EEPROM_SIZE
+ *                     EEMPE/EEPE sequence now runs with interrupts disabled
+ *   2026-10-14  v0.3  Added EE_READY-driven write queue (HAL_EEPROM_USE_ISR):
+ *                     HAL_EEPROM_SaveAsync, HAL_EEPROM_Pending, HAL_EEPROM_Flush
+ *   2026-10-14  v0.4  Power management hooks (power-hal.h): the write queue holds ADC
+ *                     noise reduction
  *
  */
 
 #include "eeprom-hal.h"
 
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "power-hal.h"
+
+/* EEPM1:0 programming modes */
+#define EEPROM_MODE_ATOMIC 0x00
+#define EEPROM_MODE_ERASE  (1 << EEPM0)
+#define EEPROM_MODE_WRITE  (1 << EEPM1)
+
+#if HAL_EEPROM_USE_ISR
+
+/*
+ * Write queue: one (address, data) entry per byte, oldest at ee_tail. The
+ * entry at ee_tail is being programmed while ee_inflight is set. Each
+ * HAL_EEPROM_SaveAsync request remembers the index of its last entry, so
+ * its callback runs when that entry leaves the queue.
+ */
+static unsigned int  ee_addr[HAL_EEPROM_QUEUE_SIZE];
+static unsigned char ee_data[HAL_EEPROM_QUEUE_SIZE];
+static volatile uint8_t ee_head = 0;
+static volatile uint8_t ee_tail = 0;
+static volatile uint8_t ee_count = 0;
+static volatile uint8_t ee_inflight = 0;
+
+static void (*ee_req_cb[HAL_EEPROM_QUEUE_REQS])(unsigned int addr);
+static unsigned int ee_req_addr[HAL_EEPROM_QUEUE_REQS];
+static uint8_t ee_req_last[HAL_EEPROM_QUEUE_REQS];
+static volatile uint8_t ee_req_head = 0;
+static volatile uint8_t ee_req_tail = 0;
+static volatile uint8_t ee_req_count = 0;
+
+static void eeprom_service(void);
+static void eeprom_pop(void);
+static uint8_t eeprom_lookup(unsigned int addr, unsigned char* data);
+static void eeprom_drain(void);
+
+#endif
+
+static unsigned char eeprom_mode(unsigned char old, unsigned char data);
+static unsigned char eeprom_raw_read(unsigned int addr);
+static void eeprom_program(unsigned int addr, unsigned char data, unsigned char mode);
+
+#if HAL_EEPROM_USE_ISR
+
+ISR(EE_READY_vect)
+{
+	eeprom_service();
+}
+
+#endif
+
 void HAL_EEPROM_Write(unsigned int addr, unsigned char data)
 {
-	while(EECR & (1 << EEPE));
-	EEAR = addr;
-	
-	EEDR = data;
-	EECR |= (1 << EEMPE);
-	EECR |= (1 << EEPE);	
+	eeprom_program(addr, data, EEPROM_MODE_ATOMIC);
 }
 
 unsigned int HAL_EEPROM_Save(unsigned int addr, unsigned char* data, size_t len)
@@ -88,18 +210,270 @@ unsigned int HAL_EEPROM_Save(unsigned int addr, unsigned char* data, size_t len)
 	return addr - 1;
 }
 
+uint8_t HAL_EEPROM_Update(unsigned int addr, unsigned char data)
+{
+	unsigned char old = HAL_EEPROM_Read(addr);
+	
+	if(old == data) return 0;
+	
+	eeprom_program(addr, data, eeprom_mode(old, data));
+	
+	return 1;
+}
+
+size_t HAL_EEPROM_UpdateBlock(unsigned int addr, const unsigned char* data, size_t len)
+{
+	size_t written = 0;
+	
+	for(size_t i = 0; i < len; ++i) written += HAL_EEPROM_Update(addr++, data[i]);
+	
+	return written;
+}
+
+uint8_t HAL_EEPROM_SaveAsync(unsigned int addr, const unsigned char* data, size_t len, void (*callback)(unsigned int addr))
+{
+	if(len == 0) return HAL_EEPROM_ST_OK;
+	
+#if HAL_EEPROM_USE_ISR
+	uint8_t status = HAL_EEPROM_ST_PENDING;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(len > (size_t) (HAL_EEPROM_QUEUE_SIZE - ee_count) || ee_req_count >= HAL_EEPROM_QUEUE_REQS)
+		{
+			status = HAL_EEPROM_ST_BUSY;
+		}
+		else
+		{
+			uint8_t last = ee_head;
+			
+			for(size_t i = 0; i < len; ++i)
+			{
+				last = ee_head;
+				ee_addr[ee_head] = addr + i;
+				ee_data[ee_head] = data[i];
+				ee_head = (uint8_t) ((ee_head + 1U) % HAL_EEPROM_QUEUE_SIZE);
+			}
+			
+			ee_count = (uint8_t) (ee_count + len);
+			
+			ee_req_cb[ee_req_head]   = callback;
+			ee_req_addr[ee_req_head] = addr;
+			ee_req_last[ee_req_head] = last;
+			ee_req_head = (uint8_t) ((ee_req_head + 1U) % HAL_EEPROM_QUEUE_REQS);
+			ee_req_count++;
+			
+			/* EE_READY fires as soon as no write is in progress */
+			HAL_PWR_HOLD(HAL_PWR_ID_EEPROM, HAL_PWR_ADC_NR);
+			EECR |= (1 << EERIE);
+		}
+	}
+	
+	return status;
+#else
+	HAL_EEPROM_UpdateBlock(addr, data, len);
+	
+	if(callback) callback(addr);
+	
+	return HAL_EEPROM_ST_OK;
+#endif
+}
+
+size_t HAL_EEPROM_Pending(void)
+{
+#if HAL_EEPROM_USE_ISR
+	return ee_count;
+#else
+	return 0;
+#endif
+}
+
+void HAL_EEPROM_Flush(void)
+{
+#if HAL_EEPROM_USE_ISR
+	eeprom_drain();
+#endif
+	
+	while(EECR & (1 << EEPE));
+}
+
 unsigned char HAL_EEPROM_Read(unsigned int addr)
 {
+#if HAL_EEPROM_USE_ISR
+	unsigned char data = 0xFF;
+	uint8_t done = 0;
+	
+	/* Queued data is newer than the cell; otherwise wait for the write in progress */
+	while(!done)
+	{
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			if(eeprom_lookup(addr, &data))
+			{
+				done = 1;
+			}
+			else if(!(EECR & (1 << EEPE)))
+			{
+				data = eeprom_raw_read(addr);
+				done = 1;
+			}
+		}
+	}
+	
+	return data;
+#else
 	while(EECR & (1 << EEPE));
 	
+	return eeprom_raw_read(addr);
+#endif
+}
+
+
+void HAL_EEPROM_Get(unsigned int addr, unsigned char* data, size_t len)
+{
+	for(int i = 0; i < len; i++) data[i] = HAL_EEPROM_Read(addr++);
+}
+
+#if HAL_EEPROM_USE_ISR
+
+/*
+ * Retire the entry that just finished programming, then start the next
+ * entry that differs from the stored byte. Entries already holding the
+ * right value are retired without a write. EERIE is cleared once the queue
+ * is empty. Runs in EE_READY_vect, or polled with interrupts disabled.
+ */
+static void eeprom_service(void)
+{
+	if(ee_inflight)
+	{
+		ee_inflight = 0;
+		eeprom_pop();
+	}
+	
+	while(ee_count)
+	{
+		unsigned int  addr = ee_addr[ee_tail];
+		unsigned char data = ee_data[ee_tail];
+		unsigned char old  = eeprom_raw_read(addr);
+		
+		if(old != data)
+		{
+			EEDR = data;
+			EECR = (1 << EERIE) | eeprom_mode(old, data) | (1 << EEMPE);
+			EECR |= (1 << EEPE);
+			
+			ee_inflight = 1;
+			return;
+		}
+		
+		eeprom_pop();
+	}
+	
+	EECR &= ~(1 << EERIE);
+	HAL_PWR_DROP(HAL_PWR_ID_EEPROM);
+}
+
+static void eeprom_pop(void)
+{
+	uint8_t idx = ee_tail;
+	
+	ee_tail = (uint8_t) ((ee_tail + 1U) % HAL_EEPROM_QUEUE_SIZE);
+	ee_count--;
+	
+	if(ee_req_count && ee_req_last[ee_req_tail] == idx)
+	{
+		void (*callback)(unsigned int) = ee_req_cb[ee_req_tail];
+		unsigned int addr = ee_req_addr[ee_req_tail];
+		
+		ee_req_tail = (uint8_t) ((ee_req_tail + 1U) % HAL_EEPROM_QUEUE_REQS);
+		ee_req_count--;
+		
+		if(callback) callback(addr);
+	}
+}
+
+/*
+ * Find the newest queued value for addr, including the entry being
+ * programmed. Call with interrupts disabled.
+ */
+static uint8_t eeprom_lookup(unsigned int addr, unsigned char* data)
+{
+	uint8_t idx = ee_head;
+	
+	for(uint8_t n = ee_count; n > 0; --n)
+	{
+		idx = (uint8_t) ((idx + HAL_EEPROM_QUEUE_SIZE - 1U) % HAL_EEPROM_QUEUE_SIZE);
+		
+		if(ee_addr[idx] == addr)
+		{
+			*data = ee_data[idx];
+			return 1;
+		}
+	}
+	
+	return 0;
+}
+
+static void eeprom_drain(void)
+{
+	while(ee_count)
+	{
+		if(!(SREG & (1 << SREG_I)) && !(EECR & (1 << EEPE))) eeprom_service();
+	}
+}
+
+#endif
+
+/*
+ * Erase-only (0xFF) and write-only (bits only cleared) take about half
+ * the time of an erase+write cycle.
+ */
+static unsigned char eeprom_mode(unsigned char old, unsigned char data)
+{
+	if(data == 0xFF) return EEPROM_MODE_ERASE;
+	if((old & data) == data) return EEPROM_MODE_WRITE;
+	
+	return EEPROM_MODE_ATOMIC;
+}
+
+static unsigned char eeprom_raw_read(unsigned int addr)
+{
 	EEAR = addr;
 	EECR |= (1 << EERE);
 	
 	return EEDR;
 }
 
-
-void HAL_EEPROM_Get(unsigned int addr, unsigned char* data, size_t len)
+/*
+ * Start programming one byte in the given EEPM mode. EEMPE must be followed
+ * by EEPE within four cycles, so that pair runs with interrupts disabled;
+ * EERIE is preserved. With the write queue enabled, queued bytes are
+ * written first so the order of writes is kept.
+ */
+static void eeprom_program(unsigned int addr, unsigned char data, unsigned char mode)
 {
-	for(int i = 0; i < len; i++) data[i] = HAL_EEPROM_Read(addr++);
+	uint8_t done = 0;
+	
+	while(!done)
+	{
+#if HAL_EEPROM_USE_ISR
+		eeprom_drain();
+#endif
+		while(EECR & (1 << EEPE));
+		
+		/* An interrupt may have queued and started a write since the wait */
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			if(HAL_EEPROM_Pending() == 0 && !(EECR & (1 << EEPE)))
+			{
+				EEAR = addr;
+				EEDR = data;
+				
+				EECR = (EECR & (1 << EERIE)) | mode | (1 << EEMPE);
+				EECR |= (1 << EEPE);
+				
+				done = 1;
+			}
+		}
+	}
 }
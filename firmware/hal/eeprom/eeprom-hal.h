@@ -21,8 +21,40 @@
  *       Write multiple bytes (buffer) to EEPROM starting at the specified address.
  *       Returns the next available address after the written data.
  *
+ *   - uint8_t HAL_EEPROM_Update(unsigned int addr, unsigned char data);
+ *       Write a single byte only if it differs from the stored value, using
+ *       the shortest programming mode that produces it: erase-only when the
+ *       new value is 0xFF, write-only when it only clears bits, erase+write
+ *       otherwise. Returns 1 if the byte was programmed, 0 if skipped.
+ *
+ *   - size_t HAL_EEPROM_UpdateBlock(unsigned int addr, const unsigned char* data, size_t len);
+ *       HAL_EEPROM_Update for len bytes starting at addr. Returns the number
+ *       of bytes actually programmed (0 when the block was already stored).
+ *
+ *   - uint8_t HAL_EEPROM_SaveAsync(unsigned int addr,
+ *                                  const unsigned char* data,
+ *                                  size_t len,
+ *                                  void (*callback)(unsigned int addr));
+ *       Copy len bytes into the write queue and return at once; the bytes
+ *       are programmed one per EE_READY interrupt, unchanged bytes skipped.
+ *       callback (may be NULL) runs from the interrupt with the start
+ *       address once the last byte is done. Returns HAL_EEPROM_ST_PENDING
+ *       when queued, HAL_EEPROM_ST_BUSY if the queue has no room for the
+ *       whole block (nothing queued), HAL_EEPROM_ST_OK for len = 0 (no
+ *       callback). With HAL_EEPROM_USE_ISR = 0 the block is written before
+ *       returning, callback included, and HAL_EEPROM_ST_OK is returned.
+ *
+ *   - size_t HAL_EEPROM_Pending(void);
+ *       Number of queued bytes not yet programmed, including the one in
+ *       progress.
+ *
+ *   - void HAL_EEPROM_Flush(void);
+ *       Block until the queue is empty and no write is in progress (e.g.
+ *       before sleeping or on a brown-out warning).
+ *
  *   - unsigned char HAL_EEPROM_Read(unsigned int addr);
- *       Read a single byte from the specified EEPROM address.
+ *       Read a single byte from the specified EEPROM address. A byte still
+ *       in the write queue is returned from the queue.
  *
  *   - void HAL_EEPROM_Get(unsigned int addr, unsigned char* data, size_t len);
  *       Read multiple bytes from EEPROM starting at the specified address into
@@ -36,6 +68,15 @@
  *   - Write a buffer:
  *       unsigned char buffer[4] = {0x01, 0x02, 0x03, 0x04};
  *       unsigned int next_addr = HAL_EEPROM_Save(0x0020, buffer, 4);
+ *   - Store a configuration block, programming only the bytes that changed:
+ *       HAL_EEPROM_UpdateBlock(0x0040, (const unsigned char*) &config, sizeof(config));
+ *   - Save without stalling the main loop (HAL_EEPROM_USE_ISR = 1):
+ *       if(HAL_EEPROM_SaveAsync(0x0040, (const unsigned char*) &config, sizeof(config), on_saved) == HAL_EEPROM_ST_BUSY)
+ *       {
+ *           // retry later
+ *       }
+ *       ...
+ *       HAL_EEPROM_Flush();                   // before power-down
  *   - Read a single byte:
  *       unsigned char value = HAL_EEPROM_Read(0x0010);
  *   - Read a buffer:
@@ -47,7 +88,20 @@
  *     Ensure proper timing or use interrupt-driven approaches for time-critical
  *     applications.
  *   - EEPROM has a limited write endurance (typically ~100,000 cycles). Avoid
- *     excessive writes to the same address.
+ *     excessive writes to the same address; see nvstore.h for a wear-leveled
+ *     record store.
+ *   - An erase+write cycle takes about 3.4 ms, erase-only and write-only about
+ *     1.8 ms each. HAL_EEPROM_Update costs one read (a few cycles) for a byte
+ *     that is already stored, so prefer it over HAL_EEPROM_Write/Save for
+ *     data that is rewritten with mostly unchanged content.
+ *   - Interrupts are disabled for the few cycles between setting EEMPE and
+ *     EEPE, which must be no more than four clock cycles apart.
+ *   - With HAL_EEPROM_USE_ISR = 1, eeprom-hal.c owns EE_READY_vect. The
+ *     blocking writes first wait for the queue to drain, so all writes land
+ *     in call order. Reads of addresses that are not queued wait while a
+ *     queued byte is being programmed.
+ *   - The blocking calls service the queue by polling when called with
+ *     interrupts disabled, so they never dead-lock.
  *   - Address range is device-specific. Consult the target MCU datasheet for
  *     EEPROM size and valid address ranges.
  *   - Functions may block or wait for EEPROM ready status. Consider disabling
@@ -56,6 +110,20 @@
  *   - This header uses <avr/io.h> types and register definitions. Platform-
  *     specific implementations may be required for non-AVR targets.
  *
+ * Public constants:
+ *   HAL_EEPROM_SIZE       - EEPROM size in bytes (E2END + 1, 1024 on ATmega328P)
+ *   HAL_EEPROM_ST_OK      - nothing to do / written
+ *   HAL_EEPROM_ST_PENDING - queued, callback follows
+ *   HAL_EEPROM_ST_BUSY    - write queue full
+ *
+ * Configuration (compile-time, define before building eeprom-hal.c):
+ *   HAL_EEPROM_USE_ISR     - 1 enables the interrupt-driven write queue, 0
+ *                            (default) keeps every write blocking.
+ *   HAL_EEPROM_QUEUE_SIZE  - bytes in the write queue, 1 to 255 (default
+ *                            32); each takes 3 bytes of RAM.
+ *   HAL_EEPROM_QUEUE_REQS  - HAL_EEPROM_SaveAsync requests in flight,
+ *                            1 to 255 (default 4).
+ *
  * Author: otavioacb
  * Created: 2026-02-12
  *
@@ -66,6 +134,13 @@
  *
  * Change log:
  *   2026-02-12  v0.1  Initial header for EEPROM HAL
+ *   2026-10-14  v0.2  Added HAL_EEPROM_Update / HAL_EEPROM_UpdateBlock (compare before
+ *                     write, erase-only / write-only modes) and HAL_EEPROM_SIZE
+ *                     EEMPE/EEPE sequence now runs with interrupts disabled
+ *   2026-10-14  v0.3  Added EE_READY-driven write queue (HAL_EEPROM_USE_ISR):
+ *                     HAL_EEPROM_SaveAsync, HAL_EEPROM_Pending, HAL_EEPROM_Flush
+ *   2026-10-14  v0.4  Power management hooks (power-hal.h): the write queue holds ADC
+ *                     noise reduction
  *
  */
 
@@ -73,10 +148,43 @@
 #define EEPROM_HAL_H_
 
 #include <avr/io.h>
+#include <stdint.h>
 #include <stddef.h>
 
+#ifndef HAL_EEPROM_USE_ISR
+	#define HAL_EEPROM_USE_ISR 0
+#endif
+
+#ifndef HAL_EEPROM_QUEUE_SIZE
+	#define HAL_EEPROM_QUEUE_SIZE 32U
+#endif
+
+#ifndef HAL_EEPROM_QUEUE_REQS
+	#define HAL_EEPROM_QUEUE_REQS 4U
+#endif
+
+#if (HAL_EEPROM_QUEUE_SIZE < 1) || (HAL_EEPROM_QUEUE_SIZE > 255)
+	#error "HAL_EEPROM_QUEUE_SIZE must be between 1 and 255"
+#endif
+
+#if (HAL_EEPROM_QUEUE_REQS < 1) || (HAL_EEPROM_QUEUE_REQS > 255)
+	#error "HAL_EEPROM_QUEUE_REQS must be between 1 and 255"
+#endif
+
+#define HAL_EEPROM_SIZE ((unsigned int) E2END + 1U)
+
+#define HAL_EEPROM_ST_OK      0x00
+#define HAL_EEPROM_ST_PENDING 0x01
+#define HAL_EEPROM_ST_BUSY    0x02
+
 void HAL_EEPROM_Write(unsigned int addr, unsigned char data);
 unsigned int HAL_EEPROM_Save(unsigned int addr, unsigned char* data, size_t len);
+uint8_t HAL_EEPROM_Update(unsigned int addr, unsigned char data);
+size_t HAL_EEPROM_UpdateBlock(unsigned int addr, const unsigned char* data, size_t len);
+
+uint8_t HAL_EEPROM_SaveAsync(unsigned int addr, const unsigned char* data, size_t len, void (*callback)(unsigned int addr));
+size_t HAL_EEPROM_Pending(void);
+void HAL_EEPROM_Flush(void);
 unsigned char HAL_EEPROM_Read(unsigned int addr);
 void HAL_EEPROM_Get(unsigned int addr, unsigned char* data, size_t len); 
 
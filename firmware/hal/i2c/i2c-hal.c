@@ -12,18 +12,26 @@
  *   both controller (master) and peripheral (slave) modes. The API is
  *   intentionally small and hardware-agnostic so it can be used in examples,
  *   libraries and higher-level firmware components.
+ *   Controller transfers are executed by a TWI_vect-driven state machine
+ *   that runs queued transaction descriptors entirely in the interrupt:
+ *   START → SLA+W → DATA → repeated START → SLA+R → DATA → STOP.
  *
  * Public API:
- *   void HAL_I2C_InitController(uint32_t freq);
+ *   uint32_t HAL_I2C_InitController(uint32_t freq);
  *     Initialize the I2C peripheral in controller (master) mode with the
- *     specified SCL clock frequency in Hz.
+ *     specified SCL clock frequency in Hz. Returns the frequency achieved
+ *     (see HAL_I2C_SetFrequency).
  *
  *   void HAL_I2C_InitPeripheral(unsigned char addr);
  *     Initialize the I2C peripheral in peripheral (slave) mode, responding
  *     to the specified 7-bit address.
  *
- *   void HAL_I2C_SetFrequency(uint32_t freq);
- *     Change the SCL clock frequency. Only effective in controller mode.
+ *   uint32_t HAL_I2C_SetFrequency(uint32_t freq);
+ *     Change the SCL clock frequency. Searches the TWPS prescalers for the
+ *     fastest rate not above freq (capped at HAL_I2C_FREQ_FAST) that F_CPU
+ *     allows and returns it in Hz, rounded. Requests below the slowest
+ *     rate (about 490 Hz at 16 MHz) get the slowest rate. Only effective
+ *     in controller mode; call it while no transaction is running.
  *
  *   void HAL_I2C_EndComm(void);
  *     Disable the I2C peripheral and release the bus.
@@ -50,6 +58,87 @@
  *     NACK to signal the end of the transfer.
  *     Performs a complete START → SLA+R → DATA[0..len-1] → STOP sequence.
  *
+ *   uint8_t HAL_I2C_ControllerWriteRead(unsigned char addr,
+ *                                       const unsigned char *wbuf,
+ *                                       size_t wlen,
+ *                                       unsigned char *rbuf,
+ *                                       size_t rlen);
+ *     Write wlen bytes and then read rlen bytes in a single transaction
+ *     joined by a repeated START:
+ *     START → SLA+W → WBUF → repeated START → SLA+R → RBUF → STOP.
+ *     Returns the transaction status (HAL_I2C_ST_*).
+ *
+ *   uint8_t HAL_I2C_WriteReg(unsigned char addr,
+ *                            unsigned char reg,
+ *                            unsigned char value);
+ *     Write one byte to register reg of the peripheral (START → SLA+W →
+ *     REG → VALUE → STOP). Returns the transaction status.
+ *
+ *   unsigned char HAL_I2C_ReadReg(unsigned char addr, unsigned char reg);
+ *     Read one byte from register reg of the peripheral with a single
+ *     repeated-START transaction.
+ *
+ *   uint8_t HAL_I2C_ReadRegs(unsigned char addr,
+ *                            unsigned char reg,
+ *                            unsigned char *buf,
+ *                            size_t len);
+ *     Read len consecutive registers starting at reg into buf with a single
+ *     repeated-START transaction (relies on register auto-increment).
+ *     Returns the transaction status.
+ *
+ *   uint8_t HAL_I2C_UpdateRegBits(unsigned char addr,
+ *                                 unsigned char reg,
+ *                                 unsigned char mask,
+ *                                 unsigned char value);
+ *     Read-modify-write of register reg: bits set in mask are replaced by
+ *     the corresponding bits of value. The register is read with one
+ *     repeated-START transaction and written back only if it changes.
+ *     Returns the status of the last transaction issued.
+ *
+ *   uint8_t HAL_I2C_Submit(HAL_I2C_Transaction_t *t);
+ *     Queue a controller transaction and return immediately. The transfer
+ *     starts as soon as the bus is free. When it ends, t->status holds one
+ *     of the HAL_I2C_ST_* codes and t->callback (if not NULL) is invoked
+ *     from the TWI interrupt. Returns HAL_I2C_ST_PENDING, or
+ *     HAL_I2C_ST_BUSY if t is already queued.
+ *
+ *   uint8_t HAL_I2C_Wait(HAL_I2C_Transaction_t *t);
+ *     Block until t has completed and return its final status. Aborts the
+ *     running transfer with HAL_I2C_ST_TIMEOUT if the bus makes no progress
+ *     for HAL_I2C_TIMEOUT_LOOPS polling iterations.
+ *
+ *   uint8_t HAL_I2C_IsBusy(void);
+ *     Return non-zero while a transaction is queued or running.
+ *
+ *   void HAL_I2C_Abort(void);
+ *     Terminate the running transaction with HAL_I2C_ST_TIMEOUT, reset the
+ *     TWI module, recover the bus (HAL_I2C_RecoverBus) and continue with
+ *     the next queued transaction.
+ *
+ *   uint8_t HAL_I2C_GetLastStatus(void);
+ *     Status of the most recently completed controller transaction. Useful
+ *     after the blocking HAL_I2C_Controller* calls, which return no status.
+ *     Peripheral functions set it to HAL_I2C_ST_TIMEOUT when they give up.
+ *
+ *   uint8_t HAL_I2C_RecoverBus(void);
+ *     Free a bus held by a peripheral stuck in the middle of a byte: with
+ *     the TWI disabled, bit-bang up to nine SCL pulses on PC5 until SDA
+ *     (PC4) is released, then a STOP. A running transaction ends with
+ *     HAL_I2C_ST_TIMEOUT. Returns HAL_I2C_ST_OK if both lines are high
+ *     afterwards, HAL_I2C_ST_BUS_ERROR if one is still held low, or
+ *     HAL_I2C_ST_BUSY if a recovery is already running.
+ *
+ *   uint8_t HAL_I2C_Probe(unsigned char addr);
+ *     Send START, SLA+W and STOP without data. Returns HAL_I2C_ST_OK if a
+ *     device acknowledged addr, HAL_I2C_ST_NACK_ADDR if none did, or the
+ *     bus fault.
+ *
+ *   uint8_t HAL_I2C_Scan(unsigned char* found, uint8_t max);
+ *     Probe every non-reserved 7-bit address (HAL_I2C_SCAN_FIRST to
+ *     HAL_I2C_SCAN_LAST) in ascending order. Stores up to max responding
+ *     addresses in found and returns how many responded. Stops early on a
+ *     bus fault; HAL_I2C_GetLastStatus then tells which.
+ *
  *   void HAL_I2C_PeripheralSend(unsigned char data);
  *     Transmit a single byte to the controller. Waits for the controller to
  *     address this device with SLA+R before sending.
@@ -68,19 +157,64 @@
  *     Sends ACK after each byte except the last, which receives NACK to
  *     signal that the buffer is full.
  *
+ * Public types:
+ *   HAL_I2C_Transaction_t
+ *     Controller transaction descriptor. Owned by the caller and must stay
+ *     valid until the transaction completes:
+ *       unsigned char        addr     — 7-bit peripheral address
+ *       const unsigned char *wbuf     — bytes to write (may be NULL if wlen = 0)
+ *       size_t               wlen     — number of bytes to write
+ *       unsigned char       *rbuf     — destination for read bytes
+ *       size_t               rlen     — number of bytes to read
+ *       void (*callback)(HAL_I2C_Transaction_t *t)
+ *                                     — completion callback (ISR context)
+ *       void                *ctx      — user context for the callback
+ *       volatile uint8_t     status   — HAL_I2C_ST_* code (set by the HAL)
+ *     With wlen > 0 and rlen > 0 the read phase follows the write phase
+ *     after a repeated START. With wlen = rlen = 0 only the address is sent
+ *     (address probe).
+ *
  * Public constants:
+ *   SCL frequencies:
+ *     HAL_I2C_FREQ_STD  - 100 kHz, standard mode
+ *     HAL_I2C_FREQ_FAST - 400 kHz, fast mode (highest rate of the TWI);
+ *                         pass it to get the fastest rate F_CPU allows
+ *
+ *   Transaction status codes:
+ *     HAL_I2C_ST_OK        - transfer completed, all bytes ACKed
+ *     HAL_I2C_ST_PENDING   - queued, waiting for the bus
+ *     HAL_I2C_ST_BUSY      - transfer in progress
+ *     HAL_I2C_ST_NACK_ADDR - address not acknowledged (SLA+W or SLA+R)
+ *     HAL_I2C_ST_NACK_DATA - data byte not acknowledged
+ *     HAL_I2C_ST_ARB_LOST  - arbitration lost to another controller
+ *     HAL_I2C_ST_TIMEOUT   - no bus progress, aborted
+ *     HAL_I2C_ST_BUS_ERROR - illegal START/STOP detected on the bus
+ *
+ *   Scan range (addresses 0x00-0x07 and 0x78-0x7F are reserved):
+ *     HAL_I2C_SCAN_FIRST - 0x08
+ *     HAL_I2C_SCAN_LAST  - 0x77
+ *
  *   Clock prescalers (TWPS bits in TWSR):
  *     HAL_I2C_PRE_1  - prescaler value 1   (TWPS = 0b00)
  *     HAL_I2C_PRE_4  - prescaler value 4   (TWPS = 0b01)
  *     HAL_I2C_PRE_16 - prescaler value 16  (TWPS = 0b10)
  *     HAL_I2C_PRE_64 - prescaler value 64  (TWPS = 0b11)
  *
+ * Configuration (compile-time, define before building i2c-hal.c):
+ *   HAL_I2C_TIMEOUT_LOOPS - polling iterations without bus progress before
+ *                           a controller transfer, a pending STOP or a
+ *                           peripheral data byte is given up (default
+ *                           60000, some tens of milliseconds at 16 MHz).
+ *
  * Usage:
  *   - Include this header where I2C access is required:
  *       #include "i2c-hal.h"
  *
  *   - Initialize I2C in controller mode at 100 kHz:
- *       HAL_I2C_InitController(100000UL);
+ *       HAL_I2C_InitController(HAL_I2C_FREQ_STD);
+ *
+ *   - Fastest rate up to 400 kHz, read back the rate obtained:
+ *       uint32_t scl = HAL_I2C_InitController(HAL_I2C_FREQ_FAST);
  *
  *   - Transmit a single byte to address 0x48:
  *       HAL_I2C_ControllerSend(0x48, 0xAA);
@@ -96,6 +230,17 @@
  *       unsigned char buf[4];
  *       HAL_I2C_ControllerReceive(0x48, buf, 4);
  *
+ *   - Read register 0x0E of address 0x68 and set its bit 2:
+ *       unsigned char ctrl = HAL_I2C_ReadReg(0x68, 0x0E);
+ *       HAL_I2C_UpdateRegBits(0x68, 0x0E, 0x04, 0x04);
+ *
+ *   - List the devices on the bus:
+ *       unsigned char found[8];
+ *       uint8_t n = HAL_I2C_Scan(found, sizeof(found));
+ *
+ *   - Free a bus that keeps timing out, e.g. after a reset in mid-read:
+ *       if(HAL_I2C_GetLastStatus() == HAL_I2C_ST_TIMEOUT) HAL_I2C_RecoverBus();
+ *
  *   - Initialize I2C in peripheral mode at address 0x32:
  *       HAL_I2C_InitPeripheral(0x32);
  *
@@ -105,15 +250,50 @@
  *   - Wait for and send a single byte to the controller:
  *       HAL_I2C_PeripheralSend(0xAA);
  *
+ *   - Read 7 bytes starting at register 0x00 without blocking:
+ *       static unsigned char reg = 0x00;
+ *       static unsigned char buf[7];
+ *       static HAL_I2C_Transaction_t t = {0x68, &reg, 1, buf, 7, on_done};
+ *       HAL_I2C_Submit(&t);       // on_done(&t) runs when the STOP is sent
+ *
  * Notes:
  *   - All addresses passed to the API are 7-bit. The R/W bit is managed
  *     internally by the HAL.
  *   - SCL frequency is derived from the CPU clock using the formula defined
  *     in the ATmega328P datasheet (section 26.5.2):
- *       TWBR = (F_CPU / freq - 16) / (2 * prescaler)
- *     HAL_I2C_SetFrequency assumes F_CPU = 16 MHz and prescaler = 1.
- *   - All operations are blocking (polling). Consider interrupt-driven
- *     transfers for performance-critical applications.
+ *       SCL = F_CPU / (16 + 2 * TWBR * prescaler)
+ *     i2c-hal.c uses F_CPU (default 16 MHz). At 16 MHz 400 kHz and 100 kHz
+ *     are exact (TWBR 12 and 72, prescaler 1); a 10 kHz long-cable bus
+ *     uses prescaler 4 (TWBR 198). At 1 MHz the fastest rate is 62.5 kHz.
+ *   - SCL rise time also limits the rate: with long wires or weak pull-ups
+ *     choose a lower frequency rather than relying on the value returned.
+ *   - Controller transfers run in the TWI interrupt. The blocking
+ *     HAL_I2C_Controller* functions are thin wrappers that submit a
+ *     transaction and wait for it. With global interrupts disabled the
+ *     wrappers drive the same state machine by polling TWINT, so they also
+ *     work before sei() is called.
+ *   - i2c-hal.c owns TWI_vect; the application must not define it.
+ *   - Every controller phase is checked against TWSR: a NACKed address
+ *     ends the transaction right after SLA+W / SLA+R and a NACKed data
+ *     byte right after that byte, both with a STOP.
+ *   - A timeout in HAL_I2C_Wait aborts the transfer and runs the bus
+ *     recovery, so a peripheral that stretches SCL forever or holds SDA
+ *     low costs one timeout, not a hang. Asynchronous users detect this
+ *     themselves and call HAL_I2C_Abort.
+ *   - The STOP wait and the bus recovery run with interrupts enabled;
+ *     only claiming and releasing the queue is done atomically. They still
+ *     block the caller: a STOP wait takes up to HAL_I2C_TIMEOUT_LOOPS
+ *     polls, and a recovery against a peripheral that holds SCL low up to
+ *     11 pin releases of HAL_I2C_TIMEOUT_LOOPS polls each, about 300 ms at
+ *     16 MHz with the default. Called from an interrupt (e.g. a Submit in
+ *     a callback), that time is spent with interrupts disabled.
+ *   - Recovery needs pull-ups on SDA/SCL; the internal ones (PORTC4/5) are
+ *     kept if enabled but are too weak above 100 kHz.
+ *   - A scan sends about 20 bit times per address: some 25 ms at 100 kHz,
+ *     6 ms at 400 kHz.
+ *   - Peripheral (slave) mode operations are blocking (polling). Waiting
+ *     to be addressed is unbounded; each data byte after that times out
+ *     after HAL_I2C_TIMEOUT_LOOPS polls.
  *   - This HAL does not support multi-controller (multi-master) arbitration.
  *   - This HAL does not support 10-bit addressing.
  *
@@ -127,103 +307,381 @@
  *
  * Change log:
  *   2026-02-23  v0.1  Initial header for I2C HAL
+ *   2026-10-14  v0.2  Added TWI_vect-driven controller transaction engine:
+ *                     HAL_I2C_Submit, HAL_I2C_Wait, HAL_I2C_IsBusy, HAL_I2C_Abort,
+ *                     HAL_I2C_GetLastStatus and HAL_I2C_ST_* status codes.
+ *                     Blocking controller functions now wrap the engine.
+ *   2026-10-14  v0.3  Added repeated-START register access: HAL_I2C_ControllerWriteRead,
+ *                     HAL_I2C_WriteReg, HAL_I2C_ReadReg, HAL_I2C_ReadRegs and
+ *                     HAL_I2C_UpdateRegBits
+ *   2026-10-14  v0.4  Power management hooks (power-hal.h): queued transactions hold
+ *                     IDLE
+ *   2026-10-14  v0.5  Bounded STOP and peripheral waits, bus recovery (HAL_I2C_RecoverBus,
+ *                     also run by HAL_I2C_Abort), HAL_I2C_Probe and HAL_I2C_Scan
+ *   2026-10-14  v0.6  HAL_I2C_SetFrequency uses F_CPU, searches the TWPS prescalers and
+ *                     returns the rate achieved; HAL_I2C_FREQ_STD / HAL_I2C_FREQ_FAST
+ *   2026-10-14  v0.7  Cycle trace hook (trace-hal.h) in TWI_vect
+ *   2026-10-14  v0.8  STOP wait and bus recovery run with interrupts enabled; a claim
+ *                     flag keeps the queue owned meanwhile
  *
  */
 
 #include "i2c-hal.h"
 
-static void i2c_controller_start(void);
-static void i2c_controller_stop(void);
-static void i2c_controller_slaw(unsigned char addr);
-static void i2c_controller_slar(unsigned char addr);
+#ifndef F_CPU
+	#define F_CPU 16000000UL
+#endif
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+
+#include "power-hal.h"
+#include "trace-hal.h"
+
+/* TWSR status codes (prescaler bits masked), ATmega328P datasheet 26.7 */
+#define I2C_TW_START       0x08
+#define I2C_TW_REP_START   0x10
+#define I2C_TW_MT_SLA_ACK  0x18
+#define I2C_TW_MT_SLA_NACK 0x20
+#define I2C_TW_MT_DATA_ACK 0x28
+#define I2C_TW_MT_DATA_NACK 0x30
+#define I2C_TW_ARB_LOST    0x38
+#define I2C_TW_MR_SLA_ACK  0x40
+#define I2C_TW_MR_SLA_NACK 0x48
+#define I2C_TW_MR_DATA_ACK 0x50
+#define I2C_TW_MR_DATA_NACK 0x58
+#define I2C_TW_BUS_ERROR   0x00
+
+#define I2C_TW_STATUS()    (TWSR & 0xF8)
+
+#define I2C_CR_GO   ((1 << TWEN) | (1 << TWIE) | (1 << TWINT))
+
+/* TWI pins, driven by hand during bus recovery */
+#define I2C_SDA     (1 << PC4)
+#define I2C_SCL     (1 << PC5)
+
+/* Half period of the recovery clock (about 100 kHz) */
+#define I2C_RECOVER_HALF_US 5
+
+static HAL_I2C_Transaction_t* volatile i2c_head = NULL;
+static HAL_I2C_Transaction_t* i2c_tail = NULL;
+
+static size_t  i2c_widx = 0;
+static size_t  i2c_ridx = 0;
+static uint8_t i2c_reading = 0;
+
+static volatile uint8_t i2c_steps = 0;
+static volatile uint8_t i2c_last_status = HAL_I2C_ST_OK;
+static volatile uint8_t i2c_recovering = 0;
+
 static void i2c_peripheral_wait_addr(void);
+static uint8_t i2c_peripheral_step(uint8_t twcr);
 
-void HAL_I2C_InitController(uint32_t freq)
+static uint8_t i2c_wait_stop(void);
+static uint8_t i2c_recover(void);
+static void i2c_release_pin(uint8_t pin);
+static void i2c_resume(uint8_t abort, uint8_t twcr);
+
+static void i2c_service(void);
+static void i2c_begin(uint8_t twcr);
+static void i2c_finish(uint8_t status, uint8_t twcr);
+static uint8_t i2c_run(unsigned char addr, const unsigned char* wbuf, size_t wlen, unsigned char* rbuf, size_t rlen);
+
+uint32_t HAL_I2C_InitController(uint32_t freq)
 {
-	HAL_I2C_SetFrequency(freq);
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TWI);
+	freq = HAL_I2C_SetFrequency(freq);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		i2c_head = NULL;
+		i2c_tail = NULL;
+	}
 	
 	TWCR = (1 << TWEN);
+	
+	return freq;
 }
 
 void HAL_I2C_InitPeripheral(unsigned char addr)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TWI);
 	TWAR = (addr << 1);
 	
 	TWCR = (1 << TWEN) | (1 << TWEA);
 }
 
-void HAL_I2C_SetFrequency(uint32_t freq)
+uint32_t HAL_I2C_SetFrequency(uint32_t freq)
 {
-	TWSR = 0x00;
+	uint32_t clocks;
+	uint32_t twbr = 0;
+	uint8_t  pre;
 	
-	TWBR = (uint8_t)(( 16000000U/ freq - 16U) / 2U);
+	if(freq > HAL_I2C_FREQ_FAST) freq = HAL_I2C_FREQ_FAST;
+	if(freq == 0) freq = 1;
+	
+	/*
+	 * SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS). Round the period up so the
+	 * bus never runs faster than requested. The step of each prescaler is
+	 * a multiple of the previous one, so the first prescaler whose TWBR
+	 * fits in 8 bits gives the closest rate.
+	 */
+	clocks = (F_CPU + freq - 1UL) / freq;
+	
+	for(pre = HAL_I2C_PRE_1; pre <= HAL_I2C_PRE_64; ++pre)
+	{
+		uint32_t step = 2UL << (2 * pre);
+		
+		twbr = (clocks > 16UL) ? (clocks - 16UL + step - 1UL) / step : 0UL;
+		if(twbr <= 0xFF) break;
+	}
+	
+	if(pre > HAL_I2C_PRE_64)
+	{
+		pre  = HAL_I2C_PRE_64;
+		twbr = 0xFF;
+	}
+	
+	TWSR = pre;
+	TWBR = (uint8_t) twbr;
+	
+	clocks = 16UL + ((2UL << (2 * pre)) * twbr);
+	
+	return (F_CPU + clocks / 2UL) / clocks;
 }
 
 void HAL_I2C_ControllerSend(unsigned char addr, unsigned char data)
 {
-	i2c_controller_start();
+	i2c_run(addr, &data, 1, NULL, 0);
+}
+
+void HAL_I2C_ControllerTransmit(unsigned char addr, unsigned char* buf, size_t len)
+{
+	i2c_run(addr, buf, len, NULL, 0);
+}
+
+
+unsigned char HAL_I2C_ControllerRead(unsigned char addr)
+{
+	unsigned char recv = 0x00;
 	
-	i2c_controller_slaw(addr);
+	i2c_run(addr, NULL, 0, &recv, 1);
 	
-	TWDR = data;
-	TWCR = (1 << TWEN) | (1 << TWINT);
-	WAIT_TWINT();
+	return recv;
+}
+
+void HAL_I2C_ControllerReceive(unsigned char addr, unsigned char* buf, size_t len)
+{
+	i2c_run(addr, NULL, 0, buf, len);
+}
+
+uint8_t HAL_I2C_ControllerWriteRead(unsigned char addr, const unsigned char* wbuf, size_t wlen, unsigned char* rbuf, size_t rlen)
+{
+	return i2c_run(addr, wbuf, wlen, rbuf, rlen);
+}
+
+uint8_t HAL_I2C_WriteReg(unsigned char addr, unsigned char reg, unsigned char value)
+{
+	unsigned char buf[2] = {reg, value};
 	
-	i2c_controller_stop();
+	return i2c_run(addr, buf, 2, NULL, 0);
 }
 
-void HAL_I2C_ControllerTransmit(unsigned char addr, unsigned char* buf, size_t len)
+unsigned char HAL_I2C_ReadReg(unsigned char addr, unsigned char reg)
 {
-	i2c_controller_start();
+	unsigned char value = 0x00;
 	
-	i2c_controller_slaw(addr);
+	i2c_run(addr, &reg, 1, &value, 1);
 	
-	for(int i = 0; i < len; ++i)
+	return value;
+}
+
+uint8_t HAL_I2C_ReadRegs(unsigned char addr, unsigned char reg, unsigned char* buf, size_t len)
+{
+	return i2c_run(addr, &reg, 1, buf, len);
+}
+
+uint8_t HAL_I2C_UpdateRegBits(unsigned char addr, unsigned char reg, unsigned char mask, unsigned char value)
+{
+	unsigned char old = 0x00;
+	uint8_t status = i2c_run(addr, &reg, 1, &old, 1);
+	
+	if(status != HAL_I2C_ST_OK) return status;
+	
+	unsigned char new_val = (old & ~mask) | (value & mask);
+	
+	if(new_val == old) return HAL_I2C_ST_OK;
+	
+	return HAL_I2C_WriteReg(addr, reg, new_val);
+}
+
+/*
+ * The first transaction of an empty queue is claimed with i2c_recovering
+ * set, then the previous STOP is waited for (and the bus recovered) with
+ * interrupts enabled. The TWI interrupt is off at that point, since the
+ * last i2c_finish cleared TWIE, so nothing else touches the hardware.
+ */
+uint8_t HAL_I2C_Submit(HAL_I2C_Transaction_t* t)
+{
+	uint8_t start = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
-		TWDR = buf[i];
-		TWCR = (1 << TWEN) | (1 << TWINT);
-		WAIT_TWINT();
+		if(t->status == HAL_I2C_ST_PENDING || t->status == HAL_I2C_ST_BUSY) return HAL_I2C_ST_BUSY;
+		
+		t->status = HAL_I2C_ST_PENDING;
+		t->next   = NULL;
+		
+		if(i2c_head == NULL)
+		{
+			i2c_head = i2c_tail = t;
+			HAL_PWR_HOLD(HAL_PWR_ID_I2C, HAL_PWR_IDLE);
+			
+			/* A recovery in progress starts t when it completes */
+			if(!i2c_recovering)
+			{
+				i2c_recovering = 1;
+				start = 1;
+			}
+		}
+		else
+		{
+			i2c_tail->next = t;
+			i2c_tail = t;
+		}
+	}
+	
+	if(start)
+	{
+		/* A STOP that never completes means SCL is held low */
+		uint8_t stuck = !i2c_wait_stop();
+		
+		if(stuck)
+		{
+			TWCR = 0;
+			i2c_recover();
+		}
+		
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			if(stuck) TWCR = (1 << TWEN);
+			i2c_resume(0, 0);
+		}
 	}
 	
-	i2c_controller_stop();
+	return HAL_I2C_ST_PENDING;
 }
 
-
-unsigned char HAL_I2C_ControllerRead(unsigned char addr)
+uint8_t HAL_I2C_Wait(HAL_I2C_Transaction_t* t)
 {
-	unsigned char recv = 0x00;
-	
-	i2c_controller_start();
+	uint16_t idle  = 0;
+	uint8_t  steps = i2c_steps;
 	
-	i2c_controller_slar(addr);
+	while(t->status == HAL_I2C_ST_PENDING || t->status == HAL_I2C_ST_BUSY)
+	{
+		/* No ISR will run: drive the state machine from here */
+		if(!(SREG & (1 << SREG_I)) && !i2c_recovering && (TWCR & (1 << TWINT))) i2c_service();
+		
+		if(steps != i2c_steps)
+		{
+			steps = i2c_steps;
+			idle  = 0;
+		}
+		else if(++idle >= HAL_I2C_TIMEOUT_LOOPS)
+		{
+			HAL_I2C_Abort();
+			idle = 0;
+		}
+	}
 	
-	TWCR = (1 << TWEN) | (1 << TWINT);
-	WAIT_TWINT();
-	recv = TWDR;
+	return t->status;
+}
+
+uint8_t HAL_I2C_IsBusy(void)
+{
+	return (i2c_head != NULL) ? 1U : 0U;
+}
+
+void HAL_I2C_Abort(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		/* Nothing to abort, or a recovery already owns the bus */
+		if(i2c_head == NULL || i2c_recovering) return;
+		
+		/* Disabling TWEN resets the TWI state and hands SDA/SCL to the port */
+		i2c_recovering = 1;
+		TWCR = 0;
+	}
 	
-	i2c_controller_stop();
+	i2c_recover();
 	
-	return recv;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TWCR = (1 << TWEN);
+		i2c_resume(1, (1 << TWEN));
+	}
 }
 
-void HAL_I2C_ControllerReceive(unsigned char addr, unsigned char* buf, size_t len)
+uint8_t HAL_I2C_GetLastStatus(void)
 {
-	i2c_controller_start();
+	return i2c_last_status;
+}
+
+uint8_t HAL_I2C_RecoverBus(void)
+{
+	uint8_t mode, abort, ok;
 	
-	i2c_controller_slar(addr);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(i2c_recovering) return HAL_I2C_ST_BUSY;
+		
+		/* Keep listening for our address if in peripheral mode */
+		mode  = (i2c_head == NULL) ? (TWCR & (1 << TWEA)) : 0;
+		abort = (i2c_head != NULL) ? 1U : 0U;
+		
+		i2c_recovering = 1;
+		TWCR = 0;
+	}
 	
-	for(int i = 0; i < len - 1; ++i)
+	ok = i2c_recover();
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
-		TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWEA);
-		WAIT_TWINT();
-		buf[i] = TWDR;
+		TWCR = (1 << TWEN) | mode;
+		i2c_resume(abort, (1 << TWEN) | mode);
 	}
 	
-	TWCR = (1 << TWEN) | (1 << TWINT);
-	WAIT_TWINT();
-	buf[len - 1] = TWDR;
+	return ok ? HAL_I2C_ST_OK : HAL_I2C_ST_BUS_ERROR;
+}
+
+uint8_t HAL_I2C_Probe(unsigned char addr)
+{
+	return i2c_run(addr, NULL, 0, NULL, 0);
+}
+
+uint8_t HAL_I2C_Scan(unsigned char* found, uint8_t max)
+{
+	uint8_t count = 0;
+	
+	for(unsigned char addr = HAL_I2C_SCAN_FIRST; addr <= HAL_I2C_SCAN_LAST; ++addr)
+	{
+		uint8_t status = HAL_I2C_Probe(addr);
+		
+		if(status == HAL_I2C_ST_OK)
+		{
+			if(count < max) found[count] = addr;
+			count++;
+		}
+		else if(status != HAL_I2C_ST_NACK_ADDR)
+		{
+			/* Bus fault: every further probe would time out as well */
+			break;
+		}
+	}
 	
-	i2c_controller_stop();
+	return count;
 }
 
 
@@ -233,8 +691,7 @@ void HAL_I2C_PeripheralSend(unsigned char data)
 	
 	TWDR = data;
 	
-	TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWEA);
-	WAIT_TWINT();	
+	i2c_peripheral_step((1 << TWEN) | (1 << TWINT) | (1 << TWEA));
 }
 
 void HAL_I2C_PeripheralTransmit(unsigned char* buf, size_t len)
@@ -244,8 +701,7 @@ void HAL_I2C_PeripheralTransmit(unsigned char* buf, size_t len)
 	for(int i = 0; i < len; ++i)
 	{
 		TWDR = buf[i];
-		TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWEA);
-		WAIT_TWINT();
+		if(!i2c_peripheral_step((1 << TWEN) | (1 << TWINT) | (1 << TWEA))) return;
 	}
 }
 
@@ -253,8 +709,7 @@ unsigned char HAL_I2C_PeripheralRead(void)
 {
 	i2c_peripheral_wait_addr();
 	
-	TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWEA);
-	WAIT_TWINT();
+	if(!i2c_peripheral_step((1 << TWEN) | (1 << TWINT) | (1 << TWEA))) return 0x00;
 	
 	return TWDR;
 }
@@ -265,12 +720,10 @@ void HAL_I2C_PeripheralReceive(unsigned char* buf, size_t len)
 	
 	for(int i = 0; i < len - 1; ++i)
 	{
-		TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWEA);
-		WAIT_TWINT();
+		if(!i2c_peripheral_step((1 << TWEN) | (1 << TWINT) | (1 << TWEA))) return;
 		buf[i] = TWDR;
 	}
-	TWCR = (1 << TWEN) | (1 << TWINT);
-	WAIT_TWINT();
+	if(!i2c_peripheral_step((1 << TWEN) | (1 << TWINT))) return;
 	buf[len - 1] = TWDR;
 }
 
@@ -279,34 +732,257 @@ void HAL_I2C_EndComm(void)
 	TWCR &= ~(1 << TWEN);
 }
 
-static void i2c_controller_start(void)
+ISR(TWI_vect)
 {
-	TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWSTA);
-	WAIT_TWINT();	
+	HAL_TRACE_ENTER(HAL_TRACE_ID_I2C);
+	i2c_service();
+	HAL_TRACE_EXIT(HAL_TRACE_ID_I2C);
 }
 
-static void i2c_controller_stop(void)
+static void i2c_peripheral_wait_addr(void)
 {
-	TWCR = (1 << TWEN) | (1 << TWINT) | (1 << TWSTO);
-	WAIT_STOP();
+	TWCR = (1 << TWEN) | (1 << TWEA);
+	
+	/* Unbounded on purpose: the controller decides when to address us */
+	while(!(TWCR & (1 << TWINT)));
 }
 
-static void i2c_controller_slaw(unsigned char addr)
+/*
+ * One peripheral data byte: write twcr and wait for TWINT. If the
+ * controller stops clocking mid-transfer, the TWI is reset back to address
+ * listening and 0 is returned (HAL_I2C_GetLastStatus gives TIMEOUT).
+ */
+static uint8_t i2c_peripheral_step(uint8_t twcr)
 {
-	TWDR = (addr << 1);
-	TWCR = (1 << TWEN) | (1 << TWINT);
-	WAIT_TWINT();
+	TWCR = twcr;
+	
+	for(uint16_t n = 0; n < HAL_I2C_TIMEOUT_LOOPS; ++n)
+	{
+		if(TWCR & (1 << TWINT)) return 1;
+	}
+	
+	TWCR = 0;
+	TWCR = (1 << TWEN) | (1 << TWEA);
+	i2c_last_status = HAL_I2C_ST_TIMEOUT;
+	
+	return 0;
 }
 
-static void i2c_controller_slar(unsigned char addr)
+/*
+ * Controller state machine. Runs once per TWINT, either from TWI_vect or
+ * polled by HAL_I2C_Wait when interrupts are disabled. Every branch ends
+ * by writing TWCR, which clears TWINT and lets the hardware continue.
+ */
+static void i2c_service(void)
 {
-	TWDR = (addr << 1) | 0x01;
-	TWCR = (1 << TWEN) | (1 << TWINT);
-	WAIT_TWINT();
+	HAL_I2C_Transaction_t* t = i2c_head;
+	
+	i2c_steps++;
+	
+	if(t == NULL)
+	{
+		TWCR = (1 << TWEN) | (1 << TWINT);
+		return;
+	}
+	
+	switch(I2C_TW_STATUS())
+	{
+		case I2C_TW_START:
+		case I2C_TW_REP_START:
+			TWDR = (t->addr << 1) | (i2c_reading ? 0x01 : 0x00);
+			TWCR = I2C_CR_GO;
+			break;
+			
+		case I2C_TW_MT_SLA_ACK:
+		case I2C_TW_MT_DATA_ACK:
+			if(i2c_widx < t->wlen)
+			{
+				TWDR = t->wbuf[i2c_widx++];
+				TWCR = I2C_CR_GO;
+			}
+			else if(t->rlen > 0)
+			{
+				i2c_reading = 1;
+				TWCR = I2C_CR_GO | (1 << TWSTA);
+			}
+			else
+			{
+				i2c_finish(HAL_I2C_ST_OK, (1 << TWEN) | (1 << TWINT) | (1 << TWSTO));
+			}
+			break;
+			
+		case I2C_TW_MR_SLA_ACK:
+			TWCR = (t->rlen > 1) ? (I2C_CR_GO | (1 << TWEA)) : I2C_CR_GO;
+			break;
+			
+		case I2C_TW_MR_DATA_ACK:
+			t->rbuf[i2c_ridx++] = TWDR;
+			TWCR = (i2c_ridx < t->rlen - 1) ? (I2C_CR_GO | (1 << TWEA)) : I2C_CR_GO;
+			break;
+			
+		case I2C_TW_MR_DATA_NACK:
+			t->rbuf[i2c_ridx++] = TWDR;
+			i2c_finish(HAL_I2C_ST_OK, (1 << TWEN) | (1 << TWINT) | (1 << TWSTO));
+			break;
+			
+		case I2C_TW_MT_SLA_NACK:
+		case I2C_TW_MR_SLA_NACK:
+			i2c_finish(HAL_I2C_ST_NACK_ADDR, (1 << TWEN) | (1 << TWINT) | (1 << TWSTO));
+			break;
+			
+		case I2C_TW_MT_DATA_NACK:
+			i2c_finish(HAL_I2C_ST_NACK_DATA, (1 << TWEN) | (1 << TWINT) | (1 << TWSTO));
+			break;
+			
+		case I2C_TW_ARB_LOST:
+			/* The bus belongs to another controller: release it, no STOP */
+			i2c_finish(HAL_I2C_ST_ARB_LOST, (1 << TWEN) | (1 << TWINT));
+			break;
+			
+		case I2C_TW_BUS_ERROR:
+		default:
+			i2c_finish(HAL_I2C_ST_BUS_ERROR, (1 << TWEN) | (1 << TWINT) | (1 << TWSTO));
+			break;
+	}
 }
 
-static void i2c_peripheral_wait_addr(void)
+/*
+ * Prepare the state for the transaction at the head of the queue and
+ * write twcr (normally a START request) to kick the hardware.
+ */
+static void i2c_begin(uint8_t twcr)
 {
-	TWCR = (1 << TWEN) | (1 << TWEA);
-	WAIT_TWINT();
+	HAL_I2C_Transaction_t* t = i2c_head;
+	
+	i2c_widx    = 0;
+	i2c_ridx    = 0;
+	i2c_reading = (t->wlen == 0 && t->rlen > 0) ? 1 : 0;
+	t->status   = HAL_I2C_ST_BUSY;
+	
+	TWCR = twcr;
+}
+
+/*
+ * Complete the transaction at the head of the queue with the given status.
+ * twcr releases the bus (STOP or plain release). If another transaction is
+ * queued, a START is requested in the same write: with both TWSTO and TWSTA
+ * set the hardware sends STOP followed by START.
+ */
+static void i2c_finish(uint8_t status, uint8_t twcr)
+{
+	HAL_I2C_Transaction_t* t = i2c_head;
+	
+	i2c_head = t->next;
+	if(i2c_head == NULL) i2c_tail = NULL;
+	t->next = NULL;
+	
+	if(i2c_head != NULL)
+	{
+		i2c_begin(twcr | (1 << TWIE) | (1 << TWSTA));
+	}
+	else
+	{
+		TWCR = twcr;
+		HAL_PWR_DROP(HAL_PWR_ID_I2C);
+	}
+	
+	i2c_last_status = status;
+	t->status = status;
+	
+	if(t->callback) t->callback(t);
+}
+
+/*
+ * Blocking helper shared by the HAL_I2C_Controller* wrappers.
+ */
+static uint8_t i2c_run(unsigned char addr, const unsigned char* wbuf, size_t wlen, unsigned char* rbuf, size_t rlen)
+{
+	HAL_I2C_Transaction_t t = {addr, wbuf, wlen, rbuf, rlen, NULL, NULL, HAL_I2C_ST_OK, NULL};
+	
+	HAL_I2C_Submit(&t);
+	
+	return HAL_I2C_Wait(&t);
+}
+
+/*
+ * Wait for the STOP requested by the previous transaction to go out.
+ * Returns 0 if it is still pending after HAL_I2C_TIMEOUT_LOOPS polls.
+ */
+static uint8_t i2c_wait_stop(void)
+{
+	for(uint16_t n = 0; n < HAL_I2C_TIMEOUT_LOOPS; ++n)
+	{
+		if(!(TWCR & (1 << TWSTO))) return 1;
+	}
+	
+	return 0;
+}
+
+/*
+ * Bus recovery (I2C specification UM10204, 3.1.16). A peripheral that lost
+ * clocks in the middle of a read, e.g. across an MCU reset, keeps driving
+ * SDA low while it waits for the rest of its byte. Clock SCL until it lets
+ * go, at most nine pulses, then send a STOP. The
+ * TWI must be disabled so the port drives the pins; they are driven open-
+ * drain by switching DDR with PORT = 0. Returns 1 if both lines are high
+ * afterwards.
+ */
+static uint8_t i2c_recover(void)
+{
+	uint8_t pullups = PORTC & (I2C_SDA | I2C_SCL);
+	
+	PORTC &= ~(I2C_SDA | I2C_SCL);
+	DDRC  &= ~(I2C_SDA | I2C_SCL);
+	_delay_us(I2C_RECOVER_HALF_US);
+	
+	for(uint8_t i = 0; i < 9 && !(PINC & I2C_SDA); ++i)
+	{
+		DDRC |= I2C_SCL;
+		_delay_us(I2C_RECOVER_HALF_US);
+		i2c_release_pin(I2C_SCL);
+	}
+	
+	/* STOP: SDA rises while SCL is high */
+	DDRC |= I2C_SCL;
+	_delay_us(I2C_RECOVER_HALF_US);
+	DDRC |= I2C_SDA;
+	_delay_us(I2C_RECOVER_HALF_US);
+	i2c_release_pin(I2C_SCL);
+	i2c_release_pin(I2C_SDA);
+	
+	uint8_t ok = ((PINC & (I2C_SDA | I2C_SCL)) == (I2C_SDA | I2C_SCL)) ? 1U : 0U;
+	
+	PORTC |= pullups;
+	
+	return ok;
+}
+
+/*
+ * Release a recovery pin and give the pull-up half a clock period to raise
+ * it. A peripheral stretching SCL is waited for, up to HAL_I2C_TIMEOUT_LOOPS
+ * polls.
+ */
+static void i2c_release_pin(uint8_t pin)
+{
+	DDRC &= ~pin;
+	_delay_us(I2C_RECOVER_HALF_US);
+	
+	for(uint16_t n = 0; n < HAL_I2C_TIMEOUT_LOOPS && !(PINC & pin); ++n);
+}
+
+/*
+ * End of a claim taken by Submit, Abort or RecoverBus; called with
+ * interrupts disabled once the bus has been handled. With abort the
+ * transaction that was running ends with HAL_I2C_ST_TIMEOUT and twcr
+ * releases the bus; otherwise the head of the queue (one submitted during
+ * the recovery included) is started.
+ */
+static void i2c_resume(uint8_t abort, uint8_t twcr)
+{
+	i2c_recovering = 0;
+	
+	if(i2c_head == NULL) return;
+	
+	if(abort) i2c_finish(HAL_I2C_ST_TIMEOUT, twcr);
+	else i2c_begin(I2C_CR_GO | (1 << TWSTA));
 }
@@ -12,18 +12,26 @@
  *   both controller (master) and peripheral (slave) modes. The API is
  *   intentionally small and hardware-agnostic so it can be used in examples,
  *   libraries and higher-level firmware components.
+ *   Controller transfers are executed by a TWI_vect-driven state machine
+ *   that runs queued transaction descriptors entirely in the interrupt:
+ *   START → SLA+W → DATA → repeated START → SLA+R → DATA → STOP.
  *
  * Public API:
- *   void HAL_I2C_InitController(uint32_t freq);
+ *   uint32_t HAL_I2C_InitController(uint32_t freq);
  *     Initialize the I2C peripheral in controller (master) mode with the
- *     specified SCL clock frequency in Hz.
+ *     specified SCL clock frequency in Hz. Returns the frequency achieved
+ *     (see HAL_I2C_SetFrequency).
  *
  *   void HAL_I2C_InitPeripheral(unsigned char addr);
  *     Initialize the I2C peripheral in peripheral (slave) mode, responding
  *     to the specified 7-bit address.
  *
- *   void HAL_I2C_SetFrequency(uint32_t freq);
- *     Change the SCL clock frequency. Only effective in controller mode.
+ *   uint32_t HAL_I2C_SetFrequency(uint32_t freq);
+ *     Change the SCL clock frequency. Searches the TWPS prescalers for the
+ *     fastest rate not above freq (capped at HAL_I2C_FREQ_FAST) that F_CPU
+ *     allows and returns it in Hz, rounded. Requests below the slowest
+ *     rate (about 490 Hz at 16 MHz) get the slowest rate. Only effective
+ *     in controller mode; call it while no transaction is running.
  *
  *   void HAL_I2C_EndComm(void);
  *     Disable the I2C peripheral and release the bus.
@@ -50,6 +58,87 @@
  *     NACK to signal the end of the transfer.
  *     Performs a complete START → SLA+R → DATA[0..len-1] → STOP sequence.
  *
+ *   uint8_t HAL_I2C_ControllerWriteRead(unsigned char addr,
+ *                                       const unsigned char *wbuf,
+ *                                       size_t wlen,
+ *                                       unsigned char *rbuf,
+ *                                       size_t rlen);
+ *     Write wlen bytes and then read rlen bytes in a single transaction
+ *     joined by a repeated START:
+ *     START → SLA+W → WBUF → repeated START → SLA+R → RBUF → STOP.
+ *     Returns the transaction status (HAL_I2C_ST_*).
+ *
+ *   uint8_t HAL_I2C_WriteReg(unsigned char addr,
+ *                            unsigned char reg,
+ *                            unsigned char value);
+ *     Write one byte to register reg of the peripheral (START → SLA+W →
+ *     REG → VALUE → STOP). Returns the transaction status.
+ *
+ *   unsigned char HAL_I2C_ReadReg(unsigned char addr, unsigned char reg);
+ *     Read one byte from register reg of the peripheral with a single
+ *     repeated-START transaction.
+ *
+ *   uint8_t HAL_I2C_ReadRegs(unsigned char addr,
+ *                            unsigned char reg,
+ *                            unsigned char *buf,
+ *                            size_t len);
+ *     Read len consecutive registers starting at reg into buf with a single
+ *     repeated-START transaction (relies on register auto-increment).
+ *     Returns the transaction status.
+ *
+ *   uint8_t HAL_I2C_UpdateRegBits(unsigned char addr,
+ *                                 unsigned char reg,
+ *                                 unsigned char mask,
+ *                                 unsigned char value);
+ *     Read-modify-write of register reg: bits set in mask are replaced by
+ *     the corresponding bits of value. The register is read with one
+ *     repeated-START transaction and written back only if it changes.
+ *     Returns the status of the last transaction issued.
+ *
+ *   uint8_t HAL_I2C_Submit(HAL_I2C_Transaction_t *t);
+ *     Queue a controller transaction and return immediately. The transfer
+ *     starts as soon as the bus is free. When it ends, t->status holds one
+ *     of the HAL_I2C_ST_* codes and t->callback (if not NULL) is invoked
+ *     from the TWI interrupt. Returns HAL_I2C_ST_PENDING, or
+ *     HAL_I2C_ST_BUSY if t is already queued.
+ *
+ *   uint8_t HAL_I2C_Wait(HAL_I2C_Transaction_t *t);
+ *     Block until t has completed and return its final status. Aborts the
+ *     running transfer with HAL_I2C_ST_TIMEOUT if the bus makes no progress
+ *     for HAL_I2C_TIMEOUT_LOOPS polling iterations.
+ *
+ *   uint8_t HAL_I2C_IsBusy(void);
+ *     Return non-zero while a transaction is queued or running.
+ *
+ *   void HAL_I2C_Abort(void);
+ *     Terminate the running transaction with HAL_I2C_ST_TIMEOUT, reset the
+ *     TWI module, recover the bus (HAL_I2C_RecoverBus) and continue with
+ *     the next queued transaction.
+ *
+ *   uint8_t HAL_I2C_GetLastStatus(void);
+ *     Status of the most recently completed controller transaction. Useful
+ *     after the blocking HAL_I2C_Controller* calls, which return no status.
+ *     Peripheral functions set it to HAL_I2C_ST_TIMEOUT when they give up.
+ *
+ *   uint8_t HAL_I2C_RecoverBus(void);
+ *     Free a bus held by a peripheral stuck in the middle of a byte: with
+ *     the TWI disabled, bit-bang up to nine SCL pulses on PC5 until SDA
+ *     (PC4) is released, then a STOP. A running transaction ends with
+ *     HAL_I2C_ST_TIMEOUT. Returns HAL_I2C_ST_OK if both lines are high
+ *     afterwards, HAL_I2C_ST_BUS_ERROR if one is still held low, or
+ *     HAL_I2C_ST_BUSY if a recovery is already running.
+ *
+ *   uint8_t HAL_I2C_Probe(unsigned char addr);
+ *     Send START, SLA+W and STOP without data. Returns HAL_I2C_ST_OK if a
+ *     device acknowledged addr, HAL_I2C_ST_NACK_ADDR if none did, or the
+ *     bus fault.
+ *
+ *   uint8_t HAL_I2C_Scan(unsigned char* found, uint8_t max);
+ *     Probe every non-reserved 7-bit address (HAL_I2C_SCAN_FIRST to
+ *     HAL_I2C_SCAN_LAST) in ascending order. Stores up to max responding
+ *     addresses in found and returns how many responded. Stops early on a
+ *     bus fault; HAL_I2C_GetLastStatus then tells which.
+ *
  *   void HAL_I2C_PeripheralSend(unsigned char data);
  *     Transmit a single byte to the controller. Waits for the controller to
  *     address this device with SLA+R before sending.
@@ -68,19 +157,64 @@
  *     Sends ACK after each byte except the last, which receives NACK to
  *     signal that the buffer is full.
  *
+ * Public types:
+ *   HAL_I2C_Transaction_t
+ *     Controller transaction descriptor. Owned by the caller and must stay
+ *     valid until the transaction completes:
+ *       unsigned char        addr     — 7-bit peripheral address
+ *       const unsigned char *wbuf     — bytes to write (may be NULL if wlen = 0)
+ *       size_t               wlen     — number of bytes to write
+ *       unsigned char       *rbuf     — destination for read bytes
+ *       size_t               rlen     — number of bytes to read
+ *       void (*callback)(HAL_I2C_Transaction_t *t)
+ *                                     — completion callback (ISR context)
+ *       void                *ctx      — user context for the callback
+ *       volatile uint8_t     status   — HAL_I2C_ST_* code (set by the HAL)
+ *     With wlen > 0 and rlen > 0 the read phase follows the write phase
+ *     after a repeated START. With wlen = rlen = 0 only the address is sent
+ *     (address probe).
+ *
  * Public constants:
+ *   SCL frequencies:
+ *     HAL_I2C_FREQ_STD  - 100 kHz, standard mode
+ *     HAL_I2C_FREQ_FAST - 400 kHz, fast mode (highest rate of the TWI);
+ *                         pass it to get the fastest rate F_CPU allows
+ *
+ *   Transaction status codes:
+ *     HAL_I2C_ST_OK        - transfer completed, all bytes ACKed
+ *     HAL_I2C_ST_PENDING   - queued, waiting for the bus
+ *     HAL_I2C_ST_BUSY      - transfer in progress
+ *     HAL_I2C_ST_NACK_ADDR - address not acknowledged (SLA+W or SLA+R)
+ *     HAL_I2C_ST_NACK_DATA - data byte not acknowledged
+ *     HAL_I2C_ST_ARB_LOST  - arbitration lost to another controller
+ *     HAL_I2C_ST_TIMEOUT   - no bus progress, aborted
+ *     HAL_I2C_ST_BUS_ERROR - illegal START/STOP detected on the bus
+ *
+ *   Scan range (addresses 0x00-0x07 and 0x78-0x7F are reserved):
+ *     HAL_I2C_SCAN_FIRST - 0x08
+ *     HAL_I2C_SCAN_LAST  - 0x77
+ *
  *   Clock prescalers (TWPS bits in TWSR):
  *     HAL_I2C_PRE_1  - prescaler value 1   (TWPS = 0b00)
  *     HAL_I2C_PRE_4  - prescaler value 4   (TWPS = 0b01)
  *     HAL_I2C_PRE_16 - prescaler value 16  (TWPS = 0b10)
  *     HAL_I2C_PRE_64 - prescaler value 64  (TWPS = 0b11)
  *
+ * Configuration (compile-time, define before building i2c-hal.c):
+ *   HAL_I2C_TIMEOUT_LOOPS - polling iterations without bus progress before
+ *                           a controller transfer, a pending STOP or a
+ *                           peripheral data byte is given up (default
+ *                           60000, some tens of milliseconds at 16 MHz).
+ *
  * Usage:
  *   - Include this header where I2C access is required:
  *       #include "i2c-hal.h"
  *
  *   - Initialize I2C in controller mode at 100 kHz:
- *       HAL_I2C_InitController(100000UL);
+ *       HAL_I2C_InitController(HAL_I2C_FREQ_STD);
+ *
+ *   - Fastest rate up to 400 kHz, read back the rate obtained:
+ *       uint32_t scl = HAL_I2C_InitController(HAL_I2C_FREQ_FAST);
  *
  *   - Transmit a single byte to address 0x48:
  *       HAL_I2C_ControllerSend(0x48, 0xAA);
@@ -96,6 +230,17 @@
  *       unsigned char buf[4];
  *       HAL_I2C_ControllerReceive(0x48, buf, 4);
  *
+ *   - Read register 0x0E of address 0x68 and set its bit 2:
+ *       unsigned char ctrl = HAL_I2C_ReadReg(0x68, 0x0E);
+ *       HAL_I2C_UpdateRegBits(0x68, 0x0E, 0x04, 0x04);
+ *
+ *   - List the devices on the bus:
+ *       unsigned char found[8];
+ *       uint8_t n = HAL_I2C_Scan(found, sizeof(found));
+ *
+ *   - Free a bus that keeps timing out, e.g. after a reset in mid-read:
+ *       if(HAL_I2C_GetLastStatus() == HAL_I2C_ST_TIMEOUT) HAL_I2C_RecoverBus();
+ *
  *   - Initialize I2C in peripheral mode at address 0x32:
  *       HAL_I2C_InitPeripheral(0x32);
  *
@@ -105,15 +250,50 @@
  *   - Wait for and send a single byte to the controller:
  *       HAL_I2C_PeripheralSend(0xAA);
  *
+ *   - Read 7 bytes starting at register 0x00 without blocking:
+ *       static unsigned char reg = 0x00;
+ *       static unsigned char buf[7];
+ *       static HAL_I2C_Transaction_t t = {0x68, &reg, 1, buf, 7, on_done};
+ *       HAL_I2C_Submit(&t);       // on_done(&t) runs when the STOP is sent
+ *
  * Notes:
  *   - All addresses passed to the API are 7-bit. The R/W bit is managed
  *     internally by the HAL.
  *   - SCL frequency is derived from the CPU clock using the formula defined
  *     in the ATmega328P datasheet (section 26.5.2):
- *       TWBR = (F_CPU / freq - 16) / (2 * prescaler)
- *     HAL_I2C_SetFrequency assumes F_CPU = 16 MHz and prescaler = 1.
- *   - All operations are blocking (polling). Consider interrupt-driven
- *     transfers for performance-critical applications.
+ *       SCL = F_CPU / (16 + 2 * TWBR * prescaler)
+ *     i2c-hal.c uses F_CPU (default 16 MHz). At 16 MHz 400 kHz and 100 kHz
+ *     are exact (TWBR 12 and 72, prescaler 1); a 10 kHz long-cable bus
+ *     uses prescaler 4 (TWBR 198). At 1 MHz the fastest rate is 62.5 kHz.
+ *   - SCL rise time also limits the rate: with long wires or weak pull-ups
+ *     choose a lower frequency rather than relying on the value returned.
+ *   - Controller transfers run in the TWI interrupt. The blocking
+ *     HAL_I2C_Controller* functions are thin wrappers that submit a
+ *     transaction and wait for it. With global interrupts disabled the
+ *     wrappers drive the same state machine by polling TWINT, so they also
+ *     work before sei() is called.
+ *   - i2c-hal.c owns TWI_vect; the application must not define it.
+ *   - Every controller phase is checked against TWSR: a NACKed address
+ *     ends the transaction right after SLA+W / SLA+R and a NACKed data
+ *     byte right after that byte, both with a STOP.
+ *   - A timeout in HAL_I2C_Wait aborts the transfer and runs the bus
+ *     recovery, so a peripheral that stretches SCL forever or holds SDA
+ *     low costs one timeout, not a hang. Asynchronous users detect this
+ *     themselves and call HAL_I2C_Abort.
+ *   - The STOP wait and the bus recovery run with interrupts enabled;
+ *     only claiming and releasing the queue is done atomically. They still
+ *     block the caller: a STOP wait takes up to HAL_I2C_TIMEOUT_LOOPS
+ *     polls, and a recovery against a peripheral that holds SCL low up to
+ *     11 pin releases of HAL_I2C_TIMEOUT_LOOPS polls each, about 300 ms at
+ *     16 MHz with the default. Called from an interrupt (e.g. a Submit in
+ *     a callback), that time is spent with interrupts disabled.
+ *   - Recovery needs pull-ups on SDA/SCL; the internal ones (PORTC4/5) are
+ *     kept if enabled but are too weak above 100 kHz.
+ *   - A scan sends about 20 bit times per address: some 25 ms at 100 kHz,
+ *     6 ms at 400 kHz.
+ *   - Peripheral (slave) mode operations are blocking (polling). Waiting
+ *     to be addressed is unbounded; each data byte after that times out
+ *     after HAL_I2C_TIMEOUT_LOOPS polls.
  *   - This HAL does not support multi-controller (multi-master) arbitration.
  *   - This HAL does not support 10-bit addressing.
  *
@@ -127,6 +307,22 @@
  *
  * Change log:
  *   2026-02-23  v0.1  Initial header for I2C HAL
+ *   2026-10-14  v0.2  Added TWI_vect-driven controller transaction engine:
+ *                     HAL_I2C_Submit, HAL_I2C_Wait, HAL_I2C_IsBusy, HAL_I2C_Abort,
+ *                     HAL_I2C_GetLastStatus and HAL_I2C_ST_* status codes.
+ *                     Blocking controller functions now wrap the engine.
+ *   2026-10-14  v0.3  Added repeated-START register access: HAL_I2C_ControllerWriteRead,
+ *                     HAL_I2C_WriteReg, HAL_I2C_ReadReg, HAL_I2C_ReadRegs and
+ *                     HAL_I2C_UpdateRegBits
+ *   2026-10-14  v0.4  Power management hooks (power-hal.h): queued transactions hold
+ *                     IDLE
+ *   2026-10-14  v0.5  Bounded STOP and peripheral waits, bus recovery (HAL_I2C_RecoverBus,
+ *                     also run by HAL_I2C_Abort), HAL_I2C_Probe and HAL_I2C_Scan
+ *   2026-10-14  v0.6  HAL_I2C_SetFrequency uses F_CPU, searches the TWPS prescalers and
+ *                     returns the rate achieved; HAL_I2C_FREQ_STD / HAL_I2C_FREQ_FAST
+ *   2026-10-14  v0.7  Cycle trace hook (trace-hal.h) in TWI_vect
+ *   2026-10-14  v0.8  STOP wait and bus recovery run with interrupts enabled; a claim
+ *                     flag keeps the queue owned meanwhile
  *
  */
 
@@ -137,18 +333,51 @@
 #include <stdint.h>
 #include <stddef.h>
 
-#define WAIT_TWINT() while(!(TWCR & (1 << TWINT)))
-#define WAIT_STOP()  while(TWCR & (1 << TWSTO))
+#define HAL_I2C_FREQ_STD  100000UL
+#define HAL_I2C_FREQ_FAST 400000UL
 
 #define HAL_I2C_PRE_1  0x00
 #define HAL_I2C_PRE_4  0x01
 #define HAL_I2C_PRE_16 0x02
 #define HAL_I2C_PRE_64 0x03
 
-void HAL_I2C_InitController(uint32_t freq);
+#define HAL_I2C_ST_OK        0x00
+#define HAL_I2C_ST_PENDING   0x01
+#define HAL_I2C_ST_BUSY      0x02
+#define HAL_I2C_ST_NACK_ADDR 0x03
+#define HAL_I2C_ST_NACK_DATA 0x04
+#define HAL_I2C_ST_ARB_LOST  0x05
+#define HAL_I2C_ST_TIMEOUT   0x06
+#define HAL_I2C_ST_BUS_ERROR 0x07
+
+#define HAL_I2C_SCAN_FIRST   0x08
+#define HAL_I2C_SCAN_LAST    0x77
+
+#ifndef HAL_I2C_TIMEOUT_LOOPS
+	#define HAL_I2C_TIMEOUT_LOOPS 60000U
+#endif
+
+#if (HAL_I2C_TIMEOUT_LOOPS < 1) || (HAL_I2C_TIMEOUT_LOOPS > 65535)
+	#error "HAL_I2C_TIMEOUT_LOOPS must be between 1 and 65535"
+#endif
+
+typedef struct HAL_I2C_Transaction
+{
+	unsigned char addr;
+	const unsigned char* wbuf;
+	size_t wlen;
+	unsigned char* rbuf;
+	size_t rlen;
+	void (*callback)(struct HAL_I2C_Transaction* t);
+	void* ctx;
+	volatile uint8_t status;
+	struct HAL_I2C_Transaction* next;
+} HAL_I2C_Transaction_t;
+
+uint32_t HAL_I2C_InitController(uint32_t freq);
 void HAL_I2C_InitPeripheral(unsigned char addr);
 
-void HAL_I2C_SetFrequency(uint32_t freq);
+uint32_t HAL_I2C_SetFrequency(uint32_t freq);
 
 void HAL_I2C_ControllerSend(unsigned char addr, unsigned char data);
 void HAL_I2C_ControllerTransmit(unsigned char addr, unsigned char* buf, size_t len);
@@ -156,6 +385,23 @@ void HAL_I2C_ControllerTransmit(unsigned char addr, unsigned char* buf, size_t l
 unsigned char HAL_I2C_ControllerRead(unsigned char addr);
 void HAL_I2C_ControllerReceive(unsigned char addr, unsigned char* buf, size_t len);
 
+uint8_t HAL_I2C_ControllerWriteRead(unsigned char addr, const unsigned char* wbuf, size_t wlen, unsigned char* rbuf, size_t rlen);
+
+uint8_t HAL_I2C_WriteReg(unsigned char addr, unsigned char reg, unsigned char value);
+unsigned char HAL_I2C_ReadReg(unsigned char addr, unsigned char reg);
+uint8_t HAL_I2C_ReadRegs(unsigned char addr, unsigned char reg, unsigned char* buf, size_t len);
+uint8_t HAL_I2C_UpdateRegBits(unsigned char addr, unsigned char reg, unsigned char mask, unsigned char value);
+
+uint8_t HAL_I2C_Submit(HAL_I2C_Transaction_t* t);
+uint8_t HAL_I2C_Wait(HAL_I2C_Transaction_t* t);
+uint8_t HAL_I2C_IsBusy(void);
+void HAL_I2C_Abort(void);
+uint8_t HAL_I2C_GetLastStatus(void);
+
+uint8_t HAL_I2C_RecoverBus(void);
+uint8_t HAL_I2C_Probe(unsigned char addr);
+uint8_t HAL_I2C_Scan(unsigned char* found, uint8_t max);
+
 void HAL_I2C_PeripheralSend(unsigned char data);
 void HAL_I2C_PeripheralTransmit(unsigned char* buf, size_t len);
 
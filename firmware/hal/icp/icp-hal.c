@@ -0,0 +1,420 @@
+/*
+ * uc-Microlab — Input Capture HAL
+ * File: icp-hal.h / icp-hal.c
+ *
+ * Project: uc-MicroLab
+ * Component: Timer1 Input Capture Hardware Abstraction Layer (HAL)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Time measurement of external signals on the Timer1 input capture pin
+ *   ICP1 (PB0, Arduino D8). Timer1 runs free in normal mode; on every
+ *   selected edge the hardware latches the count into ICR1 and the ISR
+ *   extends it with the overflow count to a 32-bit time stamp, which is
+ *   queued in a ring buffer together with the edge direction. Helpers
+ *   turn the stamps into period, high time, frequency and duty cycle, and
+ *   compare the timer clock with a reference frequency such as the
+ *   32.768 kHz output of the DS3231 (DS3231_Enable32khz) to measure the
+ *   error of the MCU crystal.
+ *
+ * Public API:
+ *   void HAL_ICP_Init(uint8_t edge, uint8_t clk, uint8_t flags);
+ *     Configure PB0 as input and start Timer1 in normal mode with clock
+ *     selection clk (HAL_ICP_CK_*), capturing on edge
+ *     (HAL_ICP_EDGE_RISING, _FALLING or _BOTH). flags may contain
+ *     HAL_ICP_NOISE_CANCEL. Clears the capture queue and the counters.
+ *     Global interrupts must be enabled by the application.
+ *
+ *   void HAL_ICP_Stop(void);
+ *     Stop Timer1 and disable the capture and overflow interrupts.
+ *
+ *   uint8_t HAL_ICP_Available(void);
+ *     Number of captures waiting in the queue.
+ *
+ *   uint8_t HAL_ICP_Read(HAL_ICP_Capture_t* c);
+ *     Move the oldest capture into c. Returns 1, or 0 if the queue is empty.
+ *
+ *   uint8_t HAL_ICP_Measure(HAL_ICP_Measure_t* m);
+ *     Drain the queue and measure the newest complete cycle: two edges of
+ *     the same direction for the period, plus the edge in between for the
+ *     high time when capturing both edges. Returns 1 and fills m when a new
+ *     measurement is available, 0 otherwise (m untouched).
+ *
+ *   uint32_t HAL_ICP_Now(void);
+ *     Current 32-bit Timer1 time in ticks, on the scale of the stamps.
+ *
+ *   void HAL_ICP_Snapshot(uint32_t* count, uint32_t* stamp);
+ *     Read the number of edges captured since Init (queued or not) and the
+ *     stamp of the last one as a consistent pair. Two snapshots far apart
+ *     give an average period over many cycles without reading the queue.
+ *
+ *   uint32_t HAL_ICP_TicksToHz(uint32_t ticks);
+ *     Frequency in Hz (rounded) of a period of ticks timer ticks; 0 for an
+ *     external clock source or ticks = 0.
+ *
+ *   int32_t HAL_ICP_ClockError(uint32_t ticks, uint32_t periods, uint32_t ref_hz);
+ *     Error of the timer clock in ppm, measured as ticks ticks over periods
+ *     periods of a reference signal of exactly ref_hz Hz. Positive when the
+ *     MCU clock runs fast.
+ *
+ *   uint16_t HAL_ICP_GetOverruns(void);
+ *   void HAL_ICP_ClearOverruns(void);
+ *     Number of captures discarded because the queue was full.
+ *
+ * Public types:
+ *   HAL_ICP_Capture_t
+ *     uint32_t stamp  — capture time in timer ticks
+ *     uint8_t rising  — 1 for a rising edge, 0 for a falling edge
+ *
+ *   HAL_ICP_Measure_t
+ *     uint32_t period — ticks between two edges of the same direction
+ *     uint32_t high   — ticks the signal stayed high (0 unless _BOTH)
+ *     uint32_t freq   — frequency in Hz (HAL_ICP_TicksToHz of period)
+ *     uint16_t duty   — high time as a Q16 fraction of the period, the
+ *                       scale of HAL_PWM_SetDutyQ16 (0 unless _BOTH)
+ *
+ * Public constants:
+ *   HAL_ICP_EDGE_RISING, HAL_ICP_EDGE_FALLING, HAL_ICP_EDGE_BOTH
+ *   HAL_ICP_NOISE_CANCEL - require four equal samples before an edge
+ *   HAL_ICP_CK_1, HAL_ICP_CK_8, HAL_ICP_CK_64, HAL_ICP_CK_256,
+ *   HAL_ICP_CK_1024      - Timer1 prescaler (62.5 ns to 64 µs per tick at
+ *                          16 MHz)
+ *
+ * Configuration (compile-time, define before building icp-hal.c):
+ *   HAL_ICP_BUFFER_SIZE - capture queue length, power of two from 2 to 128
+ *                         (default 16).
+ *
+ * Usage:
+ *   - Include this header where signal measurement is required:
+ *       #include "icp-hal.h"
+ *
+ *   - Frequency and duty of a PWM signal on PB0:
+ *       HAL_ICP_Measure_t m;
+ *
+ *       HAL_ICP_Init(HAL_ICP_EDGE_BOTH, HAL_ICP_CK_8, HAL_ICP_NOISE_CANCEL);
+ *       sei();
+ *       if(HAL_ICP_Measure(&m)) printf("%lu Hz, %u\n", m.freq, m.duty);
+ *
+ *   - Crystal error against the DS3231 32 kHz output wired to PB0:
+ *       uint32_t n0, s0, n1, s1;
+ *
+ *       DS3231_Enable32khz();
+ *       HAL_ICP_Init(HAL_ICP_EDGE_RISING, HAL_ICP_CK_1, 0);
+ *       sei();
+ *       HAL_ICP_Snapshot(&n0, &s0);
+ *       _delay_ms(1000);
+ *       HAL_ICP_Snapshot(&n1, &s1);
+ *       ppm = HAL_ICP_ClockError(s1 - s0, n1 - n0, 32768UL);
+ *
+ * Notes:
+ *   - icp-hal.c owns Timer1, TIMER1_CAPT_vect and TIMER1_OVF_vect. It
+ *     cannot be linked together with pwm-hal built with
+ *     HAL_PWM_TIMER1_ISR=1 (e.g. for the RGB driver), and Timer1 PWM or
+ *     CTC outputs are not available while it runs.
+ *   - Stamps wrap every 2^32 ticks (about 268 s at HAL_ICP_CK_1); unsigned
+ *     differences of stamps stay correct across the wrap.
+ *   - A capture that coincides with a timer overflow is assigned to the
+ *     right side of the overflow by checking TOV1 against ICR1.
+ *   - With HAL_ICP_EDGE_BOTH the ISR flips the edge after each capture; a
+ *     pulse shorter than the ISR latency (about 5 µs) is lost. The noise
+ *     canceller delays every capture by four CPU clocks; all stamps move
+ *     alike, so the measured intervals are unaffected.
+ *   - HAL_ICP_Read and HAL_ICP_Measure both consume the queue; use one of
+ *     them. A 32 kHz reference captures every 31 µs, so use
+ *     HAL_ICP_Snapshot instead of the queue for it (overruns are expected).
+ *   - PB0 pull-up is not touched; the DS3231 32KHZ pin is open-drain and
+ *     needs a pull-up (the internal one is enough on short wires).
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for input capture HAL
+ *   2026-10-14  v0.2  Power management hooks (power-hal.h): a running capture holds
+ *                     IDLE on Timer1
+ *
+ */
+
+
+#include "icp-hal.h"
+
+#include <stddef.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "power-hal.h"
+
+#ifndef F_CPU
+	#define F_CPU 16000000UL
+#endif
+
+#define ICP_MASK (HAL_ICP_BUFFER_SIZE - 1U)
+
+/* Capture queue: written by the ISR at head, read at tail */
+static volatile HAL_ICP_Capture_t icp_buf[HAL_ICP_BUFFER_SIZE];
+static volatile uint8_t icp_head = 0;
+static volatile uint8_t icp_tail = 0;
+
+static volatile uint16_t icp_ovf = 0;
+static volatile uint32_t icp_count = 0;
+static volatile uint32_t icp_last = 0;
+static volatile uint16_t icp_overruns = 0;
+
+static uint8_t icp_both = 0;
+static uint32_t icp_tick_hz = 0;
+
+/* Newest captures seen by HAL_ICP_Measure, oldest first */
+static HAL_ICP_Capture_t icp_hist[3];
+static uint8_t icp_hist_n = 0;
+
+static uint8_t icp_measure(HAL_ICP_Measure_t* m);
+
+ISR(TIMER1_CAPT_vect)
+{
+	uint16_t icr = ICR1;
+	uint8_t rising = (TCCR1B & (1 << ICES1)) ? 1 : 0;
+	uint16_t high = icp_ovf;
+	uint32_t stamp;
+	
+	/* Overflow pending and a small capture: the capture came after it */
+	if((TIFR1 & (1 << TOV1)) && icr < 0x8000U) high++;
+	
+	if(icp_both)
+	{
+		/* Changing ICES1 may raise ICF1; clear it as the datasheet asks */
+		TCCR1B ^= (1 << ICES1);
+		TIFR1 = (1 << ICF1);
+	}
+	
+	stamp = ((uint32_t) high << 16) | icr;
+	
+	icp_count++;
+	icp_last = stamp;
+	
+	if((uint8_t) (icp_head - icp_tail) < HAL_ICP_BUFFER_SIZE)
+	{
+		icp_buf[icp_head & ICP_MASK].stamp  = stamp;
+		icp_buf[icp_head & ICP_MASK].rising = rising;
+		icp_head++;
+	}
+	else
+	{
+		if(icp_overruns != 0xFFFF) icp_overruns++;
+	}
+}
+
+ISR(TIMER1_OVF_vect)
+{
+	icp_ovf++;
+}
+
+void HAL_ICP_Init(uint8_t edge, uint8_t clk, uint8_t flags)
+{
+	static const uint8_t shift[6] = {0, 0, 3, 6, 8, 10};
+	
+	HAL_ICP_Stop();
+	
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER1);
+	HAL_PWR_HOLD(HAL_PWR_ID_TIMER1, HAL_PWR_IDLE);
+	
+	DDRB &= ~(1 << PB0);
+	
+	icp_tick_hz = (clk >= HAL_ICP_CK_1 && clk <= HAL_ICP_CK_1024) ? (F_CPU >> shift[clk]) : 0;
+	icp_both = (edge == HAL_ICP_EDGE_BOTH);
+	
+	icp_head = 0;
+	icp_tail = 0;
+	icp_ovf = 0;
+	icp_count = 0;
+	icp_last = 0;
+	icp_overruns = 0;
+	icp_hist_n = 0;
+	
+	TCCR1A = 0;
+	TCNT1 = 0;
+	
+	/* Normal mode (WGM13:10 = 0); BOTH starts on the rising edge */
+	TCCR1B = (edge == HAL_ICP_EDGE_FALLING) ? 0 : (1 << ICES1);
+	if(flags & HAL_ICP_NOISE_CANCEL) TCCR1B |= (1 << ICNC1);
+	
+	TIFR1 = (1 << ICF1) | (1 << TOV1);
+	TIMSK1 = (1 << ICIE1) | (1 << TOIE1);
+	
+	TCCR1B |= (clk & 0x07);
+}
+
+void HAL_ICP_Stop(void)
+{
+	TCCR1B = 0;
+	TIMSK1 = 0;
+	
+	HAL_PWR_DROP(HAL_PWR_ID_TIMER1);
+}
+
+uint8_t HAL_ICP_Available(void)
+{
+	uint8_t n;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) n = (uint8_t) (icp_head - icp_tail);
+	
+	return n;
+}
+
+uint8_t HAL_ICP_Read(HAL_ICP_Capture_t* c)
+{
+	uint8_t ok = 0;
+	
+	if(c == NULL) return 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(icp_head != icp_tail)
+		{
+			c->stamp  = icp_buf[icp_tail & ICP_MASK].stamp;
+			c->rising = icp_buf[icp_tail & ICP_MASK].rising;
+			icp_tail++;
+			ok = 1;
+		}
+	}
+	
+	return ok;
+}
+
+uint8_t HAL_ICP_Measure(HAL_ICP_Measure_t* m)
+{
+	HAL_ICP_Capture_t c;
+	uint8_t fresh = 0;
+	
+	if(m == NULL) return 0;
+	
+	while(HAL_ICP_Read(&c))
+	{
+		if(icp_hist_n == 3)
+		{
+			icp_hist[0] = icp_hist[1];
+			icp_hist[1] = icp_hist[2];
+			icp_hist_n = 2;
+		}
+		
+		icp_hist[icp_hist_n++] = c;
+		fresh = 1;
+	}
+	
+	return fresh ? icp_measure(m) : 0;
+}
+
+uint32_t HAL_ICP_Now(void)
+{
+	uint16_t high;
+	uint16_t low;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		low  = TCNT1;
+		high = icp_ovf;
+		
+		if((TIFR1 & (1 << TOV1)) && low < 0x8000U) high++;
+	}
+	
+	return ((uint32_t) high << 16) | low;
+}
+
+void HAL_ICP_Snapshot(uint32_t* count, uint32_t* stamp)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(count) *count = icp_count;
+		if(stamp) *stamp = icp_last;
+	}
+}
+
+uint32_t HAL_ICP_TicksToHz(uint32_t ticks)
+{
+	if(ticks == 0) return 0;
+	
+	return (icp_tick_hz + ticks / 2U) / ticks;
+}
+
+int32_t HAL_ICP_ClockError(uint32_t ticks, uint32_t periods, uint32_t ref_hz)
+{
+	/* ticks * ref_hz is the measured tick rate times periods */
+	int64_t nominal = (int64_t) icp_tick_hz * periods;
+	int64_t diff = (int64_t) ticks * ref_hz - nominal;
+	
+	if(nominal < 1000) return 0;
+	
+	return (int32_t) ((diff * 1000) / (nominal / 1000));
+}
+
+uint16_t HAL_ICP_GetOverruns(void)
+{
+	uint16_t n;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) n = icp_overruns;
+	
+	return n;
+}
+
+void HAL_ICP_ClearOverruns(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) icp_overruns = 0;
+}
+
+/*
+ * Measure the newest cycle in icp_hist. Single edge: period between the
+ * last two captures. Both edges: the last three captures must alternate
+ * (same direction at both ends); the high time is the half starting on
+ * the rising edge.
+ */
+static uint8_t icp_measure(HAL_ICP_Measure_t* m)
+{
+	const HAL_ICP_Capture_t* h = icp_hist;
+	uint32_t period;
+	uint32_t high = 0;
+	uint16_t duty = 0;
+	
+	if(icp_hist_n < 2) return 0;
+	
+	if(icp_both)
+	{
+		if(icp_hist_n < 3) return 0;
+		
+		if(h[0].rising != h[2].rising || h[0].rising == h[1].rising) return 0;
+		
+		period = h[2].stamp - h[0].stamp;
+		high = h[0].rising ? (h[1].stamp - h[0].stamp) : (h[2].stamp - h[1].stamp);
+		
+		if(period != 0)
+		{
+			uint32_t p = period;
+			uint32_t t = high;
+			
+			/* Scale to 16 bits so that t << 16 fits 32 bits */
+			while(p > 0xFFFFU)
+			{
+				p >>= 1;
+				t >>= 1;
+			}
+			
+			t = (t << 16) / p;
+			duty = (t > 0xFFFFU) ? 0xFFFFU : (uint16_t) t;
+		}
+	}
+	else
+	{
+		h = &icp_hist[icp_hist_n - 2U];
+		period = h[1].stamp - h[0].stamp;
+	}
+	
+	m->period = period;
+	m->high   = high;
+	m->freq   = HAL_ICP_TicksToHz(period);
+	m->duty   = duty;
+	
+	return 1;
+}
@@ -0,0 +1,199 @@
+/*
+ * uc-Microlab — Input Capture HAL
+ * File: icp-hal.h / icp-hal.c
+ *
+ * Project: uc-MicroLab
+ * Component: Timer1 Input Capture Hardware Abstraction Layer (HAL)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Time measurement of external signals on the Timer1 input capture pin
+ *   ICP1 (PB0, Arduino D8). Timer1 runs free in normal mode; on every
+ *   selected edge the hardware latches the count into ICR1 and the ISR
+ *   extends it with the overflow count to a 32-bit time stamp, which is
+ *   queued in a ring buffer together with the edge direction. Helpers
+ *   turn the stamps into period, high time, frequency and duty cycle, and
+ *   compare the timer clock with a reference frequency such as the
+ *   32.768 kHz output of the DS3231 (DS3231_Enable32khz) to measure the
+ *   error of the MCU crystal.
+ *
+ * Public API:
+ *   void HAL_ICP_Init(uint8_t edge, uint8_t clk, uint8_t flags);
+ *     Configure PB0 as input and start Timer1 in normal mode with clock
+ *     selection clk (HAL_ICP_CK_*), capturing on edge
+ *     (HAL_ICP_EDGE_RISING, _FALLING or _BOTH). flags may contain
+ *     HAL_ICP_NOISE_CANCEL. Clears the capture queue and the counters.
+ *     Global interrupts must be enabled by the application.
+ *
+ *   void HAL_ICP_Stop(void);
+ *     Stop Timer1 and disable the capture and overflow interrupts.
+ *
+ *   uint8_t HAL_ICP_Available(void);
+ *     Number of captures waiting in the queue.
+ *
+ *   uint8_t HAL_ICP_Read(HAL_ICP_Capture_t* c);
+ *     Move the oldest capture into c. Returns 1, or 0 if the queue is empty.
+ *
+ *   uint8_t HAL_ICP_Measure(HAL_ICP_Measure_t* m);
+ *     Drain the queue and measure the newest complete cycle: two edges of
+ *     the same direction for the period, plus the edge in between for the
+ *     high time when capturing both edges. Returns 1 and fills m when a new
+ *     measurement is available, 0 otherwise (m untouched).
+ *
+ *   uint32_t HAL_ICP_Now(void);
+ *     Current 32-bit Timer1 time in ticks, on the scale of the stamps.
+ *
+ *   void HAL_ICP_Snapshot(uint32_t* count, uint32_t* stamp);
+ *     Read the number of edges captured since Init (queued or not) and the
+ *     stamp of the last one as a consistent pair. Two snapshots far apart
+ *     give an average period over many cycles without reading the queue.
+ *
+ *   uint32_t HAL_ICP_TicksToHz(uint32_t ticks);
+ *     Frequency in Hz (rounded) of a period of ticks timer ticks; 0 for an
+ *     external clock source or ticks = 0.
+ *
+ *   int32_t HAL_ICP_ClockError(uint32_t ticks, uint32_t periods, uint32_t ref_hz);
+ *     Error of the timer clock in ppm, measured as ticks ticks over periods
+ *     periods of a reference signal of exactly ref_hz Hz. Positive when the
+ *     MCU clock runs fast.
+ *
+ *   uint16_t HAL_ICP_GetOverruns(void);
+ *   void HAL_ICP_ClearOverruns(void);
+ *     Number of captures discarded because the queue was full.
+ *
+ * Public types:
+ *   HAL_ICP_Capture_t
+ *     uint32_t stamp  — capture time in timer ticks
+ *     uint8_t rising  — 1 for a rising edge, 0 for a falling edge
+ *
+ *   HAL_ICP_Measure_t
+ *     uint32_t period — ticks between two edges of the same direction
+ *     uint32_t high   — ticks the signal stayed high (0 unless _BOTH)
+ *     uint32_t freq   — frequency in Hz (HAL_ICP_TicksToHz of period)
+ *     uint16_t duty   — high time as a Q16 fraction of the period, the
+ *                       scale of HAL_PWM_SetDutyQ16 (0 unless _BOTH)
+ *
+ * Public constants:
+ *   HAL_ICP_EDGE_RISING, HAL_ICP_EDGE_FALLING, HAL_ICP_EDGE_BOTH
+ *   HAL_ICP_NOISE_CANCEL - require four equal samples before an edge
+ *   HAL_ICP_CK_1, HAL_ICP_CK_8, HAL_ICP_CK_64, HAL_ICP_CK_256,
+ *   HAL_ICP_CK_1024      - Timer1 prescaler (62.5 ns to 64 µs per tick at
+ *                          16 MHz)
+ *
+ * Configuration (compile-time, define before building icp-hal.c):
+ *   HAL_ICP_BUFFER_SIZE - capture queue length, power of two from 2 to 128
+ *                         (default 16).
+ *
+ * Usage:
+ *   - Include this header where signal measurement is required:
+ *       #include "icp-hal.h"
+ *
+ *   - Frequency and duty of a PWM signal on PB0:
+ *       HAL_ICP_Measure_t m;
+ *
+ *       HAL_ICP_Init(HAL_ICP_EDGE_BOTH, HAL_ICP_CK_8, HAL_ICP_NOISE_CANCEL);
+ *       sei();
+ *       if(HAL_ICP_Measure(&m)) printf("%lu Hz, %u\n", m.freq, m.duty);
+ *
+ *   - Crystal error against the DS3231 32 kHz output wired to PB0:
+ *       uint32_t n0, s0, n1, s1;
+ *
+ *       DS3231_Enable32khz();
+ *       HAL_ICP_Init(HAL_ICP_EDGE_RISING, HAL_ICP_CK_1, 0);
+ *       sei();
+ *       HAL_ICP_Snapshot(&n0, &s0);
+ *       _delay_ms(1000);
+ *       HAL_ICP_Snapshot(&n1, &s1);
+ *       ppm = HAL_ICP_ClockError(s1 - s0, n1 - n0, 32768UL);
+ *
+ * Notes:
+ *   - icp-hal.c owns Timer1, TIMER1_CAPT_vect and TIMER1_OVF_vect. It
+ *     cannot be linked together with pwm-hal built with
+ *     HAL_PWM_TIMER1_ISR=1 (e.g. for the RGB driver), and Timer1 PWM or
+ *     CTC outputs are not available while it runs.
+ *   - Stamps wrap every 2^32 ticks (about 268 s at HAL_ICP_CK_1); unsigned
+ *     differences of stamps stay correct across the wrap.
+ *   - A capture that coincides with a timer overflow is assigned to the
+ *     right side of the overflow by checking TOV1 against ICR1.
+ *   - With HAL_ICP_EDGE_BOTH the ISR flips the edge after each capture; a
+ *     pulse shorter than the ISR latency (about 5 µs) is lost. The noise
+ *     canceller delays every capture by four CPU clocks; all stamps move
+ *     alike, so the measured intervals are unaffected.
+ *   - HAL_ICP_Read and HAL_ICP_Measure both consume the queue; use one of
+ *     them. A 32 kHz reference captures every 31 µs, so use
+ *     HAL_ICP_Snapshot instead of the queue for it (overruns are expected).
+ *   - PB0 pull-up is not touched; the DS3231 32KHZ pin is open-drain and
+ *     needs a pull-up (the internal one is enough on short wires).
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for input capture HAL
+ *   2026-10-14  v0.2  Power management hooks (power-hal.h): a running capture holds
+ *                     IDLE on Timer1
+ *
+ */
+
+#ifndef ICP_HAL_H_
+#define ICP_HAL_H_
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#define HAL_ICP_EDGE_RISING  0x01
+#define HAL_ICP_EDGE_FALLING 0x02
+#define HAL_ICP_EDGE_BOTH    0x03
+
+#define HAL_ICP_NOISE_CANCEL 0x01
+
+#define HAL_ICP_CK_1         0x01
+#define HAL_ICP_CK_8         0x02
+#define HAL_ICP_CK_64        0x03
+#define HAL_ICP_CK_256       0x04
+#define HAL_ICP_CK_1024      0x05
+
+#ifndef HAL_ICP_BUFFER_SIZE
+	#define HAL_ICP_BUFFER_SIZE 16U
+#endif
+
+#if (HAL_ICP_BUFFER_SIZE < 2) || (HAL_ICP_BUFFER_SIZE > 128) || (HAL_ICP_BUFFER_SIZE & (HAL_ICP_BUFFER_SIZE - 1))
+	#error "HAL_ICP_BUFFER_SIZE must be a power of two between 2 and 128"
+#endif
+
+typedef struct
+{
+	uint32_t stamp;
+	uint8_t rising;
+} HAL_ICP_Capture_t;
+
+typedef struct
+{
+	uint32_t period;
+	uint32_t high;
+	uint32_t freq;
+	uint16_t duty;
+} HAL_ICP_Measure_t;
+
+void HAL_ICP_Init(uint8_t edge, uint8_t clk, uint8_t flags);
+void HAL_ICP_Stop(void);
+
+uint8_t HAL_ICP_Available(void);
+uint8_t HAL_ICP_Read(HAL_ICP_Capture_t* c);
+uint8_t HAL_ICP_Measure(HAL_ICP_Measure_t* m);
+
+uint32_t HAL_ICP_Now(void);
+void HAL_ICP_Snapshot(uint32_t* count, uint32_t* stamp);
+
+uint32_t HAL_ICP_TicksToHz(uint32_t ticks);
+int32_t HAL_ICP_ClockError(uint32_t ticks, uint32_t periods, uint32_t ref_hz);
+
+uint16_t HAL_ICP_GetOverruns(void);
+void HAL_ICP_ClearOverruns(void);
+
+#endif /* ICP_HAL_H_ */
@@ -1,10 +1,10 @@
 /*
- * uc-Microlab — PORT HAL 
+ * uc-Microlab — PORT HAL
  * File: port-hal.h / port-hal.c
  *
  * Project: uc-MicroLab
  * Component: PORT Hardware Abstraction Layer (HAL)
- * Hardware: uc-MicroLab board — version r1 (AVR/ATmega) and other platforms
+ * Hardware: uc-MicroLab board — version r1 
  *
  * Description:
  *   Minimal, portable digital port/pin HAL for small microcontroller projects.
@@ -30,6 +30,58 @@
  *                               unsigned char pin);
  *     Read the logical level of a pin (returns 0 or 1).
  *
+ *   void HAL_Port_SetModeMask(volatile unsigned char* port,
+ *                             volatile unsigned char* ddr,
+ *                             unsigned char mask,
+ *                             unsigned char mode,
+ *                             unsigned char pull_up);
+ *     HAL_Port_SetMode for every pin set in mask, one store per register.
+ *
+ *   void HAL_Port_WriteMask(volatile unsigned char* port,
+ *                           unsigned char mask,
+ *                           unsigned char value);
+ *     Drive the pins in mask to the matching bits of value with a single
+ *     store; the other pins keep their level. Not interrupt-safe (see
+ *     HAL_Port_WriteMaskAtomic).
+ *
+ *   void HAL_Port_WriteMaskAtomic(volatile unsigned char* port,
+ *                                 unsigned char mask,
+ *                                 unsigned char value);
+ *     HAL_Port_WriteMask with interrupts disabled around the
+ *     read-modify-write, for ports that interrupt handlers also write.
+ *
+ *   unsigned char HAL_Port_ReadMask(volatile unsigned char* pinx,
+ *                                   unsigned char mask);
+ *     Read the pins in mask in one access (other bits return 0).
+ *
+ *   void HAL_Port_Toggle(volatile unsigned char* pinx, unsigned char mask);
+ *     Invert the output pins in mask by writing mask to PINx. A single
+ *     store, atomic by construction.
+ *
+ * Compile-time pin API (header only, no port-hal.c needed):
+ *   HAL_PIN_OUTPUT(P, n)      - make pin n of port P an output (DDRx)
+ *   HAL_PIN_INPUT(P, n)       - make pin n of port P an input
+ *   HAL_PIN_PULLUP(P, n)      - enable the pull-up of input pin n
+ *   HAL_PIN_SET(P, n)         - drive pin n high (PORTx)
+ *   HAL_PIN_CLEAR(P, n)       - drive pin n low
+ *   HAL_PIN_WRITE(P, n, v)    - drive pin n high if v is non-zero, else low
+ *   HAL_PIN_TOGGLE(P, n)      - invert output pin n by writing 1 to PINx
+ *   HAL_PIN_READ(P, n)        - level of pin n (0 or 1), from PINx
+ *     P is the port letter (B, C or D) and n the bit number; both must be
+ *     compile-time constants. A pin can be named once as a descriptor,
+ *     #define LED_PIN B, 5, and passed as HAL_PIN_SET(LED_PIN). With
+ *     constant arguments avr-gcc emits a single sbi / cbi instruction (2
+ *     cycles, atomic) for SET, CLEAR, OUTPUT and INPUT, a single out for
+ *     TOGGLE, and sbis / sbic when READ is used in a condition.
+ *
+ *   C++ builds additionally get HAL_Pin<pin_addr, bit> with the static
+ *   members output(), input(), pullup(), set(), clear(), write(v),
+ *   toggle() and read(), and the aliases HAL_PinB<bit>, HAL_PinC<bit>,
+ *   HAL_PinD<bit>:
+ *       typedef HAL_PinB<5> Led;
+ *       Led::output();
+ *       Led::toggle();
+ *
  * Public constants:
  *   HAL_PORT_INPUT        - configure pin as input
  *   HAL_PORT_OUTPUT       - configure pin as output
@@ -37,6 +89,8 @@
  *   HAL_PORT_EN_PULLUP    - enable internal pull-up
  *   HAL_PORT_LEVEL_LOW    - logical low (0)
  *   HAL_PORT_LEVEL_HIGH   - logical high (1)
+ *   HAL_PORT_ADDR_B/C/D   - data-space address of PINx (PINx, DDRx and PORTx
+ *                           are consecutive on ATmega328P)
  *
  * Usage:
  *   - Include this header where GPIO access is required:
@@ -45,6 +99,13 @@
  *       HAL_Port_SetMode(&PORTB, &DDRB, PB0, HAL_PORT_OUTPUT, HAL_PORT_DIS_PULLUP);
  *       HAL_Port_Write(&PORTB, PB0, HAL_PORT_LEVEL_HIGH);
  *       unsigned char v = HAL_Port_Read(&PINB, PB0);
+ *   - Drive an 8-bit parallel bus on PORTD and a strobe on PB0:
+ *       HAL_Port_SetModeMask(&PORTD, &DDRD, 0xFF, HAL_PORT_OUTPUT, HAL_PORT_DIS_PULLUP);
+ *       HAL_Port_WriteMask(&PORTD, 0xFF, byte);
+ *       HAL_Port_Toggle(&PINB, (1 << PB0));
+ *   - Update two control lines of PORTB together while a timer ISR also
+ *     writes PORTB:
+ *       HAL_Port_WriteMaskAtomic(&PORTB, (1 << PB1) | (1 << PB2), (1 << PB1));
  *   - Implementations should ensure proper access to hardware registers and
  *     consider atomic operations (disable interrupts) when modifying shared
  *     port registers in interrupt-driven contexts.
@@ -55,6 +116,17 @@
  *   - This header intentionally avoids heavy dependencies to remain portable.
  *     Platform-specific implementations may provide more efficient inline
  *     versions or optimizations.
+ *   - HAL_Port_* take the register and pin at run time (about 10 cycles per
+ *     call plus the call itself); use them where the pin is a parameter,
+ *     e.g. a chip select passed to a driver. Use HAL_PIN_* for fixed pins
+ *     and bit-banged signals.
+ *   - HAL_Port_Write and HAL_Port_WriteMask read, modify and write PORTx; an
+ *     interrupt that writes the same port in between is undone. Use
+ *     HAL_Port_WriteMaskAtomic (or HAL_PIN_SET / HAL_PIN_CLEAR, which are
+ *     single instructions) for ports shared with interrupt handlers.
+ *   - HAL_PIN_TOGGLE relies on the PINx write-one-to-toggle feature and
+ *     only touches the selected pin, so it is safe against interrupts that
+ *     modify other pins of the same port.
  *
  * Author: otavioacb
  * Created: 2025-11-02
@@ -66,11 +138,16 @@
  *
  * Change log:
  *   2025-11-02  v0.1  Initial header for PORT HAL
+ *   2026-10-14  v0.2  Added compile-time pin API (HAL_PIN_* macros, C++ HAL_Pin template)
+ *   2026-10-14  v0.3  Added mask operations: HAL_Port_SetModeMask, HAL_Port_WriteMask,
+ *                     HAL_Port_WriteMaskAtomic, HAL_Port_ReadMask, HAL_Port_Toggle
  *
  */
 
 #include "port-hal.h"
 
+#include <util/atomic.h>
+
 void HAL_Port_SetMode(volatile unsigned char* port, volatile unsigned char* ddr, unsigned char pin, unsigned char mode, unsigned char pull_up)
 {
 	if(mode == HAL_PORT_INPUT)
@@ -99,3 +176,39 @@ unsigned char HAL_Port_Read(volatile unsigned char* pinx, unsigned char pin)
 
 }
 
+void HAL_Port_SetModeMask(volatile unsigned char* port, volatile unsigned char* ddr, unsigned char mask, unsigned char mode, unsigned char pull_up)
+{
+	if(mode == HAL_PORT_INPUT)
+	{
+		*ddr  &= ~mask;
+		*port =   (pull_up == HAL_PORT_EN_PULLUP) ? (*port | mask) : (*port & ~mask);
+		return;
+	}
+	
+	if(mode == HAL_PORT_OUTPUT)
+	{
+		*port &= ~mask;
+		*ddr  |=  mask;
+		return;
+	}
+}
+
+void HAL_Port_WriteMask(volatile unsigned char* port, unsigned char mask, unsigned char value)
+{
+	*port = (*port & ~mask) | (value & mask);
+}
+
+void HAL_Port_WriteMaskAtomic(volatile unsigned char* port, unsigned char mask, unsigned char value)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) *port = (*port & ~mask) | (value & mask);
+}
+
+unsigned char HAL_Port_ReadMask(volatile unsigned char* pinx, unsigned char mask)
+{
+	return *pinx & mask;
+}
+
+void HAL_Port_Toggle(volatile unsigned char* pinx, unsigned char mask)
+{
+	*pinx = mask;
+}
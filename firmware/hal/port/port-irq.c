@@ -0,0 +1,268 @@
+/*
+ * uc-Microlab — PORT HAL interrupt dispatcher
+ * File: port-irq.h / port-irq.c
+ *
+ * Project: uc-MicroLab
+ * Component: PORT Hardware Abstraction Layer (HAL) — pin interrupts
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Event delivery for input pins, as an alternative to polling
+ *   HAL_Port_Read. A callback is registered per pin with the edges of
+ *   interest. PD2 and PD3 use the external interrupts INT0 / INT1 with
+ *   hardware edge detection; every other pin (and PD2/PD3 on request) uses
+ *   its pin-change group PCINT0..2, whose ISR finds the pins that changed
+ *   by comparing the port with the last snapshot and filters the edges in
+ *   software. Each event can carry a time stamp from an application clock
+ *   such as the scheduler tick.
+ *
+ * Public API:
+ *   uint8_t HAL_Port_Attach(volatile unsigned char* pinx,
+ *                           unsigned char pin,
+ *                           uint8_t edge,
+ *                           void (*callback)(unsigned char level, uint32_t stamp));
+ *     Call callback from interrupt context on the selected edges of pin pin
+ *     of the port whose input register is pinx (&PINB, &PINC or &PIND).
+ *     edge is HAL_PORT_EDGE_RISING, _FALLING or _BOTH, optionally ORed
+ *     with HAL_PORT_IRQ_PCINT to use the pin-change interrupt on PD2/PD3.
+ *     callback receives the pin level after the edge and the time stamp.
+ *     Replaces an earlier registration of the same pin. Returns 1 on
+ *     success, 0 for an invalid pin, edge or a NULL callback.
+ *
+ *   void HAL_Port_Detach(volatile unsigned char* pinx, unsigned char pin);
+ *     Remove the callback of a pin and disable its interrupt source.
+ *
+ *   void HAL_Port_SetTimeSource(uint32_t (*now)(void));
+ *     Select the clock used to time-stamp events (e.g. SCHED_Millis or
+ *     SCHED_Micros). NULL (default) stamps every event with 0.
+ *
+ * Public constants:
+ *   HAL_PORT_EDGE_RISING  - low-to-high transitions
+ *   HAL_PORT_EDGE_FALLING - high-to-low transitions
+ *   HAL_PORT_EDGE_BOTH    - every transition
+ *   HAL_PORT_IRQ_PCINT    - flag: use PCINT on PD2/PD3 instead of INT0/INT1
+ *
+ * Usage:
+ *   - Include this header where pin events are required:
+ *       #include "port-irq.h"
+ *
+ *   - A push button on PB0 (to ground) and the time of each press:
+ *       static void on_button(unsigned char level, uint32_t stamp)
+ *       {
+ *           pressed_at = stamp;
+ *           SCHED_Signal(TASK_BUTTON);
+ *       }
+ *
+ *       HAL_Port_SetMode(&PORTB, &DDRB, PB0, HAL_PORT_INPUT, HAL_PORT_EN_PULLUP);
+ *       HAL_Port_SetTimeSource(SCHED_Millis);
+ *       HAL_Port_Attach(&PINB, PB0, HAL_PORT_EDGE_FALLING, on_button);
+ *       sei();
+ *
+ * Notes:
+ *   - Linking port-irq.c gives it ownership of INT0_vect, INT1_vect,
+ *     PCINT0_vect, PCINT1_vect and PCINT2_vect; the application must not
+ *     define these vectors. port-hal.c alone installs no interrupt.
+ *   - Pin direction and pull-ups are not touched; configure the pin as an
+ *     input with HAL_Port_SetMode first.
+ *   - A pin-change group reads its port once at the start of the ISR. A
+ *     pulse shorter than the ISR latency (a few µs) can be missed, and
+ *     several pins changing together are delivered in bit order with the
+ *     same time stamp. Debounce mechanical contacts in the callback or in
+ *     the task it signals.
+ *   - Any pin-change interrupt wakes the MCU from every sleep mode, while
+ *     INT0/INT1 edges need the I/O clock (idle mode). Add
+ *     HAL_PORT_IRQ_PCINT for PD2/PD3 to wake from power-down on an edge.
+ *   - Callbacks run in interrupt context; keep them short.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for PORT HAL interrupt dispatcher
+ *
+ */
+
+#include "port-irq.h"
+
+#include <stddef.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#define IRQ_GROUPS 3U
+
+/*
+ * One callback per pin, index group * 8 + bit (group 0 = PORTB, 1 = PORTC,
+ * 2 = PORTD). The rise / fall masks select the edges delivered for the
+ * pin-change groups and irq_last holds the port as seen by the last ISR.
+ * irq_ext flags PD2 / PD3 served by INT0 / INT1 (bit 0 / bit 1).
+ */
+static void (*irq_callback[IRQ_GROUPS * 8U])(unsigned char level, uint32_t stamp);
+static uint8_t irq_rise[IRQ_GROUPS];
+static uint8_t irq_fall[IRQ_GROUPS];
+static uint8_t irq_last[IRQ_GROUPS];
+static uint8_t irq_ext = 0;
+
+static uint32_t (*irq_now)(void) = NULL;
+
+static uint8_t irq_group(volatile unsigned char* pinx);
+static volatile uint8_t* irq_pcmsk(uint8_t group);
+static void irq_pcint(uint8_t group, uint8_t level);
+static void irq_extint(uint8_t n);
+
+ISR(INT0_vect)
+{
+	irq_extint(0);
+}
+
+ISR(INT1_vect)
+{
+	irq_extint(1);
+}
+
+ISR(PCINT0_vect)
+{
+	irq_pcint(0, PINB);
+}
+
+ISR(PCINT1_vect)
+{
+	irq_pcint(1, PINC);
+}
+
+ISR(PCINT2_vect)
+{
+	irq_pcint(2, PIND);
+}
+
+uint8_t HAL_Port_Attach(volatile unsigned char* pinx, unsigned char pin, uint8_t edge, void (*callback)(unsigned char level, uint32_t stamp))
+{
+	uint8_t group = irq_group(pinx);
+	uint8_t sense = edge & HAL_PORT_EDGE_BOTH;
+	uint8_t bit;
+	
+	if(group >= IRQ_GROUPS || pin > 7 || sense == 0 || callback == NULL) return 0;
+	if(group == 1 && pin == 7) return 0;   /* PC7 does not exist */
+	
+	HAL_Port_Detach(pinx, pin);
+	
+	bit = (uint8_t) (1 << pin);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		irq_callback[group * 8U + pin] = callback;
+		
+		if(group == 2 && (pin == PD2 || pin == PD3) && !(edge & HAL_PORT_IRQ_PCINT))
+		{
+			uint8_t n = pin - PD2;
+			
+			/* ISCn1:0 = 01 any change, 10 falling, 11 rising */
+			uint8_t isc = (sense == HAL_PORT_EDGE_BOTH) ? 0x01 : (sense == HAL_PORT_EDGE_FALLING) ? 0x02 : 0x03;
+			
+			EICRA = (EICRA & ~(0x03 << (2 * n))) | (isc << (2 * n));
+			EIFR  = (1 << n);
+			EIMSK |= (1 << n);
+			
+			irq_ext |= (1 << n);
+		}
+		else
+		{
+			if(sense & HAL_PORT_EDGE_RISING)  irq_rise[group] |= bit;
+			if(sense & HAL_PORT_EDGE_FALLING) irq_fall[group] |= bit;
+			
+			irq_last[group] = (irq_last[group] & ~bit) | (*pinx & bit);
+			
+			*irq_pcmsk(group) |= bit;
+			PCIFR = (1 << group);
+			PCICR |= (1 << group);
+		}
+	}
+	
+	return 1;
+}
+
+void HAL_Port_Detach(volatile unsigned char* pinx, unsigned char pin)
+{
+	uint8_t group = irq_group(pinx);
+	
+	if(group >= IRQ_GROUPS || pin > 7) return;
+	
+	uint8_t bit = (uint8_t) (1 << pin);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if(group == 2 && (pin == PD2 || pin == PD3) && (irq_ext & (1 << (pin - PD2))))
+		{
+			EIMSK   &= ~(1 << (pin - PD2));
+			irq_ext &= ~(1 << (pin - PD2));
+		}
+		
+		volatile uint8_t* pcmsk = irq_pcmsk(group);
+		
+		*pcmsk &= ~bit;
+		if(*pcmsk == 0) PCICR &= ~(1 << group);
+		
+		irq_rise[group] &= ~bit;
+		irq_fall[group] &= ~bit;
+		
+		irq_callback[group * 8U + pin] = NULL;
+	}
+}
+
+void HAL_Port_SetTimeSource(uint32_t (*now)(void))
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) irq_now = now;
+}
+
+static uint8_t irq_group(volatile unsigned char* pinx)
+{
+	if(pinx == &PINB) return 0;
+	if(pinx == &PINC) return 1;
+	if(pinx == &PIND) return 2;
+	
+	return IRQ_GROUPS;
+}
+
+static volatile uint8_t* irq_pcmsk(uint8_t group)
+{
+	if(group == 0) return &PCMSK0;
+	if(group == 1) return &PCMSK1;
+	
+	return &PCMSK2;
+}
+
+/*
+ * Deliver the edges of a pin-change group: level is the port read at ISR
+ * entry, the pins that differ from the previous snapshot changed.
+ */
+static void irq_pcint(uint8_t group, uint8_t level)
+{
+	uint8_t changed = (level ^ irq_last[group]) & *irq_pcmsk(group);
+	uint8_t fire    = (changed & level & irq_rise[group]) | (changed & ~level & irq_fall[group]);
+	uint32_t stamp  = 0;
+	
+	irq_last[group] = level;
+	
+	if(fire == 0) return;
+	
+	if(irq_now) stamp = irq_now();
+	
+	for(uint8_t pin = 0; fire; ++pin, fire >>= 1)
+	{
+		void (*callback)(unsigned char, uint32_t) = irq_callback[group * 8U + pin];
+		
+		if((fire & 1) && callback) callback((level >> pin) & 1, stamp);
+	}
+}
+
+static void irq_extint(uint8_t n)
+{
+	uint8_t level = (PIND >> (PD2 + n)) & 1;
+	void (*callback)(unsigned char, uint32_t) = irq_callback[2U * 8U + PD2 + n];
+	
+	if(callback) callback(level, irq_now ? irq_now() : 0);
+}
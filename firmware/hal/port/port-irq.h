@@ -0,0 +1,116 @@
+/*
+ * uc-Microlab — PORT HAL interrupt dispatcher
+ * File: port-irq.h / port-irq.c
+ *
+ * Project: uc-MicroLab
+ * Component: PORT Hardware Abstraction Layer (HAL) — pin interrupts
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Event delivery for input pins, as an alternative to polling
+ *   HAL_Port_Read. A callback is registered per pin with the edges of
+ *   interest. PD2 and PD3 use the external interrupts INT0 / INT1 with
+ *   hardware edge detection; every other pin (and PD2/PD3 on request) uses
+ *   its pin-change group PCINT0..2, whose ISR finds the pins that changed
+ *   by comparing the port with the last snapshot and filters the edges in
+ *   software. Each event can carry a time stamp from an application clock
+ *   such as the scheduler tick.
+ *
+ * Public API:
+ *   uint8_t HAL_Port_Attach(volatile unsigned char* pinx,
+ *                           unsigned char pin,
+ *                           uint8_t edge,
+ *                           void (*callback)(unsigned char level, uint32_t stamp));
+ *     Call callback from interrupt context on the selected edges of pin pin
+ *     of the port whose input register is pinx (&PINB, &PINC or &PIND).
+ *     edge is HAL_PORT_EDGE_RISING, _FALLING or _BOTH, optionally ORed
+ *     with HAL_PORT_IRQ_PCINT to use the pin-change interrupt on PD2/PD3.
+ *     callback receives the pin level after the edge and the time stamp.
+ *     Replaces an earlier registration of the same pin. Returns 1 on
+ *     success, 0 for an invalid pin, edge or a NULL callback.
+ *
+ *   void HAL_Port_Detach(volatile unsigned char* pinx, unsigned char pin);
+ *     Remove the callback of a pin and disable its interrupt source.
+ *
+ *   void HAL_Port_SetTimeSource(uint32_t (*now)(void));
+ *     Select the clock used to time-stamp events (e.g. SCHED_Millis or
+ *     SCHED_Micros). NULL (default) stamps every event with 0.
+ *
+ * Public constants:
+ *   HAL_PORT_EDGE_RISING  - low-to-high transitions
+ *   HAL_PORT_EDGE_FALLING - high-to-low transitions
+ *   HAL_PORT_EDGE_BOTH    - every transition
+ *   HAL_PORT_IRQ_PCINT    - flag: use PCINT on PD2/PD3 instead of INT0/INT1
+ *
+ * Usage:
+ *   - Include this header where pin events are required:
+ *       #include "port-irq.h"
+ *
+ *   - A push button on PB0 (to ground) and the time of each press:
+ *       static void on_button(unsigned char level, uint32_t stamp)
+ *       {
+ *           pressed_at = stamp;
+ *           SCHED_Signal(TASK_BUTTON);
+ *       }
+ *
+ *       HAL_Port_SetMode(&PORTB, &DDRB, PB0, HAL_PORT_INPUT, HAL_PORT_EN_PULLUP);
+ *       HAL_Port_SetTimeSource(SCHED_Millis);
+ *       HAL_Port_Attach(&PINB, PB0, HAL_PORT_EDGE_FALLING, on_button);
+ *       sei();
+ *
+ * Notes:
+ *   - Linking port-irq.c gives it ownership of INT0_vect, INT1_vect,
+ *     PCINT0_vect, PCINT1_vect and PCINT2_vect; the application must not
+ *     define these vectors. port-hal.c alone installs no interrupt.
+ *   - Pin direction and pull-ups are not touched; configure the pin as an
+ *     input with HAL_Port_SetMode first.
+ *   - A pin-change group reads its port once at the start of the ISR. A
+ *     pulse shorter than the ISR latency (a few µs) can be missed, and
+ *     several pins changing together are delivered in bit order with the
+ *     same time stamp. Debounce mechanical contacts in the callback or in
+ *     the task it signals.
+ *   - Any pin-change interrupt wakes the MCU from every sleep mode, while
+ *     INT0/INT1 edges need the I/O clock (idle mode). Add
+ *     HAL_PORT_IRQ_PCINT for PD2/PD3 to wake from power-down on an edge.
+ *   - Callbacks run in interrupt context; keep them short.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for PORT HAL interrupt dispatcher
+ *
+ */
+
+#ifndef PORT_IRQ_H_
+#define PORT_IRQ_H_
+
+#include <avr/io.h>
+#include <stdint.h>
+#include "port-hal.h"
+
+#define HAL_PORT_EDGE_RISING  0x01
+#define HAL_PORT_EDGE_FALLING 0x02
+#define HAL_PORT_EDGE_BOTH    0x03
+
+#define HAL_PORT_IRQ_PCINT    0x80
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t HAL_Port_Attach(volatile unsigned char* pinx, unsigned char pin, uint8_t edge, void (*callback)(unsigned char level, uint32_t stamp));
+void HAL_Port_Detach(volatile unsigned char* pinx, unsigned char pin);
+
+void HAL_Port_SetTimeSource(uint32_t (*now)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORT_IRQ_H_ */
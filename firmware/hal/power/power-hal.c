@@ -0,0 +1,245 @@
+/*
+ * uc-Microlab — Power Management HAL
+ * File: power-hal.h / power-hal.c
+ *
+ * Project: uc-MicroLab
+ * Component: Sleep mode and peripheral clock Hardware Abstraction Layer (HAL)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Chooses the deepest sleep mode that every active driver tolerates.
+ *   Each user (a HAL with a transfer in flight, a timer that must keep
+ *   counting, the application) holds a limit: the deepest mode it can
+ *   survive. HAL_PWR_Sleep enters the shallowest of the limits held, so
+ *   the MCU drops to power-down as soon as the last UART byte has left,
+ *   the I2C/SPI queues are empty and no timer needs the I/O clock. The
+ *   clocks of unused peripherals are gated through PRR.
+ *
+ *   The HALs register themselves through the HAL_PWR_HOLD / HAL_PWR_DROP
+ *   and HAL_PWR_CLOCK_ON macros below, which compile to nothing unless the
+ *   project is built with HAL_PWR_USE = 1:
+ *     - uart-hal (ISR mode): IDLE from the first queued byte until the
+ *       transmitter is empty (TXC).
+ *     - spi-hal, i2c-hal: IDLE while asynchronous transactions are queued.
+ *     - adc-hal: ADC noise reduction while a conversion or auto-trigger
+ *       runs.
+ *     - eeprom-hal: ADC noise reduction while the write queue is not
+ *       empty (EE_READY wakes from that mode).
+ *     - sched: IDLE while a periodic task is enabled (Timer0 tick).
+ *     - icp-hal, ds3231-clock (sub-second tick): IDLE on their timer.
+ *     - Init functions of UART, SPI, TWI, ADC and timers switch their
+ *       peripheral clock back on after HAL_PWR_Init gated it off.
+ *
+ * Public API:
+ *   void HAL_PWR_Init(void);
+ *     Gate the clock of every peripheral in PRR, switch the ADC and the
+ *     analog comparator off and release every limit. Call it first; the
+ *     HAL Init functions called afterwards re-enable their own clocks.
+ *
+ *   void HAL_PWR_SetLimit(uint8_t id, uint8_t mode);
+ *     Set the deepest sleep mode user id (HAL_PWR_ID_*) tolerates.
+ *     HAL_PWR_DOWN releases the limit. Safe from interrupt context.
+ *
+ *   uint8_t HAL_PWR_GetMode(void);
+ *     Deepest mode allowed by the limits held now (capped by
+ *     HAL_PWR_MAX_MODE).
+ *
+ *   void HAL_PWR_Sleep(void);
+ *     Sleep in HAL_PWR_GetMode until an interrupt wakes the MCU.
+ *
+ *   void HAL_PWR_SleepLocked(void);
+ *     Same, for callers that checked for pending work with interrupts
+ *     disabled: must be entered with interrupts disabled and returns with
+ *     them enabled. sei is executed right before sleep, so an interrupt
+ *     that arrives after the check still wakes the MCU.
+ *
+ *   void HAL_PWR_ClockOn(uint8_t mask);
+ *   void HAL_PWR_ClockOff(uint8_t mask);
+ *     Enable / gate the clocks of the peripherals in mask (HAL_PWR_CLK_*).
+ *     Gating the ADC clock also disables the ADC.
+ *
+ * Public constants:
+ *   - Sleep modes, shallowest first:
+ *       HAL_PWR_IDLE   - CPU stopped, every peripheral running
+ *       HAL_PWR_ADC_NR - ADC noise reduction: I/O clock stopped; ADC,
+ *                        EEPROM, TWI address match, Timer2 (async) and
+ *                        external interrupts still work
+ *       HAL_PWR_SAVE   - power-save: only Timer2 (async), TWI address
+ *                        match, pin changes, INT0/1 and the watchdog
+ *       HAL_PWR_DOWN   - power-down: as power-save without Timer2
+ *
+ *   - Users: HAL_PWR_ID_UART, _SPI, _I2C, _ADC, _EEPROM, _TIMER0,
+ *            _TIMER1, _TIMER2, _APP (free for the application)
+ *
+ *   - Clocks: HAL_PWR_CLK_TWI, _TIMER2, _TIMER0, _TIMER1, _SPI, _UART,
+ *             _ADC, HAL_PWR_CLK_ALL
+ *
+ * Configuration (compile-time, define for every source of the project):
+ *   HAL_PWR_USE      - 1 links the HALs to this module (link power-hal.c);
+ *                      0 (default) turns the hooks into no-ops.
+ *   HAL_PWR_MAX_MODE - deepest mode ever used (default HAL_PWR_DOWN); set
+ *                      HAL_PWR_IDLE while debugging.
+ *   HAL_PWR_BOD_OFF  - 1 (default) disables the brown-out detector during
+ *                      power-save / power-down (BODS), saving about 20 µA.
+ *
+ * Usage:
+ *   - Include this header where sleep control is required:
+ *       #include "power-hal.h"
+ *
+ *   - Battery logger woken once a minute by the DS3231 alarm on PD2:
+ *       static volatile uint8_t alarm = 0;
+ *
+ *       static void on_alarm(unsigned char level, uint32_t stamp)
+ *       {
+ *           alarm = 1;
+ *       }
+ *
+ *       HAL_PWR_Init();
+ *       HAL_I2C_InitController(100000UL);
+ *       DS3231_SetAlarm1(&t, DS3231_ALM1_MTC_SECS);
+ *       HAL_Port_Attach(&PIND, PD2, HAL_PORT_EDGE_FALLING | HAL_PORT_IRQ_PCINT, on_alarm);
+ *       sei();
+ *
+ *       while(1)
+ *       {
+ *           cli();
+ *           if(!alarm) HAL_PWR_SleepLocked();     // power-down
+ *           else sei();
+ *
+ *           if(alarm)
+ *           {
+ *               alarm = 0;
+ *               log_sample();
+ *               HAL_I2C_UpdateRegBits(DS3231_ADDR, DS3231_REG_STATUS, DS3231_STAT_A1F, 0);
+ *           }
+ *       }
+ *
+ *   - With the scheduler, SCHED_Idle sleeps through HAL_PWR_SleepLocked;
+ *     suspend the periodic tasks and signal event tasks from the wake-up
+ *     interrupts to reach power-down.
+ *
+ * Notes:
+ *   - Only pin-change interrupts, INT0/INT1 low level, the TWI address
+ *     match and the watchdog wake from power-down; attach wake-up pins
+ *     with HAL_PORT_IRQ_PCINT (port-irq.h). The DS3231 INT/SQW output
+ *     must be in alarm mode (INTCN = 1), not square wave.
+ *   - Timer0 stops in every mode below IDLE, so SCHED_Millis does not
+ *     advance during deep sleep.
+ *   - Entering ADC noise reduction with the ADC enabled starts a
+ *     conversion. HAL_PWR_Sleep therefore uses IDLE instead when the ADC
+ *     is enabled but holds no limit.
+ *   - PWM and CTC outputs keep running only in IDLE; their HALs do not
+ *     hold a limit, so an application using them sets one itself, e.g.
+ *     HAL_PWR_SetLimit(HAL_PWR_ID_TIMER1, HAL_PWR_IDLE).
+ *   - UART reception needs the I/O clock: bytes arriving during deep
+ *     sleep are lost. Blocking transfers (HAL_UART_USE_ISR = 0) hold no
+ *     limit; wait for TXC0 before sleeping after the last byte.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for power management HAL
+ *
+ */
+
+
+#include "power-hal.h"
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+
+/* Deepest tolerated mode per user; HAL_PWR_DOWN means no limit */
+static volatile uint8_t pwr_limit[HAL_PWR_IDS] =
+{
+	HAL_PWR_DOWN, HAL_PWR_DOWN, HAL_PWR_DOWN, HAL_PWR_DOWN, HAL_PWR_DOWN,
+	HAL_PWR_DOWN, HAL_PWR_DOWN, HAL_PWR_DOWN, HAL_PWR_DOWN
+};
+
+static const uint8_t pwr_smcr[4] =
+{
+	SLEEP_MODE_IDLE, SLEEP_MODE_ADC, SLEEP_MODE_PWR_SAVE, SLEEP_MODE_PWR_DOWN
+};
+
+void HAL_PWR_Init(void)
+{
+	ADCSRA &= ~(1 << ADEN);
+	ACSR |= (1 << ACD);
+	
+	PRR = HAL_PWR_CLK_ALL;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(uint8_t i = 0; i < HAL_PWR_IDS; ++i) pwr_limit[i] = HAL_PWR_DOWN;
+	}
+}
+
+void HAL_PWR_SetLimit(uint8_t id, uint8_t mode)
+{
+	if(id >= HAL_PWR_IDS) return;
+	
+	/* A single byte store; no locking needed */
+	pwr_limit[id] = (mode > HAL_PWR_DOWN) ? HAL_PWR_DOWN : mode;
+}
+
+uint8_t HAL_PWR_GetMode(void)
+{
+	uint8_t mode = HAL_PWR_MAX_MODE;
+	
+	for(uint8_t i = 0; i < HAL_PWR_IDS; ++i)
+	{
+		uint8_t limit = pwr_limit[i];
+		
+		if(limit < mode) mode = limit;
+	}
+	
+	/* ADC noise reduction would start a conversion nobody waits for */
+	if(mode == HAL_PWR_ADC_NR && (ADCSRA & (1 << ADEN)) && pwr_limit[HAL_PWR_ID_ADC] == HAL_PWR_DOWN)
+	{
+		mode = HAL_PWR_IDLE;
+	}
+	
+	return mode;
+}
+
+void HAL_PWR_Sleep(void)
+{
+	cli();
+	HAL_PWR_SleepLocked();
+}
+
+void HAL_PWR_SleepLocked(void)
+{
+	uint8_t mode = HAL_PWR_GetMode();
+	
+	set_sleep_mode(pwr_smcr[mode]);
+	sleep_enable();
+	
+#if HAL_PWR_BOD_OFF
+	/* BODS only lasts three cycles: it must directly precede sleep */
+	if(mode >= HAL_PWR_SAVE) sleep_bod_disable();
+#endif
+	
+	sei();
+	sleep_cpu();
+	sleep_disable();
+}
+
+void HAL_PWR_ClockOn(uint8_t mask)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) PRR &= ~mask;
+}
+
+void HAL_PWR_ClockOff(uint8_t mask)
+{
+	/* The ADC must be disabled before its clock is gated */
+	if(mask & HAL_PWR_CLK_ADC) ADCSRA &= ~(1 << ADEN);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) PRR |= mask;
+}
@@ -19,9 +19,56 @@
  *       prescaler. Delegates to channel-specific configuration functions.
  *
  *   - void HAL_PWM_SetDutyCycle(uint8_t ch, uint8_t duty);
- *       Update the duty cycle for the selected channel. Duty is interpreted
- *       as 0..255 for 8-bit timers. For Timer1 (16-bit) the 8-bit value is
- *       internally scaled to the 16-bit range.
+ *       Update the duty cycle for the selected channel. Duty is a percentage
+ *       (0..100, larger values are clamped), converted with
+ *       HAL_PWM_SetDutyQ16.
+ *
+ *   - void HAL_PWM_SetDutyQ16(uint8_t ch, uint16_t duty);
+ *       Set the duty cycle as a Q16 fraction (0 = 0 %, 0xFFFF = 100 %).
+ *       8-bit timers use the high byte; Timer1 is scaled to its current TOP
+ *       with one 16 x 16 multiply, keeping its full resolution.
+ *
+ *   - void HAL_PWM_SetCompare(uint8_t ch, uint16_t value);
+ *       Write the compare register of ch directly (0..255 for timers 0/2,
+ *       0..TOP for Timer1). The cheapest update when the caller already
+ *       works in timer counts.
+ *
+ *   - uint32_t HAL_PWM_SetFrequency1(uint32_t freq, uint8_t mode);
+ *       Run Timer1 in an ICR1-topped mode (HAL_PWM_CH1_FAST_ICR or
+ *       HAL_PWM_CH1_PHASE_ICR) at freq Hz, with the smallest prescaler whose
+ *       TOP fits 16 bits, i.e. the finest duty resolution for that
+ *       frequency. Returns the frequency achieved, 0 if freq is out of
+ *       range. Set the duty cycles again afterwards.
+ *
+ *   - void HAL_PWM_SetTop1(uint16_t top);
+ *   - uint16_t HAL_PWM_GetTop1(void);
+ *       Write / read the Timer1 TOP (ICR1) used by the ICR1-topped modes;
+ *       GetTop1 returns the TOP of whichever Timer1 mode is configured.
+ *
+ *   - uint8_t HAL_PWM_PlayWave(uint8_t ch,
+ *                              const uint16_t* table,
+ *                              uint16_t len,
+ *                              uint8_t step,
+ *                              uint8_t loop);
+ *       Play a PROGMEM table of len Q16 duty values on ch from the timer
+ *       overflow interrupt: one sample every step PWM periods (0 acts as
+ *       1), forever if loop is non-zero, otherwise stopping on the last
+ *       sample. Returns 1 if started, 0 if the player of that timer is not
+ *       enabled (HAL_PWM_TIMERn_ISR) or the arguments are invalid.
+ *
+ *   - void HAL_PWM_StopWave(uint8_t ch);
+ *   - uint8_t HAL_PWM_WaveActive(uint8_t ch);
+ *       Stop the player of ch (the output keeps its current duty) / return
+ *       1 while it plays. SetDutyCycle, SetDutyQ16 and SetCompare also stop
+ *       it.
+ *
+ *   - uint8_t HAL_PWM_SetOverflowCallback(uint8_t ch, void (*callback)(void));
+ *       Call callback from the overflow interrupt of the timer driving ch,
+ *       once per PWM period and after the waveform players of that timer
+ *       have run (NULL removes it; a callback may remove itself). Lets a
+ *       driver update several compare registers in the same period.
+ *       Returns 1, or 0 if the ISR of that timer is not enabled
+ *       (HAL_PWM_TIMERn_ISR) or ch is invalid.
  *
  *   - void HAL_PWM_ConfigCH0(uint8_t mode, uint8_t prescale);
  *       Configure Timer/Counter0 PWM mode and prescaler. Use HAL_PWM_CH0_*
@@ -43,19 +90,41 @@
  *   - Mode selectors:
  *       HAL_PWM_CHx_FAST   - fast PWM mode (per-channel specific encoding)
  *       HAL_PWM_CHx_PHASE  - phase-correct PWM mode (per-channel specific)
+ *       HAL_PWM_CH1_FAST10, HAL_PWM_CH1_PHASE10 - Timer1 10-bit modes
+ *       HAL_PWM_CH1_FAST_ICR, HAL_PWM_CH1_PHASE_ICR
+ *                          - Timer1 modes with TOP = ICR1 (variable
+ *                            frequency and resolution)
  *
  *   - Prescaler encodings:
  *       HAL_PWM_CH0_CK_1, HAL_PWM_CH0_CK_8, HAL_PWM_CH0_CK_64, ...
  *       HAL_PWM_CH1_CK_1, HAL_PWM_CH1_CK_8, ...
  *       HAL_PWM_CH2_CK_1, HAL_PWM_CH2_CK_8, HAL_PWM_CH2_CK_32, ...
  *
+ * Configuration (compile-time, define before building pwm-hal.c):
+ *   HAL_PWM_TIMER0_ISR - 1: pwm-hal.c owns TIMER0_OVF_vect, enabling the
+ *                        waveform player and the overflow callback of
+ *                        Timer0 (default 0).
+ *   HAL_PWM_TIMER1_ISR - same for Timer1 and TIMER1_OVF_vect (default 0).
+ *   HAL_PWM_TIMER2_ISR - same for Timer2 and TIMER2_OVF_vect (default 0).
+ *
  * Usage:
  *   - Include this header in modules that require PWM access:
  *       #include "pwm-hal.h"
  *
  *   - Typical initialization sequence:
  *       HAL_PWM_Init(HAL_PWM_CH0A, HAL_PWM_CH0_FAST, HAL_PWM_CH0_CK_64);
- *       HAL_PWM_SetDutyCycle(HAL_PWM_CH0A, 128); // 50% for 8-bit timer
+ *       HAL_PWM_SetDutyCycle(HAL_PWM_CH0A, 50);  // 50 %
+ *
+ *   - 20 kHz Timer1 PWM with 800 duty steps:
+ *       HAL_PWM_Init(HAL_PWM_CH1A, HAL_PWM_CH1_FAST_ICR, HAL_PWM_CH1_CK_1);
+ *       HAL_PWM_SetFrequency1(20000UL, HAL_PWM_CH1_FAST_ICR);   // TOP = 799
+ *       HAL_PWM_SetDutyQ16(HAL_PWM_CH1A, 0x4000);              // 25 %
+ *
+ *   - Breathing LED on OC2A with no main-loop work (HAL_PWM_TIMER2_ISR=1):
+ *       static const uint16_t fade[64] PROGMEM = { 0, 16, 64, ... };
+ *       HAL_PWM_Init(HAL_PWM_CH2A, HAL_PWM_CH2_FAST, HAL_PWM_CH2_CK_64);
+ *       HAL_PWM_PlayWave(HAL_PWM_CH2A, fade, 64, 8, 1);
+ *       sei();
  *
  * Notes:
  *   - This header uses <avr/io.h> register and bit definitions. On non-AVR
@@ -64,8 +133,21 @@
  *   - The HAL focuses on timer configuration and writing to OCRx registers.
  *     Pin direction (DDR) configuration for OCnx pins is expected to be done
  *     by board/platform code when needed.
- *   - Timer1 is 16-bit on common AVR parts; to provide a consistent 0..255
- *     duty interface the implementation may scale the 8-bit duty to 16-bit.
+ *   - The Config functions stop the timer and clear TCCRnA/TCCRnB before
+ *     applying the new mode, so a channel can be reconfigured at any time.
+ *     Both compare outputs of the timer are enabled (non-inverting).
+ *   - In fast PWM a compare value of 0 still produces a one-count pulse
+ *     each period; use phase-correct mode when a true 0 % is required.
+ *   - The player writes the compare register once per sample at the timer
+ *     overflow, so updates are glitch-free (OCRnx is double-buffered in
+ *     PWM modes). At 16 MHz an 8-bit fast PWM with prescaler 64 overflows
+ *     at about 977 Hz.
+ *   - Compare values written from the overflow callback take effect
+ *     together at the next BOTTOM / TOP, so channels of one timer never
+ *     show a period with half of an update. Channels of different timers
+ *     only stay in step if the timers were started together (GTCCR TSM).
+ *   - The scheduler (sched.h) reprograms Timer0 as its tick and disables
+ *     its PWM outputs; use Timer1 or Timer2 for PWM alongside it.
  *   - Some mode/prescaler macros are channel-specific and map to the WGM/
  *     CS bits layout for each timer; consult the device datasheet for exact
  *     behavior and adjust if necessary for your hardware variant.
@@ -80,11 +162,84 @@
  *
  * Change log:
  *   2025-11-30  v0.1  Initial header for PWM HAL
+ *   2026-10-14  v0.2  Added HAL_PWM_SetDutyQ16, HAL_PWM_SetCompare, Timer1 ICR1-topped modes
+ *                     with HAL_PWM_SetFrequency1 / SetTop1 / GetTop1 and the PROGMEM
+ *                     waveform player (HAL_PWM_PlayWave). Config functions now clear
+ *                     TCCRnA/B first. HAL_PWM_CH0_FAST / _PHASE select the 8-bit TOP
+ *                     = 0xFF modes instead of TOP = OCR0A
+ *   2026-10-14  v0.3  Added HAL_PWM_SetOverflowCallback; the player flags are now
+ *                     HAL_PWM_TIMERn_ISR (overflow service of Timer n)
+ *   2026-10-14  v0.4  Config functions re-enable the timer clock in PRR (power-hal.h)
  *
  */
 
 #include "pwm-hal.h"
 
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+#include "power-hal.h"
+
+#ifndef F_CPU
+	#define F_CPU 16000000UL
+#endif
+
+#define PWM_ISR_ANY (HAL_PWM_TIMER0_ISR || HAL_PWM_TIMER1_ISR || HAL_PWM_TIMER2_ISR)
+
+/* TOP of Timer1 in the current mode, the scale of HAL_PWM_SetDutyQ16 */
+static volatile uint16_t pwm_top1 = 0x00FF;
+
+#if PWM_ISR_ANY
+
+typedef struct
+{
+	const uint16_t* table;
+	uint16_t len;
+	uint16_t idx;
+	uint8_t step;
+	uint8_t count;
+	uint8_t loop;
+} PWM_Wave_t;
+
+/*
+ * One player per channel, indexed by HAL_PWM_CHnx. A channel plays while
+ * table is not NULL; the overflow ISR of its timer advances it.
+ */
+static PWM_Wave_t pwm_wave[6];
+
+/* Overflow callback per timer, indexed by HAL_PWM_CHnx / 2 */
+static void (* volatile pwm_ovf_cb[3])(void);
+
+static void pwm_overflow(uint8_t ch_a, volatile uint8_t* timsk, uint8_t toie);
+static uint8_t pwm_wave_enabled(uint8_t ch);
+
+#endif
+
+static void pwm_write(uint8_t ch, uint16_t duty);
+static uint16_t pwm_top_of(uint8_t mode);
+
+#if HAL_PWM_TIMER0_ISR
+ISR(TIMER0_OVF_vect)
+{
+	pwm_overflow(HAL_PWM_CH0A, &TIMSK0, TOIE0);
+}
+#endif
+
+#if HAL_PWM_TIMER1_ISR
+ISR(TIMER1_OVF_vect)
+{
+	pwm_overflow(HAL_PWM_CH1A, &TIMSK1, TOIE1);
+}
+#endif
+
+#if HAL_PWM_TIMER2_ISR
+ISR(TIMER2_OVF_vect)
+{
+	pwm_overflow(HAL_PWM_CH2A, &TIMSK2, TOIE2);
+}
+#endif
+
 void HAL_PWM_Init(uint8_t ch, uint8_t mode, uint8_t prescale)
 {
 	switch(ch)
@@ -120,35 +275,176 @@ void HAL_PWM_Init(uint8_t ch, uint8_t mode, uint8_t prescale)
 
 void HAL_PWM_SetDutyCycle(uint8_t ch, uint8_t duty)
 {
-	if (duty > 100) duty = 100;
+	/* 655 / 65536 per percent: within 0.05 % of full scale, no division */
+	HAL_PWM_SetDutyQ16(ch, (duty >= 100) ? 0xFFFF : (uint16_t) duty * 655U);
+}
+
+void HAL_PWM_SetDutyQ16(uint8_t ch, uint16_t duty)
+{
+#if PWM_ISR_ANY
+	if(ch < 6) pwm_wave[ch].table = NULL;
+#endif
+	
+	pwm_write(ch, duty);
+}
+
+void HAL_PWM_SetCompare(uint8_t ch, uint16_t value)
+{
+	if(ch != HAL_PWM_CH1A && ch != HAL_PWM_CH1B && value > 0xFF) value = 0xFF;
+	
+#if PWM_ISR_ANY
+	if(ch < 6) pwm_wave[ch].table = NULL;
+#endif
 	
 	switch(ch)
 	{
 		case HAL_PWM_CH0A:
-			OCR0A = (uint8_t)((uint16_t)duty * 255u / 100u);
+			OCR0A = (uint8_t) value;
 			break;
 		case HAL_PWM_CH0B:
-			OCR0B = (uint8_t)((uint16_t)duty * 255u / 100u);
+			OCR0B = (uint8_t) value;
 			break;
 		case HAL_PWM_CH1A:
-			OCR1A = (uint16_t)((uint32_t)duty * 65535u / 100u);
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) OCR1A = value;
 			break;
 		case HAL_PWM_CH1B:
-			OCR1B = (uint16_t)((uint32_t)duty * 65535u / 100u);
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) OCR1B = value;
 			break;
 		case HAL_PWM_CH2A:
-			OCR2A = (uint8_t)((uint16_t)duty * 255u / 100u);
+			OCR2A = (uint8_t) value;
 			break;
 		case HAL_PWM_CH2B:
-			OCR2B = (uint8_t)((uint16_t)duty * 255u / 100u);
+			OCR2B = (uint8_t) value;
 			break;
 		default:
 			break;
 	}
 }
 
+uint32_t HAL_PWM_SetFrequency1(uint32_t freq, uint8_t mode)
+{
+	static const uint16_t divs[5] = {1, 8, 64, 256, 1024};
+	uint8_t phase = (mode == HAL_PWM_CH1_PHASE_ICR);
+	
+	if(freq == 0 || (mode != HAL_PWM_CH1_FAST_ICR && mode != HAL_PWM_CH1_PHASE_ICR)) return 0;
+	
+	/* Smallest prescaler whose TOP fits 16 bits gives the finest duty steps */
+	for(uint8_t i = 0; i < 5; ++i)
+	{
+		uint32_t clocks = F_CPU / divs[i] / (phase ? 2UL : 1UL);
+		uint32_t top    = (clocks + freq / 2UL) / freq;
+		
+		if(!phase && top > 0) top -= 1;
+		if(top > 0xFFFFUL) continue;
+		if(top < 2) return 0;
+		
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			TCCR1B = 0;
+			ICR1   = (uint16_t) top;
+			pwm_top1 = (uint16_t) top;
+		}
+		
+		HAL_PWM_ConfigCH1(mode, i + 1);
+		
+		return phase ? clocks / top : clocks / (top + 1UL);
+	}
+	
+	return 0;
+}
+
+void HAL_PWM_SetTop1(uint16_t top)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ICR1     = top;
+		pwm_top1 = top;
+	}
+}
+
+uint16_t HAL_PWM_GetTop1(void)
+{
+	return pwm_top1;
+}
+
+uint8_t HAL_PWM_PlayWave(uint8_t ch, const uint16_t* table, uint16_t len, uint8_t step, uint8_t loop)
+{
+#if PWM_ISR_ANY
+	if(ch >= 6 || table == NULL || len == 0 || !pwm_wave_enabled(ch)) return 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		PWM_Wave_t* w = &pwm_wave[ch];
+		
+		w->table = table;
+		w->len   = len;
+		w->idx   = 0;
+		w->step  = step ? step : 1;
+		w->count = 0;
+		w->loop  = loop;
+		
+		if(ch <= HAL_PWM_CH0B)      TIMSK0 |= (1 << TOIE0);
+		else if(ch <= HAL_PWM_CH1B) TIMSK1 |= (1 << TOIE1);
+		else                        TIMSK2 |= (1 << TOIE2);
+	}
+	
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+void HAL_PWM_StopWave(uint8_t ch)
+{
+#if PWM_ISR_ANY
+	if(ch < 6) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) pwm_wave[ch].table = NULL;
+#endif
+}
+
+uint8_t HAL_PWM_WaveActive(uint8_t ch)
+{
+#if PWM_ISR_ANY
+	uint8_t active = 0;
+	
+	if(ch < 6) ATOMIC_BLOCK(ATOMIC_RESTORESTATE) active = (pwm_wave[ch].table != NULL);
+	
+	return active;
+#else
+	return 0;
+#endif
+}
+
+uint8_t HAL_PWM_SetOverflowCallback(uint8_t ch, void (*callback)(void))
+{
+#if PWM_ISR_ANY
+	if(ch >= 6 || !pwm_wave_enabled(ch)) return 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		pwm_ovf_cb[ch >> 1] = callback;
+		
+		/* Disabled again by the ISR once nothing uses the overflow */
+		if(callback != NULL)
+		{
+			if(ch <= HAL_PWM_CH0B)      TIMSK0 |= (1 << TOIE0);
+			else if(ch <= HAL_PWM_CH1B) TIMSK1 |= (1 << TOIE1);
+			else                        TIMSK2 |= (1 << TOIE2);
+		}
+	}
+	
+	return 1;
+#else
+	return 0;
+#endif
+}
+
 void HAL_PWM_ConfigCH0(uint8_t mode, uint8_t prescale)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER0);
+	
+	TCCR0B = 0;
+	TCCR0A = 0;
+	
 	TCCR0A |=  (mode & 0x03);
 	
 	if(mode & 0x04) TCCR0B |= (1 << WGM02);
@@ -161,18 +457,34 @@ void HAL_PWM_ConfigCH0(uint8_t mode, uint8_t prescale)
 
 void HAL_PWM_ConfigCH1(uint8_t mode, uint8_t prescale)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER1);
+	
+	TCCR1B = 0;
+	TCCR1A = 0;
+	
 	TCCR1A |= (mode & 0x03);
 	
 	if(mode & 0x04) TCCR1B |= (1 << WGM12);
+	if(mode & 0x08) TCCR1B |= (1 << WGM13);
 	
 	TCCR1A |= (1 << COM1A1) | (1 << COM1B1);
-	TCCR1B |= (prescale & 0x07);
 	
-	TCNT1   = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		pwm_top1 = pwm_top_of(mode);
+		TCNT1    = 0;
+	}
+	
+	TCCR1B |= (prescale & 0x07);
 }
 
 void HAL_PWM_ConfigCH2(uint8_t mode, uint8_t prescale)
 {
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_TIMER2);
+	
+	TCCR2B = 0;
+	TCCR2A = 0;
+	
 	TCCR2A |=  (mode & 0x03);
 	
 	if(mode & 0x04) TCCR2B |= (1 << WGM22);
@@ -182,3 +494,103 @@ void HAL_PWM_ConfigCH2(uint8_t mode, uint8_t prescale)
 
 	TCNT2 = 0;
 }
+
+/*
+ * Scale a Q16 duty to the compare register of ch. 8-bit timers keep the
+ * high byte; Timer1 multiplies by TOP + 1 and keeps the high word.
+ */
+static void pwm_write(uint8_t ch, uint16_t duty)
+{
+	uint8_t duty8 = (uint8_t) (duty >> 8);
+	
+	switch(ch)
+	{
+		case HAL_PWM_CH0A:
+			OCR0A = duty8;
+			break;
+		case HAL_PWM_CH0B:
+			OCR0B = duty8;
+			break;
+		case HAL_PWM_CH1A:
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) OCR1A = (uint16_t) (((uint32_t) duty * ((uint32_t) pwm_top1 + 1UL)) >> 16);
+			break;
+		case HAL_PWM_CH1B:
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) OCR1B = (uint16_t) (((uint32_t) duty * ((uint32_t) pwm_top1 + 1UL)) >> 16);
+			break;
+		case HAL_PWM_CH2A:
+			OCR2A = duty8;
+			break;
+		case HAL_PWM_CH2B:
+			OCR2B = duty8;
+			break;
+		default:
+			break;
+	}
+}
+
+/* TOP of a Timer1 waveform mode (WGM13:10); ICR1 for the variable modes */
+static uint16_t pwm_top_of(uint8_t mode)
+{
+	switch(mode & 0x0F)
+	{
+		case 0x01:
+		case 0x05:
+			return 0x00FF;
+		case 0x02:
+		case 0x06:
+			return 0x01FF;
+		case 0x03:
+		case 0x07:
+			return 0x03FF;
+		default:
+			return ICR1;
+	}
+}
+
+#if PWM_ISR_ANY
+
+/*
+ * Overflow of the timer serving channels ch_a and ch_a + 1: advance each
+ * playing channel every step periods and load its next sample, then run
+ * the overflow callback. The overflow interrupt is disabled when both
+ * channels are idle and no callback is set.
+ */
+static void pwm_overflow(uint8_t ch_a, volatile uint8_t* timsk, uint8_t toie)
+{
+	void (*cb)(void);
+	
+
+	for(uint8_t ch = ch_a; ch <= ch_a + 1U; ++ch)
+	{
+		PWM_Wave_t* w = &pwm_wave[ch];
+		
+		if(w->table == NULL || ++w->count < w->step) continue;
+		
+		w->count = 0;
+		pwm_write(ch, pgm_read_word(&w->table[w->idx]));
+		
+		if(++w->idx >= w->len)
+		{
+			w->idx = 0;
+			if(!w->loop) w->table = NULL;
+		}
+	}
+	
+	cb = pwm_ovf_cb[ch_a >> 1];
+	if(cb != NULL) cb();
+	
+	if(pwm_wave[ch_a].table == NULL && pwm_wave[ch_a + 1U].table == NULL && pwm_ovf_cb[ch_a >> 1] == NULL)
+	{
+		*timsk &= ~(1 << toie);
+	}
+}
+
+static uint8_t pwm_wave_enabled(uint8_t ch)
+{
+	if(ch <= HAL_PWM_CH0B) return HAL_PWM_TIMER0_ISR;
+	if(ch <= HAL_PWM_CH1B) return HAL_PWM_TIMER1_ISR;
+	
+	return HAL_PWM_TIMER2_ISR;
+}
+
+#endif
@@ -19,9 +19,56 @@
  *       prescaler. Delegates to channel-specific configuration functions.
  *
  *   - void HAL_PWM_SetDutyCycle(uint8_t ch, uint8_t duty);
- *       Update the duty cycle for the selected channel. Duty is interpreted
- *       as 0..255 for 8-bit timers. For Timer1 (16-bit) the 8-bit value is
- *       internally scaled to the 16-bit range.
+ *       Update the duty cycle for the selected channel. Duty is a percentage
+ *       (0..100, larger values are clamped), converted with
+ *       HAL_PWM_SetDutyQ16.
+ *
+ *   - void HAL_PWM_SetDutyQ16(uint8_t ch, uint16_t duty);
+ *       Set the duty cycle as a Q16 fraction (0 = 0 %, 0xFFFF = 100 %).
+ *       8-bit timers use the high byte; Timer1 is scaled to its current TOP
+ *       with one 16 x 16 multiply, keeping its full resolution.
+ *
+ *   - void HAL_PWM_SetCompare(uint8_t ch, uint16_t value);
+ *       Write the compare register of ch directly (0..255 for timers 0/2,
+ *       0..TOP for Timer1). The cheapest update when the caller already
+ *       works in timer counts.
+ *
+ *   - uint32_t HAL_PWM_SetFrequency1(uint32_t freq, uint8_t mode);
+ *       Run Timer1 in an ICR1-topped mode (HAL_PWM_CH1_FAST_ICR or
+ *       HAL_PWM_CH1_PHASE_ICR) at freq Hz, with the smallest prescaler whose
+ *       TOP fits 16 bits, i.e. the finest duty resolution for that
+ *       frequency. Returns the frequency achieved, 0 if freq is out of
+ *       range. Set the duty cycles again afterwards.
+ *
+ *   - void HAL_PWM_SetTop1(uint16_t top);
+ *   - uint16_t HAL_PWM_GetTop1(void);
+ *       Write / read the Timer1 TOP (ICR1) used by the ICR1-topped modes;
+ *       GetTop1 returns the TOP of whichever Timer1 mode is configured.
+ *
+ *   - uint8_t HAL_PWM_PlayWave(uint8_t ch,
+ *                              const uint16_t* table,
+ *                              uint16_t len,
+ *                              uint8_t step,
+ *                              uint8_t loop);
+ *       Play a PROGMEM table of len Q16 duty values on ch from the timer
+ *       overflow interrupt: one sample every step PWM periods (0 acts as
+ *       1), forever if loop is non-zero, otherwise stopping on the last
+ *       sample. Returns 1 if started, 0 if the player of that timer is not
+ *       enabled (HAL_PWM_TIMERn_ISR) or the arguments are invalid.
+ *
+ *   - void HAL_PWM_StopWave(uint8_t ch);
+ *   - uint8_t HAL_PWM_WaveActive(uint8_t ch);
+ *       Stop the player of ch (the output keeps its current duty) / return
+ *       1 while it plays. SetDutyCycle, SetDutyQ16 and SetCompare also stop
+ *       it.
+ *
+ *   - uint8_t HAL_PWM_SetOverflowCallback(uint8_t ch, void (*callback)(void));
+ *       Call callback from the overflow interrupt of the timer driving ch,
+ *       once per PWM period and after the waveform players of that timer
+ *       have run (NULL removes it; a callback may remove itself). Lets a
+ *       driver update several compare registers in the same period.
+ *       Returns 1, or 0 if the ISR of that timer is not enabled
+ *       (HAL_PWM_TIMERn_ISR) or ch is invalid.
  *
  *   - void HAL_PWM_ConfigCH0(uint8_t mode, uint8_t prescale);
  *       Configure Timer/Counter0 PWM mode and prescaler. Use HAL_PWM_CH0_*
@@ -43,19 +90,41 @@
  *   - Mode selectors:
  *       HAL_PWM_CHx_FAST   - fast PWM mode (per-channel specific encoding)
  *       HAL_PWM_CHx_PHASE  - phase-correct PWM mode (per-channel specific)
+ *       HAL_PWM_CH1_FAST10, HAL_PWM_CH1_PHASE10 - Timer1 10-bit modes
+ *       HAL_PWM_CH1_FAST_ICR, HAL_PWM_CH1_PHASE_ICR
+ *                          - Timer1 modes with TOP = ICR1 (variable
+ *                            frequency and resolution)
  *
  *   - Prescaler encodings:
  *       HAL_PWM_CH0_CK_1, HAL_PWM_CH0_CK_8, HAL_PWM_CH0_CK_64, ...
  *       HAL_PWM_CH1_CK_1, HAL_PWM_CH1_CK_8, ...
  *       HAL_PWM_CH2_CK_1, HAL_PWM_CH2_CK_8, HAL_PWM_CH2_CK_32, ...
  *
+ * Configuration (compile-time, define before building pwm-hal.c):
+ *   HAL_PWM_TIMER0_ISR - 1: pwm-hal.c owns TIMER0_OVF_vect, enabling the
+ *                        waveform player and the overflow callback of
+ *                        Timer0 (default 0).
+ *   HAL_PWM_TIMER1_ISR - same for Timer1 and TIMER1_OVF_vect (default 0).
+ *   HAL_PWM_TIMER2_ISR - same for Timer2 and TIMER2_OVF_vect (default 0).
+ *
  * Usage:
  *   - Include this header in modules that require PWM access:
  *       #include "pwm-hal.h"
  *
  *   - Typical initialization sequence:
  *       HAL_PWM_Init(HAL_PWM_CH0A, HAL_PWM_CH0_FAST, HAL_PWM_CH0_CK_64);
- *       HAL_PWM_SetDutyCycle(HAL_PWM_CH0A, 128); // 50% for 8-bit timer
+ *       HAL_PWM_SetDutyCycle(HAL_PWM_CH0A, 50);  // 50 %
+ *
+ *   - 20 kHz Timer1 PWM with 800 duty steps:
+ *       HAL_PWM_Init(HAL_PWM_CH1A, HAL_PWM_CH1_FAST_ICR, HAL_PWM_CH1_CK_1);
+ *       HAL_PWM_SetFrequency1(20000UL, HAL_PWM_CH1_FAST_ICR);   // TOP = 799
+ *       HAL_PWM_SetDutyQ16(HAL_PWM_CH1A, 0x4000);              // 25 %
+ *
+ *   - Breathing LED on OC2A with no main-loop work (HAL_PWM_TIMER2_ISR=1):
+ *       static const uint16_t fade[64] PROGMEM = { 0, 16, 64, ... };
+ *       HAL_PWM_Init(HAL_PWM_CH2A, HAL_PWM_CH2_FAST, HAL_PWM_CH2_CK_64);
+ *       HAL_PWM_PlayWave(HAL_PWM_CH2A, fade, 64, 8, 1);
+ *       sei();
  *
  * Notes:
  *   - This header uses <avr/io.h> register and bit definitions. On non-AVR
@@ -64,8 +133,21 @@
  *   - The HAL focuses on timer configuration and writing to OCRx registers.
  *     Pin direction (DDR) configuration for OCnx pins is expected to be done
  *     by board/platform code when needed.
- *   - Timer1 is 16-bit on common AVR parts; to provide a consistent 0..255
- *     duty interface the implementation may scale the 8-bit duty to 16-bit.
+ *   - The Config functions stop the timer and clear TCCRnA/TCCRnB before
+ *     applying the new mode, so a channel can be reconfigured at any time.
+ *     Both compare outputs of the timer are enabled (non-inverting).
+ *   - In fast PWM a compare value of 0 still produces a one-count pulse
+ *     each period; use phase-correct mode when a true 0 % is required.
+ *   - The player writes the compare register once per sample at the timer
+ *     overflow, so updates are glitch-free (OCRnx is double-buffered in
+ *     PWM modes). At 16 MHz an 8-bit fast PWM with prescaler 64 overflows
+ *     at about 977 Hz.
+ *   - Compare values written from the overflow callback take effect
+ *     together at the next BOTTOM / TOP, so channels of one timer never
+ *     show a period with half of an update. Channels of different timers
+ *     only stay in step if the timers were started together (GTCCR TSM).
+ *   - The scheduler (sched.h) reprograms Timer0 as its tick and disables
+ *     its PWM outputs; use Timer1 or Timer2 for PWM alongside it.
  *   - Some mode/prescaler macros are channel-specific and map to the WGM/
  *     CS bits layout for each timer; consult the device datasheet for exact
  *     behavior and adjust if necessary for your hardware variant.
@@ -80,6 +162,14 @@
  *
  * Change log:
  *   2025-11-30  v0.1  Initial header for PWM HAL
+ *   2026-10-14  v0.2  Added HAL_PWM_SetDutyQ16, HAL_PWM_SetCompare, Timer1 ICR1-topped modes
+ *                     with HAL_PWM_SetFrequency1 / SetTop1 / GetTop1 and the PROGMEM
+ *                     waveform player (HAL_PWM_PlayWave). Config functions now clear
+ *                     TCCRnA/B first. HAL_PWM_CH0_FAST / _PHASE select the 8-bit TOP
+ *                     = 0xFF modes instead of TOP = OCR0A
+ *   2026-10-14  v0.3  Added HAL_PWM_SetOverflowCallback; the player flags are now
+ *                     HAL_PWM_TIMERn_ISR (overflow service of Timer n)
+ *   2026-10-14  v0.4  Config functions re-enable the timer clock in PRR (power-hal.h)
  *
  */
 
@@ -87,6 +177,7 @@
 #define PWM_HAL_H
 
 #include <avr/io.h>
+#include <stdint.h>
 
 #define HAL_PWM_CH0A  0
 #define HAL_PWM_CH0B  1
@@ -95,11 +186,15 @@
 #define HAL_PWM_CH2A  4
 #define HAL_PWM_CH2B  5
 
-#define HAL_PWM_CH0_FAST       0x07
-#define HAL_PWM_CH0_PHASE      0x05
+#define HAL_PWM_CH0_FAST       0x03
+#define HAL_PWM_CH0_PHASE      0x01
 
 #define HAL_PWM_CH1_FAST       0x05
 #define HAL_PWM_CH1_PHASE      0x01
+#define HAL_PWM_CH1_FAST10     0x07
+#define HAL_PWM_CH1_PHASE10    0x03
+#define HAL_PWM_CH1_FAST_ICR   0x0E
+#define HAL_PWM_CH1_PHASE_ICR  0x0A
 
 #define HAL_PWM_CH2_FAST       0x03
 #define HAL_PWM_CH2_PHASE      0x01
@@ -127,9 +222,33 @@
 #define HAL_PWM_CH2_CK_128     0x05
 #define HAL_PWM_CH2_CK_256     0x06 
 #define HAL_PWM_CH2_CK_1024    0x07
+
+#ifndef HAL_PWM_TIMER0_ISR
+	#define HAL_PWM_TIMER0_ISR 0
+#endif
+
+#ifndef HAL_PWM_TIMER1_ISR
+	#define HAL_PWM_TIMER1_ISR 0
+#endif
+
+#ifndef HAL_PWM_TIMER2_ISR
+	#define HAL_PWM_TIMER2_ISR 0
+#endif
  
 void HAL_PWM_Init(uint8_t ch, uint8_t mode, uint8_t clock);
 void HAL_PWM_SetDutyCycle(uint8_t ch, uint8_t duty);
+void HAL_PWM_SetDutyQ16(uint8_t ch, uint16_t duty);
+void HAL_PWM_SetCompare(uint8_t ch, uint16_t value);
+
+uint32_t HAL_PWM_SetFrequency1(uint32_t freq, uint8_t mode);
+void HAL_PWM_SetTop1(uint16_t top);
+uint16_t HAL_PWM_GetTop1(void);
+
+uint8_t HAL_PWM_PlayWave(uint8_t ch, const uint16_t* table, uint16_t len, uint8_t step, uint8_t loop);
+void HAL_PWM_StopWave(uint8_t ch);
+uint8_t HAL_PWM_WaveActive(uint8_t ch);
+
+uint8_t HAL_PWM_SetOverflowCallback(uint8_t ch, void (*callback)(void));
 
 void HAL_PWM_ConfigCH0(uint8_t mode, uint8_t prescale);
 void HAL_PWM_ConfigCH1(uint8_t mode, uint8_t prescale);
@@ -43,7 +43,51 @@
  *   void HAL_SPI_Receive(unsigned char* buf, size_t len);
  *     Receive multiple bytes from SPI into buffer.
  *
+ *   void HAL_SPI_Transfer(const unsigned char* tx,
+ *                         unsigned char* rx,
+ *                         size_t len);
+ *     Full-duplex blocking exchange of len bytes: tx[i] is shifted out while
+ *     the byte shifted in is stored in rx[i]. tx may be NULL to clock out
+ *     0xFF dummy bytes, rx may be NULL to discard the received bytes.
+ *     Waits for the transaction queue to drain first.
+ *
+ *   uint8_t HAL_SPI_Submit(HAL_SPI_Transaction_t* t);
+ *     Queue a controller transaction and return immediately. When the
+ *     transaction reaches the head of the queue its chip select is driven
+ *     low, len bytes are exchanged from the SPI interrupt and chip select
+ *     is released after the last byte. t->callback (if not NULL) is then
+ *     invoked from the SPI interrupt. Returns HAL_SPI_ST_PENDING,
+ *     HAL_SPI_ST_OK if len is 0 (completed on the spot, the callback is
+ *     not invoked), or HAL_SPI_ST_BUSY if t is already queued.
+ *
+ *   uint8_t HAL_SPI_Wait(HAL_SPI_Transaction_t* t);
+ *     Block until t has completed and return its final status.
+ *
+ *   uint8_t HAL_SPI_IsBusy(void);
+ *     Return non-zero while a transaction is queued or running.
+ *
+ * Public types:
+ *   HAL_SPI_Transaction_t
+ *     Controller transaction descriptor. Owned by the caller and must stay
+ *     valid until the transaction completes:
+ *       volatile uint8_t    *cs_port  — PORTx register of the chip select
+ *                                       pin (e.g. &PORTB), NULL for none
+ *       uint8_t              cs_pin   — chip select bit number in cs_port
+ *       const unsigned char *tx       — bytes to send (NULL sends 0xFF)
+ *       unsigned char       *rx       — received bytes (NULL discards)
+ *       size_t               len      — number of bytes to exchange
+ *       void (*callback)(HAL_SPI_Transaction_t *t)
+ *                                     — completion callback (ISR context)
+ *       void                *ctx      — user context for the callback
+ *       volatile uint8_t     status   — HAL_SPI_ST_* code (set by the HAL)
+ *     tx and rx may point to the same buffer for an in-place exchange.
+ *
  * Public constants:
+ *   Transaction status codes:
+ *     HAL_SPI_ST_OK      - transfer completed
+ *     HAL_SPI_ST_PENDING - queued, waiting for the transactions ahead of it
+ *     HAL_SPI_ST_BUSY    - transfer in progress
+ *
  *   SPI Formats (CPOL/CPHA combinations):
  *     HAL_SPI_FORMAT0 - CPOL=0, CPHA=0 (sample on rising edge, setup on falling edge)
  *     HAL_SPI_FORMAT1 - CPOL=0, CPHA=1 (setup on rising edge, sample on falling edge)
@@ -79,14 +123,49 @@
  *       HAL_SPI_Send(buf, 3);
  *   - Receive a byte:
  *       unsigned char data = HAL_SPI_Read();
+ *   - Exchange a frame (full duplex):
+ *       unsigned char cmd[3] = {0x9F, 0xFF, 0xFF};
+ *       unsigned char resp[3];
+ *       HAL_SPI_Transfer(cmd, resp, 3);
+ *   - Send a frame in the background with chip select on PB2:
+ *       static HAL_SPI_Transaction_t t;
+ *       DDRB |= (1 << PB2);
+ *       PORTB |= (1 << PB2);
+ *       t.cs_port  = &PORTB;
+ *       t.cs_pin   = PB2;
+ *       t.tx       = frame;
+ *       t.rx       = NULL;
+ *       t.len      = sizeof(frame);
+ *       t.callback = on_frame_done;
+ *       HAL_SPI_Submit(&t);
  *   - Implementations should ensure proper configuration of SPI hardware
  *     registers and handle chip select (SS/CS) management at a higher level.
  *
  * Notes:
- *   - This HAL does not manage chip select (CS/SS) pins — that responsibility
- *     belongs to the application or a higher-level driver.
- *   - Blocking operations are used; consider interrupt-driven or DMA transfers
- *     for performance-critical applications.
+ *   - The blocking functions do not manage chip select (CS/SS) pins — that
+ *     responsibility belongs to the application or a higher-level driver.
+ *     Queued transactions drive the chip select given in the descriptor;
+ *     the pin must already be configured as an output, idle high.
+ *   - The chip select is switched with a read-modify-write of cs_port,
+ *     also from SPI_STC_vect when one transaction chains to the next.
+ *     While the queue is not empty, main-loop code must not write that
+ *     port with a plain read-modify-write (HAL_Port_Write,
+ *     HAL_Port_WriteMask, PORTB |= ...): an SPI interrupt in between is
+ *     undone, leaving CS stuck low or glitching it. Use
+ *     HAL_Port_WriteMaskAtomic, or HAL_PIN_SET / HAL_PIN_CLEAR (single
+ *     sbi/cbi instructions), for other pins of that port.
+ *   - Queued transactions run in the SPI interrupt and are only supported
+ *     in master mode. SPIE is enabled while the queue is not empty and
+ *     cleared when it drains, so the blocking functions keep polling SPIF.
+ *     With global interrupts disabled HAL_SPI_Wait drives the queue by
+ *     polling SPIF, so it also works before sei() is called.
+ *   - spi-hal.c owns SPI_STC_vect; the application must not define it.
+ *   - Each queued byte costs one interrupt. At HAL_SPI_CK_2 a byte is
+ *     shifted in 16 CPU cycles, less than the interrupt overhead, so for
+ *     short frames at the highest clock rates the blocking functions are
+ *     faster; the queue pays off when the CPU has other work to do.
+ *   - Do not call the blocking functions from a completion callback while
+ *     other transactions are queued.
  *
  * Author: otavioacb
  * Created: 2026-02-17
@@ -98,6 +177,13 @@
  *
  * Change log:
  *   2026-02-17  v0.1  Initial header for SPI HAL
+ *   2026-10-14  v0.2  Added full-duplex HAL_SPI_Transfer and the SPI_STC_vect-driven
+ *                     transaction queue: HAL_SPI_Submit, HAL_SPI_Wait, HAL_SPI_IsBusy
+ *                     and HAL_SPI_ST_* status codes
+ *   2026-10-14  v0.3  Power management hooks (power-hal.h): queued transactions hold
+ *                     IDLE
+ *   2026-10-14  v0.4  Cycle trace hook (trace-hal.h) in SPI_STC_vect
+ *   2026-10-14  v0.5  Documented the chip select port sharing rule for queued transactions
  *
  */
 
@@ -106,6 +192,7 @@
 #define SPI_HAL_H_
 
 #include <avr/io.h>
+#include <stdint.h>
 #include <stddef.h>
 
 #define HAL_SPI_FORMAT0 0x00
@@ -127,6 +214,23 @@
 #define HAL_SPI_MD0     0x00 // Slave or Peripheral Mode
 #define HAL_SPI_MD1     0x01 // Master or Controller Mode
 
+#define HAL_SPI_ST_OK      0x00
+#define HAL_SPI_ST_PENDING 0x01
+#define HAL_SPI_ST_BUSY    0x02
+
+typedef struct HAL_SPI_Transaction
+{
+	volatile uint8_t* cs_port;
+	uint8_t cs_pin;
+	const unsigned char* tx;
+	unsigned char* rx;
+	size_t len;
+	void (*callback)(struct HAL_SPI_Transaction* t);
+	void* ctx;
+	volatile uint8_t status;
+	struct HAL_SPI_Transaction* next;
+} HAL_SPI_Transaction_t;
+
 void HAL_SPI_Init(unsigned char mode, unsigned char order, unsigned char ck, unsigned char format);
 
 void HAL_SPI_SetClock(unsigned char ck);
@@ -139,4 +243,10 @@ void HAL_SPI_Send(unsigned char* data, size_t len);
 unsigned char HAL_SPI_Read();
 void HAL_SPI_Receive(unsigned char* buf, size_t len);
 
+void HAL_SPI_Transfer(const unsigned char* tx, unsigned char* rx, size_t len);
+
+uint8_t HAL_SPI_Submit(HAL_SPI_Transaction_t* t);
+uint8_t HAL_SPI_Wait(HAL_SPI_Transaction_t* t);
+uint8_t HAL_SPI_IsBusy(void);
+
 #endif /* SPI-HAL_H_ */
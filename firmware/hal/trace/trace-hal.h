@@ -0,0 +1,200 @@
+/*
+ * uc-Microlab — Cycle Trace HAL
+ * File: trace-hal.h / trace-hal.c
+ *
+ * Project: uc-MicroLab
+ * Component: Cycle counter and timing instrumentation Hardware Abstraction Layer (HAL)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Measures execution time in CPU cycles. Timer1 runs free at the CPU
+ *   clock (62.5 ns per tick at 16 MHz) and is extended by its overflow
+ *   interrupt to a 32-bit cycle count for timing whole calls, e.g. from a
+ *   benchmark. For instrumentation inside the firmware, HAL_TRACE_ENTER /
+ *   HAL_TRACE_EXIT pairs take a time stamp from the 16-bit counter at
+ *   entry and record the elapsed cycles at exit into a per-slot count,
+ *   minimum, maximum and total. HAL_TRACE_VALUE records any other cycle
+ *   figure, such as an interrupt latency, into a slot the same way.
+ *
+ *   The HALs time their interrupt handlers through these macros, which
+ *   compile to nothing unless the project is built with HAL_TRACE_USE = 1:
+ *     - uart-hal (ISR mode): USART_RX_vect and USART_UDRE_vect
+ *     - spi-hal: SPI_STC_vect
+ *     - i2c-hal: TWI_vect
+ *     - adc-hal: ADC_vect, including the conversion callback
+ *
+ * Public API:
+ *   void HAL_TRACE_Init(void);
+ *     Clear every slot and, with HAL_TRACE_TIMER1 = 1, start Timer1 in
+ *     normal mode at the CPU clock with its overflow interrupt enabled.
+ *     Global interrupts must be enabled by the application.
+ *
+ *   uint32_t HAL_TRACE_Cycles(void);
+ *     Current 32-bit cycle count. Differences of two readings give the
+ *     cycles spent in between (up to about 268 s at 16 MHz). Without
+ *     HAL_TRACE_TIMER1 it returns HAL_TRACE_CLOCK.
+ *
+ *   void HAL_TRACE_Get(uint8_t id, HAL_TRACE_Stat_t* s);
+ *     Copy the statistics of slot id into s as a consistent snapshot.
+ *
+ *   void HAL_TRACE_Reset(uint8_t id);
+ *     Clear slot id; HAL_TRACE_ALL clears every slot.
+ *
+ *   HAL_TRACE_ENTER(id);
+ *   HAL_TRACE_EXIT(id);
+ *     Mark the start and the end of a traced section. EXIT records the
+ *     cycles elapsed since the ENTER of the same slot.
+ *
+ *   HAL_TRACE_VALUE(id, cycles);
+ *     Record cycles (uint16_t) into slot id.
+ *
+ * Public types:
+ *   HAL_TRACE_Stat_t
+ *     uint16_t count — number of recorded samples (saturates at 65535)
+ *     uint16_t min   — smallest sample (0xFFFF while count = 0)
+ *     uint16_t max   — largest sample
+ *     uint32_t total — sum of the counted samples; total / count is the
+ *                      average
+ *
+ * Public constants:
+ *   - Slots timed by the HALs: HAL_TRACE_ID_UART_RX, _UART_TX, _SPI, _I2C,
+ *     _ADC. HAL_TRACE_ID_APP and the slots above it, up to
+ *     HAL_TRACE_SLOTS - 1, are free for the application.
+ *   - HAL_TRACE_ALL - every slot, for HAL_TRACE_Reset.
+ *
+ * Configuration (compile-time, define for every source of the project):
+ *   HAL_TRACE_USE    - 1 enables the HAL_TRACE_ENTER / _EXIT / _VALUE
+ *                      macros (link trace-hal.c); 0 (default) turns them
+ *                      into no-ops.
+ *   HAL_TRACE_SLOTS  - number of slots, HAL_TRACE_ID_APP + 1 to 32
+ *                      (default 8).
+ *   HAL_TRACE_TIMER1 - 1 (default): trace-hal.c owns Timer1 and
+ *                      TIMER1_OVF_vect. 0: the application runs the
+ *                      timer read by HAL_TRACE_CLOCK itself.
+ *   HAL_TRACE_CLOCK  - expression read by the macros (default TCNT1).
+ *                      Any free-running 16-bit count works; samples are
+ *                      then in ticks of that counter.
+ *
+ * Usage:
+ *   - Include this header where timing is required:
+ *       #include "trace-hal.h"
+ *
+ *   - Time a function (build with HAL_TRACE_USE=1):
+ *       #define TRACE_FILTER HAL_TRACE_ID_APP
+ *
+ *       HAL_TRACE_Init();
+ *       sei();
+ *
+ *       HAL_TRACE_ENTER(TRACE_FILTER);
+ *       filter_run();
+ *       HAL_TRACE_EXIT(TRACE_FILTER);
+ *
+ *       HAL_TRACE_Stat_t s;
+ *       HAL_TRACE_Get(TRACE_FILTER, &s);   // s.min, s.max, s.total / s.count
+ *
+ *   - Worst-case latency of a Timer1 compare interrupt, in cycles:
+ *       ISR(TIMER1_COMPB_vect)
+ *       {
+ *           HAL_TRACE_VALUE(HAL_TRACE_ID_APP + 1, TCNT1 - OCR1B);
+ *           ...
+ *       }
+ *
+ *   - Cost of one call, without the macros:
+ *       uint32_t t0 = HAL_TRACE_Cycles();
+ *       DS3231_GetTime(&now);
+ *       uint32_t cycles = HAL_TRACE_Cycles() - t0;
+ *
+ * Notes:
+ *   - With HAL_TRACE_TIMER1 = 1 Timer1 is not available for PWM, CTC or
+ *     input capture, and trace-hal.c cannot be linked with icp-hal.c or
+ *     with pwm-hal built with HAL_PWM_TIMER1_ISR=1. An input capture
+ *     running at HAL_ICP_CK_1 counts cycles too: use HAL_TRACE_TIMER1 = 0
+ *     and keep the default HAL_TRACE_CLOCK.
+ *   - ENTER/EXIT pairs measure up to 65535 cycles (4 ms at 16 MHz) and
+ *     include the time spent in interrupts that preempted the section.
+ *     A slot must not be entered again before its EXIT, so nested or
+ *     reentrant sections need different slots.
+ *   - An ENTER/EXIT pair adds a few dozen cycles, nearly all of them in
+ *     the call made by EXIT; ENTER is a single 16-bit load and store.
+ *   - HAL_TRACE_Cycles itself takes a few dozen cycles; subtract the
+ *     difference of two back-to-back readings when timing short calls.
+ *   - The IDs of the hooks in the HALs must stay below HAL_TRACE_SLOTS; the
+ *     default leaves three application slots.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for cycle trace HAL
+ *
+ */
+
+#ifndef TRACE_HAL_H_
+#define TRACE_HAL_H_
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#define HAL_TRACE_ID_UART_RX 0x00
+#define HAL_TRACE_ID_UART_TX 0x01
+#define HAL_TRACE_ID_SPI     0x02
+#define HAL_TRACE_ID_I2C     0x03
+#define HAL_TRACE_ID_ADC     0x04
+#define HAL_TRACE_ID_APP     0x05
+
+#define HAL_TRACE_ALL        0xFF
+
+#ifndef HAL_TRACE_USE
+	#define HAL_TRACE_USE 0
+#endif
+
+#ifndef HAL_TRACE_SLOTS
+	#define HAL_TRACE_SLOTS 8U
+#endif
+
+#ifndef HAL_TRACE_TIMER1
+	#define HAL_TRACE_TIMER1 1
+#endif
+
+#ifndef HAL_TRACE_CLOCK
+	#define HAL_TRACE_CLOCK TCNT1
+#endif
+
+#if (HAL_TRACE_SLOTS <= HAL_TRACE_ID_APP) || (HAL_TRACE_SLOTS > 32)
+	#error "HAL_TRACE_SLOTS must be between HAL_TRACE_ID_APP + 1 and 32"
+#endif
+
+typedef struct
+{
+	uint16_t count;
+	uint16_t min;
+	uint16_t max;
+	uint32_t total;
+} HAL_TRACE_Stat_t;
+
+/* Used by the macros below; not part of the API */
+extern volatile uint16_t _HAL_TRACE_Start[HAL_TRACE_SLOTS];
+void _HAL_TRACE_Record(uint8_t id, uint16_t cycles);
+
+#if HAL_TRACE_USE
+	#define HAL_TRACE_ENTER(id)          (_HAL_TRACE_Start[(id)] = HAL_TRACE_CLOCK)
+	#define HAL_TRACE_EXIT(id)           _HAL_TRACE_Record((id), (uint16_t) (HAL_TRACE_CLOCK - _HAL_TRACE_Start[(id)]))
+	#define HAL_TRACE_VALUE(id, cycles)  _HAL_TRACE_Record((id), (uint16_t) (cycles))
+#else
+	#define HAL_TRACE_ENTER(id)          ((void) 0)
+	#define HAL_TRACE_EXIT(id)           ((void) 0)
+	#define HAL_TRACE_VALUE(id, cycles)  ((void) 0)
+#endif
+
+void HAL_TRACE_Init(void);
+uint32_t HAL_TRACE_Cycles(void);
+
+void HAL_TRACE_Get(uint8_t id, HAL_TRACE_Stat_t* s);
+void HAL_TRACE_Reset(uint8_t id);
+
+#endif /* TRACE_HAL_H_ */
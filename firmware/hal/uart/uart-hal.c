@@ -10,27 +10,94 @@
  *   Minimal, portable UART HAL for AVR (ATmega) and other platforms.
  *   Provides initialization and transmit/receive primitives and a small,
  *   well-documented API surface for embedding in examples and libraries.
+ *   Optionally runs interrupt-driven (USART_RX / USART_UDRE ISRs) on top of
+ *   power-of-two RX/TX ring buffers so transmission and reception no longer
+ *   stall the CPU.
  *
  * Public API (examples of functions that should be declared/implemented):
  *   void HAL_UART_Init(unsigned int baud_rate);
+ *   uint32_t HAL_UART_InitConfig(const HAL_UART_Config_t* cfg);
  *   void HAL_UART_Transmit(unsigned char data);
  *   void HAL_UART_Send(unsigned char* msg, size_t len_msg);
+ *   size_t HAL_UART_TrySend(const unsigned char* msg, size_t len_msg);
  *   unsigned char HAL_UART_Receive(void);
- *   unsigned char HAL_UART_Read(unsigned char* buf, size_t len);
- *   unsigned char HAL_UART_Available();
+ *   size_t HAL_UART_Read(unsigned char* buf, size_t len);
+ *   size_t HAL_UART_TryRead(unsigned char* buf, size_t len);
+ *   size_t HAL_UART_Available();
  *   void HAL_UART_Flush(void);
+ *   uint16_t HAL_UART_GetOverruns(void);
+ *   void HAL_UART_ClearOverruns(void);
+ *
+ *   HAL_UART_InitConfig initializes the USART with the frame format and bit
+ *   rate in cfg. Both U2X settings are evaluated and the UBRR/U2X pair with
+ *   the lowest bit rate error is used (cfg->u2x can force either one); the
+ *   bit rate actually achieved is returned. HAL_UART_Init(baud_rate) is the
+ *   8N1 shortcut for it with automatic U2X selection.
+ *
+ *   HAL_UART_TrySend / HAL_UART_TryRead are the non-blocking variants of
+ *   HAL_UART_Send / HAL_UART_Read: they queue (or consume) only what fits
+ *   (or is already received) and return that number of bytes.
+ *   HAL_UART_Available returns the number of received bytes waiting to be
+ *   read (0 or 1 when polling). HAL_UART_GetOverruns returns the number of
+ *   received bytes lost since the last HAL_UART_ClearOverruns, either by a
+ *   hardware data overrun (DOR0) or because the RX ring was full.
+ *
+ * Public types:
+ *   HAL_UART_Config_t
+ *     USART configuration for HAL_UART_InitConfig:
+ *       uint32_t baud       — requested bit rate in bit/s
+ *       uint8_t  data_bits  — 5 to 8
+ *       uint8_t  parity     — HAL_UART_PARITY_NONE / _EVEN / _ODD
+ *       uint8_t  stop_bits  — 1 or 2
+ *       uint8_t  u2x        — HAL_UART_U2X_AUTO / _OFF / _ON
+ *
+ * Public constants:
+ *   HAL_UART_PARITY_NONE, HAL_UART_PARITY_EVEN, HAL_UART_PARITY_ODD
+ *   HAL_UART_U2X_AUTO - pick the U2X setting with the lower error (default)
+ *   HAL_UART_U2X_OFF  - normal speed (16 samples per bit)
+ *   HAL_UART_U2X_ON   - double speed (8 samples per bit)
+ *
+ * Configuration (compile-time, define before building uart-hal.c):
+ *   HAL_UART_USE_ISR         - 1 selects the interrupt-driven mode, 0
+ *                              (default) keeps the polling implementation.
+ *   HAL_UART_RX_BUFFER_SIZE  - RX ring size in bytes (power of two, 2..128,
+ *                              default 64). Only used when HAL_UART_USE_ISR = 1.
+ *   HAL_UART_TX_BUFFER_SIZE  - TX ring size in bytes (power of two, 2..128,
+ *                              default 64). Only used when HAL_UART_USE_ISR = 1.
  *
  * Usage:
  *   - Include the header in your sources: #include "uart-hal.h"
  *   - Call HAL_UART_Init(F_CPU/baud) once during startup, then use transmit/receive.
  *   - The implementation file (uart-hal.c or platform-specific file) must be
  *     added to the project build so the linker can find the symbols.
+ *   - Interrupt-driven mode: build with -DHAL_UART_USE_ISR=1, call
+ *     HAL_UART_Init() and enable global interrupts with sei():
+ *       HAL_UART_Init(9600);
+ *       sei();
+ *       HAL_UART_TrySend(msg, len);           // returns immediately
+ *       if(HAL_UART_Available()) c = HAL_UART_Receive();
+ *   - High bit rates and other frame formats:
+ *       HAL_UART_Config_t cfg = {1000000UL, 8, HAL_UART_PARITY_NONE, 1, HAL_UART_U2X_AUTO};
+ *       uint32_t actual = HAL_UART_InitConfig(&cfg);   // 1000000 at 16 MHz
  *
  * Notes:
  *   - This comment block is intended to live at the top of uart-hal.h and/or
  *     uart-hal.c to identify the file in the uc-Microlab repository.
  *   - For AVR implementations, ensure F_CPU is defined before including
  *     <util/delay.h> or set F_CPU in the project compiler symbols.
+ *   - In interrupt-driven mode the blocking calls (HAL_UART_Transmit,
+ *     HAL_UART_Send, HAL_UART_Receive, HAL_UART_Read) only wait for ring
+ *     space or data. If they are called with global interrupts disabled they
+ *     service the USART by polling, so they never dead-lock.
+ *   - In interrupt-driven mode uart-hal.c owns USART_RX_vect and
+ *     USART_UDRE_vect (and USART_TX_vect when built with HAL_PWR_USE = 1);
+ *     the application must not define these vectors.
+ *   - UBRR is rounded to the nearest value instead of truncated. At 16 MHz:
+ *       115200 -> 117647 (U2X, +2.1 %), 250000 / 500000 / 1000000 exact,
+ *       2000000 exact with U2X. Keep the error within about ±2 % (±1.5 %
+ *       with U2X, which also halves the receiver's noise tolerance).
+ *   - HAL_UART_Init takes an unsigned int, so rates above 65535 bit/s must
+ *     be set with HAL_UART_InitConfig.
  *
  * Author: otavioacb
  * Created: 2025-10-19
@@ -44,6 +111,15 @@
  *   2025-10-19  v0.1  Initial header for uc-Microlab UART HAL
  *   2026-02-16  v0.2  Added receive functions: HAL_UART_Receive, HAL_UART_Read, HAL_UART_Available, HAL_UART_Flush
  *                     Added inline comments for better code documentation
+ *   2026-10-14  v0.3  Added interrupt-driven mode with RX/TX ring buffers (HAL_UART_USE_ISR)
+ *                     Added HAL_UART_TrySend, HAL_UART_TryRead and the overrun counter
+ *                     HAL_UART_Available now returns the number of buffered bytes
+ *   2026-10-14  v0.4  Added HAL_UART_Config_t and HAL_UART_InitConfig (data bits, parity,
+ *                     stop bits, error-minimizing UBRR/U2X selection). HAL_UART_Init now
+ *                     configures 8N1 as documented instead of 2 stop bits
+ *   2026-10-14  v0.5  Power management hooks (power-hal.h): TX holds IDLE until TXC,
+ *                     USART_TX_vect with HAL_PWR_USE
+ *   2026-10-14  v0.6  Cycle trace hooks (trace-hal.h) in USART_RX_vect and USART_UDRE_vect
  *
  */
 
@@ -54,52 +130,347 @@
 #endif
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#include "power-hal.h"
+#include "trace-hal.h"
+
+#define UART_RX_MASK (HAL_UART_RX_BUFFER_SIZE - 1)
+#define UART_TX_MASK (HAL_UART_TX_BUFFER_SIZE - 1)
+
+static volatile uint16_t uart_overruns = 0;
+
+static uint32_t uart_solve(uint32_t baud, uint8_t mode, uint16_t* ubrr, uint8_t* u2x);
+
+#if HAL_UART_USE_ISR
+
+/*
+ * Ring indices are free-running 8-bit counters: the fill level is
+ * (head - tail) and the slot is (index & MASK). Each index is written by
+ * only one side (ISR or application), so no locking is needed as long as
+ * the buffers stay within 128 bytes.
+ */
+static volatile unsigned char uart_rx_buf[HAL_UART_RX_BUFFER_SIZE];
+static volatile uint8_t uart_rx_head = 0;
+static volatile uint8_t uart_rx_tail = 0;
+
+static volatile unsigned char uart_tx_buf[HAL_UART_TX_BUFFER_SIZE];
+static volatile uint8_t uart_tx_head = 0;
+static volatile uint8_t uart_tx_tail = 0;
+
+static void uart_rx_service(void);
+static void uart_tx_service(void);
+static unsigned char uart_irq_enabled(void);
+
+#endif
 
 void HAL_UART_Init(unsigned int baud_rate)
 {
-	unsigned int ubrr = (F_CPU / (16UL * baud_rate)) - 1;
+	HAL_UART_Config_t cfg = {baud_rate, 8, HAL_UART_PARITY_NONE, 1, HAL_UART_U2X_AUTO};
+	
+	HAL_UART_InitConfig(&cfg);
+}
 
+uint32_t HAL_UART_InitConfig(const HAL_UART_Config_t* cfg)
+{
+	uint16_t ubrr = 0;
+	uint8_t  u2x  = 0;
+	uint32_t baud = uart_solve(cfg->baud, cfg->u2x, &ubrr, &u2x);
+	uint8_t  bits = cfg->data_bits;
+	
+	HAL_PWR_CLOCK_ON(HAL_PWR_CLK_UART);
+	
+	if(bits < 5) bits = 5;
+	if(bits > 8) bits = 8;
+	
+	UCSR0B = 0;
+	
 	UBRR0H = (unsigned char) (ubrr >> 8);
 	UBRR0L = (unsigned char) ubrr;
 	
+	UCSR0A = u2x ? (1 << U2X0) : 0;
+	UCSR0C = ((cfg->parity & 0x03) << UPM00) | ((cfg->stop_bits == 2) ? (1 << USBS0) : 0) | ((bits - 5) << UCSZ00);
+	
+#if HAL_UART_USE_ISR
+	uart_rx_head = uart_rx_tail = 0;
+	uart_tx_head = uart_tx_tail = 0;
+	
+	UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+#else
 	UCSR0B = (1 << RXEN0) | (1 << TXEN0);
+#endif
+	
+	uart_overruns = 0;
 	
-	UCSR0C = (1 << USBS0) | (3 << UCSZ00);
+	return baud;
 }
 
 void HAL_UART_Transmit(unsigned char data)
 {
+#if HAL_UART_USE_ISR
+	while(HAL_UART_TrySend(&data, 1) == 0)
+	{
+		if(!uart_irq_enabled()) uart_tx_service();
+	}
+#else
 	while(!(UCSR0A & (1 << UDRE0)));
 	
 	UDR0 = data;
+#endif
 }
 
 void HAL_UART_Send(unsigned char* msg, size_t len_msg)
 {
-	for(int i = 0; i < len_msg; ++i) HAL_UART_Transmit(msg[i]);
+#if HAL_UART_USE_ISR
+	size_t sent = 0;
+	
+	while(sent < len_msg)
+	{
+		sent += HAL_UART_TrySend(msg + sent, len_msg - sent);
+		
+		if(!uart_irq_enabled()) uart_tx_service();
+	}
+#else
+	for(size_t i = 0; i < len_msg; ++i) HAL_UART_Transmit(msg[i]);
+#endif
+}
+
+size_t HAL_UART_TrySend(const unsigned char* msg, size_t len_msg)
+{
+#if HAL_UART_USE_ISR
+	uint8_t head = uart_tx_head;
+	uint8_t space = HAL_UART_TX_BUFFER_SIZE - (uint8_t)(head - uart_tx_tail);
+	size_t   n = (len_msg < space) ? len_msg : space;
+	
+	for(size_t i = 0; i < n; ++i) uart_tx_buf[head++ & UART_TX_MASK] = msg[i];
+	
+	uart_tx_head = head;
+	
+	if(n)
+	{
+		HAL_PWR_HOLD(HAL_PWR_ID_UART, HAL_PWR_IDLE);
+		UCSR0B |= (1 << UDRIE0);
+	}
+	
+	return n;
+#else
+	size_t n = 0;
+	
+	while((n < len_msg) && (UCSR0A & (1 << UDRE0))) UDR0 = msg[n++];
+	
+	return n;
+#endif
 }
 
 unsigned char HAL_UART_Receive(void)
 {
+#if HAL_UART_USE_ISR
+	unsigned char data;
+	
+	while(HAL_UART_TryRead(&data, 1) == 0)
+	{
+		if(!uart_irq_enabled()) uart_rx_service();
+	}
+	
+	return data;
+#else
 	while(!(UCSR0A & (1 << RXC0)));
 	
+	if(UCSR0A & (1 << DOR0)) uart_overruns++;
+	
 	return UDR0;
+#endif
+}
+
+size_t HAL_UART_Read(unsigned char* buf, size_t len)
+{
+	for(size_t i = 0; i < len; ++i) buf[i] = HAL_UART_Receive();
+	
+	return len;
 }
 
-unsigned char HAL_UART_Read(unsigned char* buf, size_t len)
+size_t HAL_UART_TryRead(unsigned char* buf, size_t len)
 {
-	for(int i = 0; i < len; ++i) buf[i] = HAL_UART_Receive();
+#if HAL_UART_USE_ISR
+	uint8_t tail  = uart_rx_tail;
+	uint8_t count = (uint8_t)(uart_rx_head - tail);
+	size_t  n     = (len < count) ? len : count;
+	
+	for(size_t i = 0; i < n; ++i) buf[i] = uart_rx_buf[tail++ & UART_RX_MASK];
+	
+	uart_rx_tail = tail;
+	
+	return n;
+#else
+	size_t n = 0;
+	
+	while((n < len) && (UCSR0A & (1 << RXC0)))
+	{
+		if(UCSR0A & (1 << DOR0)) uart_overruns++;
+		buf[n++] = UDR0;
+	}
+	
+	return n;
+#endif
 }
 
-unsigned char HAL_UART_Available()
+size_t HAL_UART_Available()
 {
-	return (UCSR0A & (1 << RXC0));
+#if HAL_UART_USE_ISR
+	return (uint8_t)(uart_rx_head - uart_rx_tail);
+#else
+	return (UCSR0A & (1 << RXC0)) ? 1 : 0;
+#endif
 }
 
 void HAL_UART_Flush(void)
 {
 	unsigned char rx;
 	
+#if HAL_UART_USE_ISR
+	uart_rx_tail = uart_rx_head;
+#endif
+	
 	while(UCSR0A & (1 << RXC0)) rx = UDR0;
+	
+	(void) rx;
+}
+
+uint16_t HAL_UART_GetOverruns(void)
+{
+	uint16_t count;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) count = uart_overruns;
+	
+	return count;
+}
+
+void HAL_UART_ClearOverruns(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) uart_overruns = 0;
+}
+
+#if HAL_UART_USE_ISR
+
+ISR(USART_RX_vect)
+{
+	HAL_TRACE_ENTER(HAL_TRACE_ID_UART_RX);
+	uart_rx_service();
+	HAL_TRACE_EXIT(HAL_TRACE_ID_UART_RX);
+}
+
+ISR(USART_UDRE_vect)
+{
+	HAL_TRACE_ENTER(HAL_TRACE_ID_UART_TX);
+	uart_tx_service();
+	HAL_TRACE_EXIT(HAL_TRACE_ID_UART_TX);
+}
+
+#if HAL_PWR_USE
+/* Last frame has left the shift register: deep sleep is safe again */
+ISR(USART_TX_vect)
+{
+	UCSR0B &= ~(1 << TXCIE0);
+	
+	if(uart_tx_tail == uart_tx_head) HAL_PWR_DROP(HAL_PWR_ID_UART);
 }
+#endif
 
+/*
+ * Move one received byte from UDR0 into the RX ring. Called from the
+ * RX ISR, or by polling when global interrupts are disabled.
+ */
+static void uart_rx_service(void)
+{
+	if(!(UCSR0A & (1 << RXC0))) return;
+	
+	unsigned char status = UCSR0A;
+	unsigned char data   = UDR0;
+	uint8_t head = uart_rx_head;
+	
+	if(status & (1 << DOR0)) uart_overruns++;
+	
+	if((uint8_t)(head - uart_rx_tail) >= HAL_UART_RX_BUFFER_SIZE)
+	{
+		uart_overruns++;
+		return;
+	}
+	
+	uart_rx_buf[head & UART_RX_MASK] = data;
+	uart_rx_head = head + 1;
+}
+
+/*
+ * Move one byte from the TX ring into UDR0, disabling the UDRE
+ * interrupt once the ring is empty.
+ */
+static void uart_tx_service(void)
+{
+	if(!(UCSR0A & (1 << UDRE0))) return;
+	
+	uint8_t tail = uart_tx_tail;
+	
+	if(tail == uart_tx_head)
+	{
+#if HAL_PWR_USE
+		UCSR0B = (UCSR0B & ~(1 << UDRIE0)) | (1 << TXCIE0);
+#else
+		UCSR0B &= ~(1 << UDRIE0);
+#endif
+		return;
+	}
+	
+#if HAL_PWR_USE
+	/* Clear TXC0 (write one; FE0, DOR0 and UPE0 must be written zero) */
+	UCSR0A = (UCSR0A & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+#endif
+	
+	UDR0 = uart_tx_buf[tail & UART_TX_MASK];
+	uart_tx_tail = tail + 1;
+}
+
+static unsigned char uart_irq_enabled(void)
+{
+	return (SREG & (1 << SREG_I)) ? 1 : 0;
+}
+
+#endif
+
+/*
+ * Evaluate UBRR = round(F_CPU / (div * baud)) - 1 for div = 16 (normal) and
+ * div = 8 (U2X) and keep the pair whose rate is closest to baud. On a tie
+ * normal speed wins, since it samples each bit 16 times instead of 8.
+ */
+static uint32_t uart_solve(uint32_t baud, uint8_t mode, uint16_t* ubrr, uint8_t* u2x)
+{
+	uint32_t best_rate = 0;
+	uint32_t best_err  = 0xFFFFFFFFUL;
+	
+	if(baud == 0) baud = 1;
+	
+	for(uint8_t dbl = 0; dbl < 2; ++dbl)
+	{
+		if(mode == HAL_UART_U2X_OFF && dbl) continue;
+		if(mode == HAL_UART_U2X_ON && !dbl) continue;
+		
+		uint32_t div = (dbl ? 8UL : 16UL) * baud;
+		uint32_t reg = (F_CPU + div / 2UL) / div;
+		
+		if(reg < 1) reg = 1;
+		if(reg > 4096) reg = 4096;
+		
+		uint32_t rate = F_CPU / ((dbl ? 8UL : 16UL) * reg);
+		uint32_t err  = (rate > baud) ? (rate - baud) : (baud - rate);
+		
+		if(err < best_err)
+		{
+			best_err  = err;
+			best_rate = rate;
+			*ubrr = (uint16_t) (reg - 1);
+			*u2x  = dbl;
+		}
+	}
+	
+	return best_rate;
+}
@@ -10,27 +10,94 @@
  *   Minimal, portable UART HAL for AVR (ATmega) and other platforms.
  *   Provides initialization and transmit/receive primitives and a small,
  *   well-documented API surface for embedding in examples and libraries.
+ *   Optionally runs interrupt-driven (USART_RX / USART_UDRE ISRs) on top of
+ *   power-of-two RX/TX ring buffers so transmission and reception no longer
+ *   stall the CPU.
  *
  * Public API (examples of functions that should be declared/implemented):
  *   void HAL_UART_Init(unsigned int baud_rate);
+ *   uint32_t HAL_UART_InitConfig(const HAL_UART_Config_t* cfg);
  *   void HAL_UART_Transmit(unsigned char data);
  *   void HAL_UART_Send(unsigned char* msg, size_t len_msg);
+ *   size_t HAL_UART_TrySend(const unsigned char* msg, size_t len_msg);
  *   unsigned char HAL_UART_Receive(void);
- *   unsigned char HAL_UART_Read(unsigned char* buf, size_t len);
- *   unsigned char HAL_UART_Available();
+ *   size_t HAL_UART_Read(unsigned char* buf, size_t len);
+ *   size_t HAL_UART_TryRead(unsigned char* buf, size_t len);
+ *   size_t HAL_UART_Available();
  *   void HAL_UART_Flush(void);
+ *   uint16_t HAL_UART_GetOverruns(void);
+ *   void HAL_UART_ClearOverruns(void);
+ *
+ *   HAL_UART_InitConfig initializes the USART with the frame format and bit
+ *   rate in cfg. Both U2X settings are evaluated and the UBRR/U2X pair with
+ *   the lowest bit rate error is used (cfg->u2x can force either one); the
+ *   bit rate actually achieved is returned. HAL_UART_Init(baud_rate) is the
+ *   8N1 shortcut for it with automatic U2X selection.
+ *
+ *   HAL_UART_TrySend / HAL_UART_TryRead are the non-blocking variants of
+ *   HAL_UART_Send / HAL_UART_Read: they queue (or consume) only what fits
+ *   (or is already received) and return that number of bytes.
+ *   HAL_UART_Available returns the number of received bytes waiting to be
+ *   read (0 or 1 when polling). HAL_UART_GetOverruns returns the number of
+ *   received bytes lost since the last HAL_UART_ClearOverruns, either by a
+ *   hardware data overrun (DOR0) or because the RX ring was full.
+ *
+ * Public types:
+ *   HAL_UART_Config_t
+ *     USART configuration for HAL_UART_InitConfig:
+ *       uint32_t baud       — requested bit rate in bit/s
+ *       uint8_t  data_bits  — 5 to 8
+ *       uint8_t  parity     — HAL_UART_PARITY_NONE / _EVEN / _ODD
+ *       uint8_t  stop_bits  — 1 or 2
+ *       uint8_t  u2x        — HAL_UART_U2X_AUTO / _OFF / _ON
+ *
+ * Public constants:
+ *   HAL_UART_PARITY_NONE, HAL_UART_PARITY_EVEN, HAL_UART_PARITY_ODD
+ *   HAL_UART_U2X_AUTO - pick the U2X setting with the lower error (default)
+ *   HAL_UART_U2X_OFF  - normal speed (16 samples per bit)
+ *   HAL_UART_U2X_ON   - double speed (8 samples per bit)
+ *
+ * Configuration (compile-time, define before building uart-hal.c):
+ *   HAL_UART_USE_ISR         - 1 selects the interrupt-driven mode, 0
+ *                              (default) keeps the polling implementation.
+ *   HAL_UART_RX_BUFFER_SIZE  - RX ring size in bytes (power of two, 2..128,
+ *                              default 64). Only used when HAL_UART_USE_ISR = 1.
+ *   HAL_UART_TX_BUFFER_SIZE  - TX ring size in bytes (power of two, 2..128,
+ *                              default 64). Only used when HAL_UART_USE_ISR = 1.
  *
  * Usage:
  *   - Include the header in your sources: #include "uart-hal.h"
  *   - Call HAL_UART_Init(F_CPU/baud) once during startup, then use transmit/receive.
  *   - The implementation file (uart-hal.c or platform-specific file) must be
  *     added to the project build so the linker can find the symbols.
+ *   - Interrupt-driven mode: build with -DHAL_UART_USE_ISR=1, call
+ *     HAL_UART_Init() and enable global interrupts with sei():
+ *       HAL_UART_Init(9600);
+ *       sei();
+ *       HAL_UART_TrySend(msg, len);           // returns immediately
+ *       if(HAL_UART_Available()) c = HAL_UART_Receive();
+ *   - High bit rates and other frame formats:
+ *       HAL_UART_Config_t cfg = {1000000UL, 8, HAL_UART_PARITY_NONE, 1, HAL_UART_U2X_AUTO};
+ *       uint32_t actual = HAL_UART_InitConfig(&cfg);   // 1000000 at 16 MHz
  *
  * Notes:
  *   - This comment block is intended to live at the top of uart-hal.h and/or
  *     uart-hal.c to identify the file in the uc-Microlab repository.
  *   - For AVR implementations, ensure F_CPU is defined before including
  *     <util/delay.h> or set F_CPU in the project compiler symbols.
+ *   - In interrupt-driven mode the blocking calls (HAL_UART_Transmit,
+ *     HAL_UART_Send, HAL_UART_Receive, HAL_UART_Read) only wait for ring
+ *     space or data. If they are called with global interrupts disabled they
+ *     service the USART by polling, so they never dead-lock.
+ *   - In interrupt-driven mode uart-hal.c owns USART_RX_vect and
+ *     USART_UDRE_vect (and USART_TX_vect when built with HAL_PWR_USE = 1);
+ *     the application must not define these vectors.
+ *   - UBRR is rounded to the nearest value instead of truncated. At 16 MHz:
+ *       115200 -> 117647 (U2X, +2.1 %), 250000 / 500000 / 1000000 exact,
+ *       2000000 exact with U2X. Keep the error within about ±2 % (±1.5 %
+ *       with U2X, which also halves the receiver's noise tolerance).
+ *   - HAL_UART_Init takes an unsigned int, so rates above 65535 bit/s must
+ *     be set with HAL_UART_InitConfig.
  *
  * Author: otavioacb
  * Created: 2025-10-19
@@ -44,6 +111,15 @@
  *   2025-10-19  v0.1  Initial header for uc-Microlab UART HAL
  *   2026-02-16  v0.2  Added receive functions: HAL_UART_Receive, HAL_UART_Read, HAL_UART_Available, HAL_UART_Flush
  *                     Added inline comments for better code documentation
+ *   2026-10-14  v0.3  Added interrupt-driven mode with RX/TX ring buffers (HAL_UART_USE_ISR)
+ *                     Added HAL_UART_TrySend, HAL_UART_TryRead and the overrun counter
+ *                     HAL_UART_Available now returns the number of buffered bytes
+ *   2026-10-14  v0.4  Added HAL_UART_Config_t and HAL_UART_InitConfig (data bits, parity,
+ *                     stop bits, error-minimizing UBRR/U2X selection). HAL_UART_Init now
+ *                     configures 8N1 as documented instead of 2 stop bits
+ *   2026-10-14  v0.5  Power management hooks (power-hal.h): TX holds IDLE until TXC,
+ *                     USART_TX_vect with HAL_PWR_USE
+ *   2026-10-14  v0.6  Cycle trace hooks (trace-hal.h) in USART_RX_vect and USART_UDRE_vect
  *
  */
 
@@ -51,17 +127,61 @@
 #define UART_HAL_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+#ifndef HAL_UART_USE_ISR
+	#define HAL_UART_USE_ISR 0
+#endif
+
+#ifndef HAL_UART_RX_BUFFER_SIZE
+	#define HAL_UART_RX_BUFFER_SIZE 64
+#endif
+
+#ifndef HAL_UART_TX_BUFFER_SIZE
+	#define HAL_UART_TX_BUFFER_SIZE 64
+#endif
+
+#define HAL_UART_PARITY_NONE 0x00
+#define HAL_UART_PARITY_EVEN 0x02
+#define HAL_UART_PARITY_ODD  0x03
+
+#define HAL_UART_U2X_AUTO    0x00
+#define HAL_UART_U2X_OFF     0x01
+#define HAL_UART_U2X_ON      0x02
+
+#if (HAL_UART_RX_BUFFER_SIZE < 2) || (HAL_UART_RX_BUFFER_SIZE > 128) || (HAL_UART_RX_BUFFER_SIZE & (HAL_UART_RX_BUFFER_SIZE - 1))
+	#error "HAL_UART_RX_BUFFER_SIZE must be a power of two between 2 and 128"
+#endif
+
+#if (HAL_UART_TX_BUFFER_SIZE < 2) || (HAL_UART_TX_BUFFER_SIZE > 128) || (HAL_UART_TX_BUFFER_SIZE & (HAL_UART_TX_BUFFER_SIZE - 1))
+	#error "HAL_UART_TX_BUFFER_SIZE must be a power of two between 2 and 128"
+#endif
+
+typedef struct
+{
+	uint32_t baud;
+	uint8_t data_bits;
+	uint8_t parity;
+	uint8_t stop_bits;
+	uint8_t u2x;
+} HAL_UART_Config_t;
 
 void HAL_UART_Init(unsigned int baud_rate);
+uint32_t HAL_UART_InitConfig(const HAL_UART_Config_t* cfg);
 
 void HAL_UART_Transmit(unsigned char data);
 void HAL_UART_Send(unsigned char* msg, size_t len_msg);
+size_t HAL_UART_TrySend(const unsigned char* msg, size_t len_msg);
 
 unsigned char HAL_UART_Receive(void);
-unsigned char HAL_UART_Read(unsigned char* buf, size_t len);
+size_t HAL_UART_Read(unsigned char* buf, size_t len);
+size_t HAL_UART_TryRead(unsigned char* buf, size_t len);
 
-unsigned char HAL_UART_Available();
+size_t HAL_UART_Available();
 
 void HAL_UART_Flush(void);
 
+uint16_t HAL_UART_GetOverruns(void);
+void HAL_UART_ClearOverruns(void);
+
 #endif
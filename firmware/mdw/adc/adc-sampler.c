@@ -0,0 +1,262 @@
+/*
+ * uc-Microlab — ADC Sampler (header)
+ * File: adc-sampler.h / adc-sampler.c
+ *
+ * Project: uc-MicroLab
+ * Component: ADC continuous sampling engine (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Gap-free capture of one ADC channel on top of the ADC HAL (adc-hal.h).
+ *   The ADC runs in auto-trigger mode (free running or triggered by a
+ *   timer) and every result is stored by the ADC interrupt into one of two
+ *   ping-pong buffers. When a buffer is full the sampler switches to the
+ *   other one and hands the full buffer to the application through a flag
+ *   and an optional callback. Conversions are never stopped to do so.
+ *
+ * Public API:
+ *   void ADC_SMP_Start(uint8_t ch, uint8_t ref, uint8_t pre, uint8_t trigger);
+ *     Configure the ADC for channel ch (HAL_ADC_CH*), reference ref
+ *     (HAL_ADC_AREF / AVCC / INTE) and prescaler pre (HAL_ADC_DF*), reset
+ *     both buffers and start sampling with the auto-trigger source trigger
+ *     (HAL_ADC_TRSC_*). With HAL_ADC_TRSC_FREE the first conversion is
+ *     started here; with a timer trigger the timer must be configured by
+ *     the application. Global interrupts must be enabled by the
+ *     application.
+ *
+ *   void ADC_SMP_Stop(void);
+ *     Stop auto-triggering and disable the ADC interrupt. The buffer being
+ *     filled is discarded.
+ *
+ *   void ADC_SMP_SetCallback(void (*callback)(const uint16_t* buf));
+ *     Register a function called from the ADC interrupt each time a buffer
+ *     of ADC_SMP_BUFFER_LEN samples is full (NULL to remove it). The
+ *     buffer is owned by the application until ADC_SMP_Release is called.
+ *
+ *   const uint16_t* ADC_SMP_GetBuffer(void);
+ *     Return the full buffer waiting for the application, or NULL if none.
+ *
+ *   void ADC_SMP_Release(void);
+ *     Hand the buffer returned by ADC_SMP_GetBuffer (or passed to the
+ *     callback) back to the sampler.
+ *
+ *   uint16_t ADC_SMP_GetOverruns(void);
+ *     Number of buffers dropped because the previous one had not been
+ *     released yet (saturates at 0xFFFF).
+ *
+ *   void ADC_SMP_ClearOverruns(void);
+ *     Reset the overrun counter.
+ *
+ * Configuration (compile-time, define before building adc-sampler.c):
+ *   ADC_SMP_BUFFER_LEN - samples per buffer, 1 to 255 (default 64). Two
+ *                        buffers of 2 * ADC_SMP_BUFFER_LEN bytes each are
+ *                        allocated.
+ *
+ * Usage:
+ *   - Include this header where sampling is required:
+ *       #include "adc-sampler.h"
+ *
+ *   - Sample channel 0 at the full rate (16 MHz / 128 / 13 = 9615 S/s):
+ *       ADC_SMP_Start(HAL_ADC_CH00, HAL_ADC_AVCC, HAL_ADC_DF128, HAL_ADC_TRSC_FREE);
+ *       sei();
+ *
+ *   - Consume buffers in the main loop:
+ *       const uint16_t* buf = ADC_SMP_GetBuffer();
+ *       if(buf)
+ *       {
+ *           process(buf, ADC_SMP_BUFFER_LEN);
+ *           ADC_SMP_Release();
+ *       }
+ *
+ *   - Sample at 1 kS/s, triggered by Timer1 compare match B:
+ *       HAL_CTC_Init(HAL_CTC_SRC_1, HAL_CTC_CH_A, 0, HAL_CTC_CH1_CK_64);
+ *       HAL_CTC_SetValue(HAL_CTC_SRC_1, HAL_CTC_CH_A, 249);
+ *       HAL_CTC_SetValue(HAL_CTC_SRC_1, HAL_CTC_CH_B, 249);
+ *       ADC_SMP_Start(HAL_ADC_CH00, HAL_ADC_AVCC, HAL_ADC_DF64, HAL_ADC_TRSC_T1CP);
+ *
+ * Notes:
+ *   - This module registers its own HAL_ADC_SetCallback handler; no other
+ *     ADC user may run while it is sampling.
+ *   - A timer trigger fires on the rising edge of the timer's interrupt
+ *     flag. The ADC interrupt clears that flag after every sample, so the
+ *     corresponding timer interrupt must not be enabled by the application.
+ *   - Timer1 triggers on compare match B (OCF1B): in CTC mode with OCR1A as
+ *     TOP set OCR1B <= OCR1A.
+ *   - In free-running mode a conversion takes 13 ADC clocks. The ADC
+ *     interrupt must complete within one conversion time (about 1660 CPU
+ *     cycles with HAL_ADC_DF128) so no sample is lost; keep the callback
+ *     short.
+ *   - The first result after ADC_SMP_Start is from a 25-clock initial
+ *     conversion when the ADC was just enabled; it is stored like any other.
+ *   - The channel's digital input buffer (DIDR0) is disabled while sampling
+ *     channels 0 to 5.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for ADC sampler
+ *
+ */
+
+#include "adc-sampler.h"
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+static uint16_t smp_buf[2][ADC_SMP_BUFFER_LEN];
+
+static uint8_t smp_active  = 0;
+static uint8_t smp_idx     = 0;
+static uint8_t smp_trigger = HAL_ADC_TRSC_FREE;
+
+static volatile uint8_t  smp_full = 0;
+static volatile uint8_t  smp_full_buf = 0;
+static volatile uint16_t smp_overruns = 0;
+
+static void (*volatile smp_callback)(const uint16_t* buf) = NULL;
+
+static void smp_on_sample(uint16_t value);
+static void smp_clear_trigger(void);
+
+void ADC_SMP_Start(uint8_t ch, uint8_t ref, uint8_t pre, uint8_t trigger)
+{
+	ADC_SMP_Stop();
+	
+	HAL_ADC_SetReference(ref);
+	HAL_ADC_SetAdjustment(HAL_ADC_RIGHT);
+	HAL_ADC_SetChannel(ch);
+	HAL_ADC_SetPrescaler(pre);
+	
+	if(ch < 6) HAL_ADC_DisableChannel(ch);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		smp_active  = 0;
+		smp_idx     = 0;
+		smp_full    = 0;
+		smp_trigger = trigger & HAL_ADC_TRSC_MASK;
+	}
+	
+	HAL_ADC_SetCallback(smp_on_sample);
+	
+	/* Drop a result left over from before the start */
+	ADCSRA |= (1 << ADIF);
+	
+	HAL_ADC_Enable();
+	HAL_ADC_EnableInterrupt();
+	HAL_ADC_StartAutoTrigger(smp_trigger);
+	
+	if(smp_trigger == HAL_ADC_TRSC_FREE) HAL_ADC_StartConversion();
+}
+
+void ADC_SMP_Stop(void)
+{
+	HAL_ADC_StopAutoTrigger();
+	HAL_ADC_DisableInterrupt();
+}
+
+void ADC_SMP_SetCallback(void (*callback)(const uint16_t* buf))
+{
+	smp_callback = callback;
+}
+
+const uint16_t* ADC_SMP_GetBuffer(void)
+{
+	return smp_full ? smp_buf[smp_full_buf] : NULL;
+}
+
+void ADC_SMP_Release(void)
+{
+	smp_full = 0;
+}
+
+uint16_t ADC_SMP_GetOverruns(void)
+{
+	uint16_t overruns;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		overruns = smp_overruns;
+	}
+	
+	return overruns;
+}
+
+void ADC_SMP_ClearOverruns(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		smp_overruns = 0;
+	}
+}
+
+/*
+ * Called from ADC_vect with every result. A full buffer is only handed
+ * over if the application has released the previous one; otherwise the
+ * active buffer is refilled and the block is counted as an overrun, so the
+ * buffer the application is reading is never written.
+ */
+static void smp_on_sample(uint16_t value)
+{
+	smp_clear_trigger();
+	
+	smp_buf[smp_active][smp_idx] = value;
+	
+	if(++smp_idx < ADC_SMP_BUFFER_LEN) return;
+	
+	smp_idx = 0;
+	
+	if(smp_full)
+	{
+		if(smp_overruns != 0xFFFF) ++smp_overruns;
+		return;
+	}
+	
+	smp_full_buf = smp_active;
+	smp_full     = 1;
+	smp_active  ^= 1;
+	
+	void (*callback)(const uint16_t* buf) = smp_callback;
+	
+	if(callback) callback(smp_buf[smp_full_buf]);
+}
+
+/*
+ * The ADC starts on the rising edge of the trigger's interrupt flag. No
+ * timer ISR clears it, so it is cleared here to arm the next trigger.
+ */
+static void smp_clear_trigger(void)
+{
+	switch(smp_trigger)
+	{
+		case HAL_ADC_TRSC_COMP:
+			ACSR |= (1 << ACI);
+			break;
+		case HAL_ADC_TRSC_EXIN:
+			EIFR = (1 << INTF0);
+			break;
+		case HAL_ADC_TRSC_T0CP:
+			TIFR0 = (1 << OCF0A);
+			break;
+		case HAL_ADC_TRSC_T0OV:
+			TIFR0 = (1 << TOV0);
+			break;
+		case HAL_ADC_TRSC_T1CP:
+			TIFR1 = (1 << OCF1B);
+			break;
+		case HAL_ADC_TRSC_T1OV:
+			TIFR1 = (1 << TOV1);
+			break;
+		case HAL_ADC_TRSC_T1EV:
+			TIFR1 = (1 << ICF1);
+			break;
+		default:
+			break;
+	}
+}
@@ -0,0 +1,281 @@
+/*
+ * uc-Microlab — ADC Scan Sequencer (header)
+ * File: adc-scan.h / adc-scan.c
+ *
+ * Project: uc-MicroLab
+ * Component: ADC multi-channel scan sequencer (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Background scan of a list of ADC inputs on top of the ADC HAL
+ *   (adc-hal.h). The ADC interrupt switches ADMUX to the next entry,
+ *   discards the settling conversions after each switch, optionally
+ *   accumulates 4^n samples per entry for n extra bits of resolution and
+ *   stores the result in a per-entry result array. The main loop reads all
+ *   results with one short atomic copy.
+ *
+ * Public API:
+ *   uint8_t ADC_SCAN_Start(const ADC_SCAN_Entry_t* list,
+ *                          uint8_t count,
+ *                          uint8_t pre);
+ *     Copy count entries (1 to ADC_SCAN_MAX_CHANNELS) from list, configure
+ *     the ADC with prescaler pre (HAL_ADC_DF*) and start scanning. Returns
+ *     1 on success, 0 if count is out of range. Global interrupts must be
+ *     enabled by the application.
+ *
+ *   void ADC_SCAN_Stop(void);
+ *     Stop scanning after the conversion in progress.
+ *
+ *   uint16_t ADC_SCAN_Read(uint16_t* results);
+ *     Copy the latest result of every entry into results (count values, in
+ *     list order) with interrupts briefly masked. Returns the number of
+ *     complete sweeps so far (wraps at 0xFFFF), so a caller can tell
+ *     whether new data arrived since the previous call.
+ *
+ *   uint16_t ADC_SCAN_Get(uint8_t idx);
+ *     Read the latest result of entry idx atomically (0 if out of range).
+ *
+ *   void ADC_SCAN_SetCallback(void (*callback)(void));
+ *     Register a function called from the ADC interrupt at the end of each
+ *     sweep (NULL to remove it).
+ *
+ * Public types:
+ *   ADC_SCAN_Entry_t
+ *     One entry of the scan list:
+ *       uint8_t ch   — input (HAL_ADC_CH*, HAL_ADC_TEMP, HAL_ADC_VBG)
+ *       uint8_t ref  — reference (HAL_ADC_AREF / AVCC / INTE)
+ *       uint8_t os   — oversampling exponent n, 0 to 6: 4^n samples are
+ *                      summed and shifted right by n, giving a
+ *                      (10 + n)-bit result
+ *
+ * Public constants:
+ *   ADC_SCAN_OS_MAX - largest oversampling exponent (6, 16-bit result)
+ *
+ * Configuration (compile-time, define before building adc-scan.c):
+ *   ADC_SCAN_MAX_CHANNELS - size of the entry table and result array
+ *                           (default 8).
+ *   ADC_SCAN_SETTLE       - conversions discarded after a channel switch
+ *                           (default 1).
+ *   ADC_SCAN_SETTLE_REF   - conversions discarded after a reference switch
+ *                           (default 4).
+ *
+ * Usage:
+ *   - Include this header where scanning is required:
+ *       #include "adc-scan.h"
+ *
+ *   - Scan three sensors and the internal temperature:
+ *       static const ADC_SCAN_Entry_t list[] =
+ *       {
+ *           {HAL_ADC_CH00, HAL_ADC_AVCC, 0},
+ *           {HAL_ADC_CH01, HAL_ADC_AVCC, 2},    // 12-bit result
+ *           {HAL_ADC_CH03, HAL_ADC_AVCC, 0},
+ *           {HAL_ADC_TEMP, HAL_ADC_INTE, 3},    // 13-bit result
+ *       };
+ *       ADC_SCAN_Start(list, 4, HAL_ADC_DF128);
+ *       sei();
+ *
+ *   - Read all results in the main loop:
+ *       uint16_t values[4];
+ *       ADC_SCAN_Read(values);
+ *
+ * Notes:
+ *   - This module registers its own HAL_ADC_SetCallback handler; no other
+ *     ADC user may run while it is scanning.
+ *   - Conversions run in single-conversion mode and the next one is
+ *     started from the interrupt right after ADMUX is written, so a
+ *     conversion never straddles a channel switch.
+ *   - Oversampling only adds resolution when the input carries at least
+ *     1 LSB of noise. With HAL_ADC_DF128 each sample takes about 104 µs,
+ *     so an entry with os = 6 (4096 samples) takes about 0.43 s.
+ *   - When switching to the internal 1.1 V reference with a capacitor on
+ *     AREF the reference needs far longer than ADC_SCAN_SETTLE_REF
+ *     conversions to settle; avoid mixing references in one list in that
+ *     case.
+ *   - The temperature sensor must be read with HAL_ADC_INTE.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for ADC scan sequencer
+ *
+ */
+
+#include "adc-scan.h"
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+static ADC_SCAN_Entry_t scan_list[ADC_SCAN_MAX_CHANNELS];
+static uint16_t scan_result[ADC_SCAN_MAX_CHANNELS];
+
+static uint8_t  scan_count  = 0;
+static uint8_t  scan_idx    = 0;
+static uint8_t  scan_settle = 0;
+static uint16_t scan_left   = 0;
+static uint32_t scan_acc    = 0;
+
+static volatile uint8_t  scan_running = 0;
+static volatile uint16_t scan_sweeps  = 0;
+
+static void (*volatile scan_callback)(void) = NULL;
+
+static void scan_on_sample(uint16_t value);
+static void scan_select(uint8_t idx, uint8_t settle);
+
+uint8_t ADC_SCAN_Start(const ADC_SCAN_Entry_t* list, uint8_t count, uint8_t pre)
+{
+	if(count == 0 || count > ADC_SCAN_MAX_CHANNELS) return 0U;
+	
+	ADC_SCAN_Stop();
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(uint8_t i = 0; i < count; ++i)
+		{
+			scan_list[i] = list[i];
+			if(scan_list[i].os > ADC_SCAN_OS_MAX) scan_list[i].os = ADC_SCAN_OS_MAX;
+			
+			scan_result[i] = 0;
+		}
+		
+		scan_count  = count;
+		scan_sweeps = 0;
+		
+		/* The previous ADMUX setting is unknown: settle as for a new reference */
+		scan_select(0, ADC_SCAN_SETTLE_REF);
+		
+		scan_running = 1;
+	}
+	
+	for(uint8_t i = 0; i < count; ++i)
+	{
+		if(list[i].ch < 6) HAL_ADC_DisableChannel(list[i].ch);
+	}
+	
+	HAL_ADC_SetAdjustment(HAL_ADC_RIGHT);
+	HAL_ADC_SetPrescaler(pre);
+	HAL_ADC_SetCallback(scan_on_sample);
+	
+	ADCSRA |= (1 << ADIF);
+	
+	HAL_ADC_Enable();
+	HAL_ADC_EnableInterrupt();
+	HAL_ADC_StartConversion();
+	
+	return 1U;
+}
+
+void ADC_SCAN_Stop(void)
+{
+	scan_running = 0;
+	
+	while(HAL_ADC_isRunning());
+	
+	HAL_ADC_DisableInterrupt();
+}
+
+uint16_t ADC_SCAN_Read(uint16_t* results)
+{
+	uint16_t sweeps;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for(uint8_t i = 0; i < scan_count; ++i) results[i] = scan_result[i];
+		
+		sweeps = scan_sweeps;
+	}
+	
+	return sweeps;
+}
+
+uint16_t ADC_SCAN_Get(uint8_t idx)
+{
+	uint16_t value = 0;
+	
+	if(idx >= ADC_SCAN_MAX_CHANNELS) return 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = scan_result[idx];
+	}
+	
+	return value;
+}
+
+void ADC_SCAN_SetCallback(void (*callback)(void))
+{
+	scan_callback = callback;
+}
+
+/*
+ * Called from ADC_vect. ADMUX for the next conversion is always written
+ * before ADSC is set again, so every result belongs to scan_list[scan_idx].
+ */
+static void scan_on_sample(uint16_t value)
+{
+	if(!scan_running) return;
+	
+	if(scan_settle)
+	{
+		--scan_settle;
+		HAL_ADC_StartConversion();
+		return;
+	}
+	
+	scan_acc += value;
+	
+	if(--scan_left)
+	{
+		HAL_ADC_StartConversion();
+		return;
+	}
+	
+	const ADC_SCAN_Entry_t* e = &scan_list[scan_idx];
+	
+	scan_result[scan_idx] = (uint16_t) (scan_acc >> e->os);
+	
+	uint8_t next = scan_idx + 1;
+	
+	if(next >= scan_count) next = 0;
+	
+	if(next == scan_idx)
+	{
+		/* Single entry: the input does not change, nothing to settle */
+		scan_select(next, 0);
+	}
+	else
+	{
+		uint8_t ref_changed = (scan_list[next].ref != e->ref);
+		
+		scan_select(next, ref_changed ? ADC_SCAN_SETTLE_REF : ADC_SCAN_SETTLE);
+	}
+	
+	if(next == 0)
+	{
+		++scan_sweeps;
+		
+		void (*callback)(void) = scan_callback;
+		
+		if(callback) callback();
+	}
+	
+	HAL_ADC_StartConversion();
+}
+
+static void scan_select(uint8_t idx, uint8_t settle)
+{
+	const ADC_SCAN_Entry_t* e = &scan_list[idx];
+	
+	scan_idx    = idx;
+	scan_settle = settle;
+	scan_acc    = 0;
+	scan_left   = (uint16_t) 1U << (2U * e->os);
+	
+	HAL_ADC_SetMux(e->ref, e->ch);
+}
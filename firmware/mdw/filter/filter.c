@@ -0,0 +1,250 @@
+/*
+ * uc-Microlab — Integer Filters (header)
+ * File: filter.h / filter.c
+ *
+ * Project: uc-MicroLab
+ * Component: Sliding-window filters for sample streams (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Small integer filters for ADC sample streams: a moving average over a
+ *   power-of-two window kept as a running sum, an exponential moving
+ *   average with a shift-only coefficient and a median of N samples kept
+ *   incrementally sorted. Every update is O(1) (O(N) element moves for
+ *   the median) and uses no division, so the filters can run inside
+ *   ADC_vect one sample at a time, or over a full buffer handed over by
+ *   the ADC sampler (adc-sampler.h).
+ *
+ * Public API:
+ *   void FLT_MA_Init(FLT_MA_t* f, uint16_t* buf, uint8_t shift, uint16_t initial);
+ *     Set up a moving average over 2^shift samples (shift 0 to 8) using
+ *     buf (2^shift elements, owned by the caller) as the window. The
+ *     window is pre-filled with initial, so the output is valid from the
+ *     first sample.
+ *
+ *   uint16_t FLT_MA_Update(FLT_MA_t* f, uint16_t x);
+ *     Push sample x and return the mean of the last 2^shift samples.
+ *
+ *   void FLT_EMA_Init(FLT_EMA_t* f, uint8_t k, uint16_t initial);
+ *     Set up an exponential moving average y += (x - y) / 2^k (k 0 to 15).
+ *     The state keeps k fraction bits, so small steps are not lost to
+ *     truncation.
+ *
+ *   uint16_t FLT_EMA_Update(FLT_EMA_t* f, uint16_t x);
+ *     Push sample x and return the filtered value.
+ *
+ *   void FLT_MED_Init(FLT_MED_t* f,
+ *                     uint16_t* ring,
+ *                     uint16_t* sorted,
+ *                     uint8_t n,
+ *                     uint16_t initial);
+ *     Set up a running median of n samples (1 to 255, odd recommended)
+ *     using ring and sorted (n elements each, owned by the caller), both
+ *     pre-filled with initial.
+ *
+ *   uint16_t FLT_MED_Update(FLT_MED_t* f, uint16_t x);
+ *     Push sample x and return the median of the last n samples (the upper
+ *     median when n is even).
+ *
+ *   uint16_t FLT_MA_Feed(FLT_MA_t* f, const uint16_t* in, uint16_t len);
+ *   uint16_t FLT_EMA_Feed(FLT_EMA_t* f, const uint16_t* in, uint16_t len);
+ *   uint16_t FLT_MED_Feed(FLT_MED_t* f, const uint16_t* in, uint16_t len);
+ *     Push len samples from in (e.g. a buffer from ADC_SMP_GetBuffer) and
+ *     return the output after the last one.
+ *
+ * Public types:
+ *   FLT_MA_t  — moving-average state (window pointer, running sum, index)
+ *   FLT_EMA_t — exponential moving-average state (scaled accumulator)
+ *   FLT_MED_t — running-median state (ring and sorted window pointers)
+ *   The members are private to filter.c; set them up with the Init calls.
+ *
+ * Public constants:
+ *   FLT_MA_SHIFT_MAX  - largest moving-average window exponent (8)
+ *   FLT_EMA_SHIFT_MAX - largest EMA coefficient exponent (15)
+ *
+ * Usage:
+ *   - Include this header where filtering is required:
+ *       #include "filter.h"
+ *
+ *   - Smooth every result inside the ADC interrupt:
+ *       static uint16_t window[16];
+ *       static FLT_MA_t avg;
+ *       static volatile uint16_t smooth;
+ *
+ *       static void on_sample(uint16_t value)
+ *       {
+ *           smooth = FLT_MA_Update(&avg, value);
+ *       }
+ *
+ *       FLT_MA_Init(&avg, window, 4, 0);
+ *       HAL_ADC_SetCallback(on_sample);
+ *
+ *   - Remove spikes from sampler buffers:
+ *       static uint16_t ring[5], sorted[5];
+ *       static FLT_MED_t med;
+ *       FLT_MED_Init(&med, ring, sorted, 5, 512);
+ *       ...
+ *       const uint16_t* buf = ADC_SMP_GetBuffer();
+ *       if(buf)
+ *       {
+ *           uint16_t v = FLT_MED_Feed(&med, buf, ADC_SMP_BUFFER_LEN);
+ *           ADC_SMP_Release();
+ *       }
+ *
+ * Notes:
+ *   - Each filter instance only touches its own state; instances may be
+ *     updated from interrupt context as long as a given instance is not
+ *     updated from two contexts at once.
+ *   - The moving-average sum is 32 bits wide, so 16-bit samples are safe
+ *     for any window up to 2^8.
+ *   - The EMA accumulator holds y << k, which fits 32 bits for k <= 15; its
+ *     -3 dB point is roughly fs / (2 * pi * 2^k) for sample rate fs.
+ *   - A median update costs one search plus at most n - 1 element moves;
+ *     keep n small (3 to 15) when updating from an ISR.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for integer filters
+ *
+ */
+
+#include "filter.h"
+
+void FLT_MA_Init(FLT_MA_t* f, uint16_t* buf, uint8_t shift, uint16_t initial)
+{
+	if(shift > FLT_MA_SHIFT_MAX) shift = FLT_MA_SHIFT_MAX;
+	
+	uint16_t len = (uint16_t) 1U << shift;
+	
+	for(uint16_t i = 0; i < len; ++i) buf[i] = initial;
+	
+	f->buf   = buf;
+	f->sum   = (uint32_t) initial << shift;
+	f->idx   = 0;
+	f->mask  = (uint8_t) (len - 1U);
+	f->shift = shift;
+}
+
+/*
+ * The oldest sample leaves the running sum as the new one enters it, so
+ * the window is never summed again.
+ */
+uint16_t FLT_MA_Update(FLT_MA_t* f, uint16_t x)
+{
+	uint16_t* slot = &f->buf[f->idx];
+	
+	f->sum  = f->sum - *slot + x;
+	*slot   = x;
+	f->idx  = (f->idx + 1) & f->mask;
+	
+	return (uint16_t) (f->sum >> f->shift);
+}
+
+uint16_t FLT_MA_Feed(FLT_MA_t* f, const uint16_t* in, uint16_t len)
+{
+	uint16_t y = (uint16_t) (f->sum >> f->shift);
+	
+	for(uint16_t i = 0; i < len; ++i) y = FLT_MA_Update(f, in[i]);
+	
+	return y;
+}
+
+void FLT_EMA_Init(FLT_EMA_t* f, uint8_t k, uint16_t initial)
+{
+	if(k > FLT_EMA_SHIFT_MAX) k = FLT_EMA_SHIFT_MAX;
+	
+	f->k   = k;
+	f->acc = (uint32_t) initial << k;
+}
+
+/*
+ * acc holds y << k: acc += x - (acc >> k) is y += (x - y) / 2^k with k
+ * fraction bits kept. Written as acc - (acc >> k) + x the intermediate
+ * never goes negative.
+ */
+uint16_t FLT_EMA_Update(FLT_EMA_t* f, uint16_t x)
+{
+	f->acc = f->acc - (f->acc >> f->k) + x;
+	
+	return (uint16_t) (f->acc >> f->k);
+}
+
+uint16_t FLT_EMA_Feed(FLT_EMA_t* f, const uint16_t* in, uint16_t len)
+{
+	uint16_t y = (uint16_t) (f->acc >> f->k);
+	
+	for(uint16_t i = 0; i < len; ++i) y = FLT_EMA_Update(f, in[i]);
+	
+	return y;
+}
+
+void FLT_MED_Init(FLT_MED_t* f, uint16_t* ring, uint16_t* sorted, uint8_t n, uint16_t initial)
+{
+	if(n == 0) n = 1;
+	
+	for(uint8_t i = 0; i < n; ++i)
+	{
+		ring[i]   = initial;
+		sorted[i] = initial;
+	}
+	
+	f->ring   = ring;
+	f->sorted = sorted;
+	f->n      = n;
+	f->idx    = 0;
+}
+
+/*
+ * The sample leaving the window is located in the sorted copy and its
+ * slot is slid towards the position of the new sample, so the array stays
+ * sorted with a single partial pass instead of a full sort.
+ */
+uint16_t FLT_MED_Update(FLT_MED_t* f, uint16_t x)
+{
+	uint16_t* s = f->sorted;
+	uint8_t   n = f->n;
+	uint16_t old = f->ring[f->idx];
+	uint8_t   p = 0;
+	
+	f->ring[f->idx] = x;
+	if(++f->idx >= n) f->idx = 0;
+	
+	while(s[p] != old) ++p;
+	
+	if(x > old)
+	{
+		while(p + 1 < n && s[p + 1] < x)
+		{
+			s[p] = s[p + 1];
+			++p;
+		}
+	}
+	else
+	{
+		while(p > 0 && s[p - 1] > x)
+		{
+			s[p] = s[p - 1];
+			--p;
+		}
+	}
+	
+	s[p] = x;
+	
+	return s[n >> 1];
+}
+
+uint16_t FLT_MED_Feed(FLT_MED_t* f, const uint16_t* in, uint16_t len)
+{
+	uint16_t y = f->sorted[f->n >> 1];
+	
+	for(uint16_t i = 0; i < len; ++i) y = FLT_MED_Update(f, in[i]);
+	
+	return y;
+}
@@ -0,0 +1,245 @@
+/*
+ * uc-Microlab — Wear-Leveled Record Store (header)
+ * File: nvstore.h / nvstore.c
+ *
+ * Project: uc-MicroLab
+ * Component: Log-structured EEPROM record store (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Keeps one fixed-size record (a configuration block, a counter, ...) in
+ *   an EEPROM region split into slots, on top of the EEPROM HAL
+ *   (eeprom-hal.h). Every save goes to the slot after the current one with
+ *   an incremented sequence number and a CRC-16, so the writes rotate over
+ *   the whole region instead of wearing out one address. On start-up the
+ *   slot with a valid CRC and the newest sequence number is the current
+ *   record; a save torn by a reset leaves the previous record intact.
+ *
+ * Public API:
+ *   uint8_t NVS_Init(NVS_Store_t* s, uint16_t base, uint8_t slots, uint8_t size);
+ *     Describe a store of slots slots (2 to 255) holding size-byte records
+ *     (1 to NVS_MAX_SIZE) from EEPROM address base, and scan it for the
+ *     current record. Returns NVS_ST_OK if a record was found,
+ *     NVS_ST_EMPTY if none was, NVS_ST_RANGE if the geometry is invalid or
+ *     the region does not fit in the EEPROM.
+ *
+ *   uint8_t NVS_Read(const NVS_Store_t* s, void* data);
+ *     Copy the current record into data (size bytes). Returns NVS_ST_OK or
+ *     NVS_ST_EMPTY (data untouched).
+ *
+ *   uint8_t NVS_Write(NVS_Store_t* s, const void* data);
+ *     Store data as the new current record. Nothing is written when data
+ *     equals the current record. The slot is read back after programming;
+ *     returns NVS_ST_OK, or NVS_ST_VERIFY if the read-back failed (the
+ *     previous record stays current).
+ *
+ *   void NVS_Format(NVS_Store_t* s);
+ *     Invalidate every slot; the store becomes empty.
+ *
+ *   uint16_t NVS_GetSeq(const NVS_Store_t* s);
+ *     Sequence number of the current record (number of saves, wrapping).
+ *
+ * Public types:
+ *   NVS_Store_t — store descriptor (region, geometry and current slot). The
+ *                 members are private to nvstore.c; set it up with NVS_Init.
+ *
+ * Public constants:
+ *   NVS_ST_OK     - success
+ *   NVS_ST_EMPTY  - no valid record in the store
+ *   NVS_ST_RANGE  - invalid geometry
+ *   NVS_ST_VERIFY - read-back after a write did not match
+ *   NVS_MAX_SIZE  - largest record size in bytes (250)
+ *   NVS_SLOT_SIZE(size) - EEPROM bytes per slot for a size-byte record
+ *
+ * Usage:
+ *   - Include this header where persistent records are required:
+ *       #include "nvstore.h"
+ *
+ *   - Keep a boot counter in 16 slots at the end of the EEPROM:
+ *       static NVS_Store_t store;
+ *       uint32_t boots = 0;
+ *
+ *       NVS_Init(&store, HAL_EEPROM_SIZE - 16 * NVS_SLOT_SIZE(4), 16, 4);
+ *       NVS_Read(&store, &boots);
+ *       boots++;
+ *       NVS_Write(&store, &boots);
+ *
+ * Notes:
+ *   - Slot layout: sequence number (2 bytes, little-endian), record (size
+ *     bytes), CRC-16/CCITT-FALSE over sequence number and record (2 bytes).
+ *   - Each slot is programmed once every slots saves, so the store lasts
+ *     roughly slots times the cell endurance (about 100,000 cycles).
+ *   - Slots are programmed with HAL_EEPROM_UpdateBlock, so bytes that
+ *     already hold the right value are skipped.
+ *   - NVS_Init reads the whole region once (slots * (size + 4) bytes).
+ *   - A store instance is not reentrant; use it from one context only and
+ *     do not let two stores overlap.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for wear-leveled record store
+ *
+ */
+
+#include "nvstore.h"
+
+#include <util/crc16.h>
+
+/* Erased EEPROM reads 0xFF: a slot with this sequence number is never valid */
+#define NVS_SEQ_ERASED 0xFFFFU
+
+static uint16_t nvs_addr(const NVS_Store_t* s, uint8_t slot);
+static uint8_t nvs_check(const NVS_Store_t* s, uint8_t slot, uint16_t* seq);
+static uint8_t nvs_equal(const NVS_Store_t* s, uint8_t slot, const unsigned char* data);
+
+uint8_t NVS_Init(NVS_Store_t* s, uint16_t base, uint8_t slots, uint8_t size)
+{
+	uint16_t seq;
+	
+	s->valid = 0;
+	
+	if(slots < 2 || size == 0 || size > NVS_MAX_SIZE) return NVS_ST_RANGE;
+	if((uint32_t) base + (uint32_t) slots * NVS_SLOT_SIZE(size) > HAL_EEPROM_SIZE) return NVS_ST_RANGE;
+	
+	s->base    = base;
+	s->slots   = slots;
+	s->size    = size;
+	s->current = 0;
+	s->seq     = 0;
+	
+	for(uint8_t i = 0; i < slots; ++i)
+	{
+		if(!nvs_check(s, i, &seq)) continue;
+		
+		/* Serial-number comparison, so the newest record wins across a wrap */
+		if(!s->valid || (int16_t) (seq - s->seq) > 0)
+		{
+			s->current = i;
+			s->seq     = seq;
+			s->valid   = 1;
+		}
+	}
+	
+	return s->valid ? NVS_ST_OK : NVS_ST_EMPTY;
+}
+
+uint8_t NVS_Read(const NVS_Store_t* s, void* data)
+{
+	if(!s->valid) return NVS_ST_EMPTY;
+	
+	HAL_EEPROM_Get(nvs_addr(s, s->current) + 2U, (unsigned char*) data, s->size);
+	
+	return NVS_ST_OK;
+}
+
+uint8_t NVS_Write(NVS_Store_t* s, const void* data)
+{
+	const unsigned char* rec = (const unsigned char*) data;
+	uint8_t  slot = 0;
+	uint16_t seq  = 0;
+	uint16_t crc  = 0xFFFF;
+	uint16_t check;
+	
+	if(s->slots == 0) return NVS_ST_RANGE;
+	
+	if(s->valid)
+	{
+		if(nvs_equal(s, s->current, rec)) return NVS_ST_OK;
+		
+		slot = (uint8_t) ((s->current + 1U) % s->slots);
+		seq  = (uint16_t) (s->seq + 1U);
+		
+		if(seq == NVS_SEQ_ERASED) seq = 0;
+	}
+	
+	uint16_t addr = nvs_addr(s, slot);
+	
+	crc = _crc_xmodem_update(crc, (uint8_t) seq);
+	crc = _crc_xmodem_update(crc, (uint8_t) (seq >> 8));
+	for(uint8_t i = 0; i < s->size; ++i) crc = _crc_xmodem_update(crc, rec[i]);
+	
+	/* Sequence number, record, CRC last: a torn write never passes the CRC */
+	HAL_EEPROM_Update(addr, (unsigned char) seq);
+	HAL_EEPROM_Update(addr + 1U, (unsigned char) (seq >> 8));
+	HAL_EEPROM_UpdateBlock(addr + 2U, rec, s->size);
+	HAL_EEPROM_Update(addr + 2U + s->size, (unsigned char) crc);
+	HAL_EEPROM_Update(addr + 3U + s->size, (unsigned char) (crc >> 8));
+	
+	if(!nvs_check(s, slot, &check) || check != seq || !nvs_equal(s, slot, rec)) return NVS_ST_VERIFY;
+	
+	s->current = slot;
+	s->seq     = seq;
+	s->valid   = 1;
+	
+	return NVS_ST_OK;
+}
+
+void NVS_Format(NVS_Store_t* s)
+{
+	for(uint8_t i = 0; i < s->slots; ++i)
+	{
+		uint16_t addr = nvs_addr(s, i);
+		
+		HAL_EEPROM_Update(addr, 0xFF);
+		HAL_EEPROM_Update(addr + 1U, 0xFF);
+	}
+	
+	s->current = 0;
+	s->seq     = 0;
+	s->valid   = 0;
+}
+
+uint16_t NVS_GetSeq(const NVS_Store_t* s)
+{
+	return s->seq;
+}
+
+static uint16_t nvs_addr(const NVS_Store_t* s, uint8_t slot)
+{
+	return s->base + (uint16_t) slot * NVS_SLOT_SIZE(s->size);
+}
+
+/*
+ * Return 1 if slot holds a record with a matching CRC and store its
+ * sequence number in seq.
+ */
+static uint8_t nvs_check(const NVS_Store_t* s, uint8_t slot, uint16_t* seq)
+{
+	uint16_t addr = nvs_addr(s, slot);
+	uint16_t crc  = 0xFFFF;
+	uint8_t  lo   = HAL_EEPROM_Read(addr);
+	uint8_t  hi   = HAL_EEPROM_Read(addr + 1U);
+	
+	*seq = (uint16_t) lo | ((uint16_t) hi << 8);
+	
+	if(*seq == NVS_SEQ_ERASED) return 0;
+	
+	crc = _crc_xmodem_update(crc, lo);
+	crc = _crc_xmodem_update(crc, hi);
+	
+	addr += 2U;
+	for(uint8_t i = 0; i < s->size; ++i) crc = _crc_xmodem_update(crc, HAL_EEPROM_Read(addr++));
+	
+	uint16_t stored = (uint16_t) HAL_EEPROM_Read(addr) | ((uint16_t) HAL_EEPROM_Read(addr + 1U) << 8);
+	
+	return crc == stored;
+}
+
+static uint8_t nvs_equal(const NVS_Store_t* s, uint8_t slot, const unsigned char* data)
+{
+	uint16_t addr = nvs_addr(s, slot) + 2U;
+	
+	for(uint8_t i = 0; i < s->size; ++i)
+	{
+		if(HAL_EEPROM_Read(addr++) != data[i]) return 0;
+	}
+	
+	return 1;
+}
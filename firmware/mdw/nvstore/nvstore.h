@@ -0,0 +1,124 @@
+/*
+ * uc-Microlab — Wear-Leveled Record Store (header)
+ * File: nvstore.h / nvstore.c
+ *
+ * Project: uc-MicroLab
+ * Component: Log-structured EEPROM record store (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Keeps one fixed-size record (a configuration block, a counter, ...) in
+ *   an EEPROM region split into slots, on top of the EEPROM HAL
+ *   (eeprom-hal.h). Every save goes to the slot after the current one with
+ *   an incremented sequence number and a CRC-16, so the writes rotate over
+ *   the whole region instead of wearing out one address. On start-up the
+ *   slot with a valid CRC and the newest sequence number is the current
+ *   record; a save torn by a reset leaves the previous record intact.
+ *
+ * Public API:
+ *   uint8_t NVS_Init(NVS_Store_t* s, uint16_t base, uint8_t slots, uint8_t size);
+ *     Describe a store of slots slots (2 to 255) holding size-byte records
+ *     (1 to NVS_MAX_SIZE) from EEPROM address base, and scan it for the
+ *     current record. Returns NVS_ST_OK if a record was found,
+ *     NVS_ST_EMPTY if none was, NVS_ST_RANGE if the geometry is invalid or
+ *     the region does not fit in the EEPROM.
+ *
+ *   uint8_t NVS_Read(const NVS_Store_t* s, void* data);
+ *     Copy the current record into data (size bytes). Returns NVS_ST_OK or
+ *     NVS_ST_EMPTY (data untouched).
+ *
+ *   uint8_t NVS_Write(NVS_Store_t* s, const void* data);
+ *     Store data as the new current record. Nothing is written when data
+ *     equals the current record. The slot is read back after programming;
+ *     returns NVS_ST_OK, or NVS_ST_VERIFY if the read-back failed (the
+ *     previous record stays current).
+ *
+ *   void NVS_Format(NVS_Store_t* s);
+ *     Invalidate every slot; the store becomes empty.
+ *
+ *   uint16_t NVS_GetSeq(const NVS_Store_t* s);
+ *     Sequence number of the current record (number of saves, wrapping).
+ *
+ * Public types:
+ *   NVS_Store_t — store descriptor (region, geometry and current slot). The
+ *                 members are private to nvstore.c; set it up with NVS_Init.
+ *
+ * Public constants:
+ *   NVS_ST_OK     - success
+ *   NVS_ST_EMPTY  - no valid record in the store
+ *   NVS_ST_RANGE  - invalid geometry
+ *   NVS_ST_VERIFY - read-back after a write did not match
+ *   NVS_MAX_SIZE  - largest record size in bytes (250)
+ *   NVS_SLOT_SIZE(size) - EEPROM bytes per slot for a size-byte record
+ *
+ * Usage:
+ *   - Include this header where persistent records are required:
+ *       #include "nvstore.h"
+ *
+ *   - Keep a boot counter in 16 slots at the end of the EEPROM:
+ *       static NVS_Store_t store;
+ *       uint32_t boots = 0;
+ *
+ *       NVS_Init(&store, HAL_EEPROM_SIZE - 16 * NVS_SLOT_SIZE(4), 16, 4);
+ *       NVS_Read(&store, &boots);
+ *       boots++;
+ *       NVS_Write(&store, &boots);
+ *
+ * Notes:
+ *   - Slot layout: sequence number (2 bytes, little-endian), record (size
+ *     bytes), CRC-16/CCITT-FALSE over sequence number and record (2 bytes).
+ *   - Each slot is programmed once every slots saves, so the store lasts
+ *     roughly slots times the cell endurance (about 100,000 cycles).
+ *   - Slots are programmed with HAL_EEPROM_UpdateBlock, so bytes that
+ *     already hold the right value are skipped.
+ *   - NVS_Init reads the whole region once (slots * (size + 4) bytes).
+ *   - A store instance is not reentrant; use it from one context only and
+ *     do not let two stores overlap.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for wear-leveled record store
+ *
+ */
+
+#ifndef NVSTORE_H_
+#define NVSTORE_H_
+
+#include <stdint.h>
+#include "eeprom-hal.h"
+
+#define NVS_ST_OK     0x00
+#define NVS_ST_EMPTY  0x01
+#define NVS_ST_RANGE  0x02
+#define NVS_ST_VERIFY 0x03
+
+#define NVS_MAX_SIZE  250U
+
+#define NVS_SLOT_SIZE(size) ((uint16_t) (size) + 4U)
+
+typedef struct
+{
+	uint16_t base;
+	uint8_t slots;
+	uint8_t size;
+	uint8_t current;
+	uint8_t valid;
+	uint16_t seq;
+} NVS_Store_t;
+
+uint8_t NVS_Init(NVS_Store_t* s, uint16_t base, uint8_t slots, uint8_t size);
+
+uint8_t NVS_Read(const NVS_Store_t* s, void* data);
+uint8_t NVS_Write(NVS_Store_t* s, const void* data);
+
+void NVS_Format(NVS_Store_t* s);
+uint16_t NVS_GetSeq(const NVS_Store_t* s);
+
+#endif /* NVSTORE_H_ */
@@ -0,0 +1,211 @@
+/*
+ * uc-Microlab — Cooperative Scheduler (header)
+ * File: sched.h / sched.c
+ *
+ * Project: uc-MicroLab
+ * Component: System tick and cooperative task scheduler (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Millisecond time base and run-to-completion task scheduler. Timer0 is
+ *   set up through the CTC HAL (ctc-hal.h) for a 1 ms compare match whose
+ *   interrupt advances the system tick. The application describes its
+ *   tasks in a static table; each task is either periodic (runs every
+ *   period ms) or event-driven (runs once per SCHED_Signal, e.g. from an
+ *   I2C/SPI/ADC completion callback). A task may also carry a deadline:
+ *   a run that completes later than deadline ms after its release is
+ *   counted as a miss for that task. When no task is due the CPU sleeps
+ *   in idle mode until the next interrupt instead of busy-waiting.
+ *
+ * Public API:
+ *   uint8_t SCHED_Init(const SCHED_Task_t* table, uint8_t count);
+ *     Register count tasks (1 to SCHED_MAX_TASKS) from table, which must
+ *     stay valid while the scheduler runs, and start the 1 ms tick on
+ *     Timer0. Periodic tasks first run offset ms after Init. Returns 1 on
+ *     success, 0 if count is out of range. Global interrupts must be
+ *     enabled by the application.
+ *
+ *   void SCHED_Run(void);
+ *     Dispatch tasks forever, sleeping whenever none is due. Never returns.
+ *
+ *   uint8_t SCHED_Dispatch(void);
+ *     Run every task that is due or signalled once, in table order, and
+ *     return the number of tasks run. For applications that keep their own
+ *     main loop.
+ *
+ *   void SCHED_Idle(void);
+ *     Sleep until the next interrupt unless a task became ready in the
+ *     meantime (no-op when SCHED_USE_SLEEP is 0).
+ *
+ *   void SCHED_Signal(uint8_t id);
+ *     Mark task id ready; it runs on the next dispatch. Safe to call from
+ *     interrupt context and from completion callbacks.
+ *
+ *   void SCHED_Suspend(uint8_t id);
+ *   void SCHED_Resume(uint8_t id);
+ *     Stop / restart task id. A resumed periodic task runs one period later.
+ *
+ *   uint32_t SCHED_Millis(void);
+ *     Milliseconds since SCHED_Init (wraps after about 49.7 days).
+ *
+ *   uint32_t SCHED_Micros(void);
+ *     Microseconds since SCHED_Init with the resolution of one Timer0
+ *     count (4 µs at 16 MHz; wraps after about 71.6 minutes).
+ *
+ *   uint16_t SCHED_GetOverruns(void);
+ *   void SCHED_ClearOverruns(void);
+ *     Number of periodic runs skipped since the last SCHED_ClearOverruns
+ *     because a task was dispatched more than one period late.
+ *
+ *   uint16_t SCHED_GetMisses(uint8_t id);
+ *   void SCHED_ClearMisses(uint8_t id);
+ *     Number of runs of task id that completed after their deadline
+ *     (saturates at 65535). SCHED_ALL clears every task.
+ *
+ * Public types:
+ *   SCHED_Task_t
+ *     One entry of the task table:
+ *       void (*run)(void* ctx) — task body, runs to completion
+ *       void* ctx              — argument passed to run
+ *       uint16_t period        — period in ms; 0 makes an event task that
+ *                                only runs when signalled
+ *       uint16_t offset        — delay of the first run in ms, used to
+ *                                spread tasks with equal periods apart
+ *       uint16_t deadline      — longest time in ms from release to the end
+ *                                of the run; 0 disables the check. The
+ *                                release is the ideal release time of a
+ *                                periodic run, or the first SCHED_Signal of
+ *                                an event task since its last run
+ *
+ * Public constants:
+ *   SCHED_ALL - every task, for SCHED_ClearMisses
+ *
+ * Configuration (compile-time, define before building sched.c):
+ *   SCHED_MAX_TASKS - size of the task state table, 1 to 16 (default 8).
+ *   SCHED_USE_SLEEP - 1 (default) enters idle sleep when no task is due,
+ *                     0 keeps the CPU running (e.g. while debugging).
+ *
+ * Usage:
+ *   - Include this header where scheduling is required:
+ *       #include "sched.h"
+ *
+ *   - Blink an LED and poll a sensor without blocking delays:
+ *       enum { TASK_BLINK, TASK_SENSOR, TASK_SENSOR_DONE };
+ *
+ *       static const SCHED_Task_t tasks[] =
+ *       {
+ *           {blink,       NULL, 500, 0,  0},
+ *           {sensor_read, NULL, 100, 10, 5},    // done within 5 ms
+ *           {sensor_done, NULL, 0,   0,  20},   // event task
+ *       };
+ *
+ *       SCHED_Init(tasks, 3);
+ *       sei();
+ *       SCHED_Run();
+ *
+ *   - Yield while a transfer runs: start it from one task and finish the
+ *     work in an event task woken by the completion callback:
+ *       static void on_done(HAL_I2C_Transaction_t* t)
+ *       {
+ *           SCHED_Signal(TASK_SENSOR_DONE);
+ *       }
+ *
+ *       static void sensor_read(void* ctx)
+ *       {
+ *           xfer.callback = on_done;
+ *           HAL_I2C_Submit(&xfer);        // returns at once
+ *       }
+ *
+ * Notes:
+ *   - sched.c owns Timer0 and TIMER0_COMPA_vect; Timer0 (and its PWM pins
+ *     PD5/PD6) is not available to the application while the scheduler
+ *     runs.
+ *   - Tasks are never preempted by other tasks, only by interrupts. A task
+ *     that runs for longer than 1 ms delays every other task; split long
+ *     work into steps or hand it to the interrupt-driven HAL transfers.
+ *   - Periods are scheduled against the ideal release time (next += period),
+ *     so a late run does not accumulate drift. A task more than one period
+ *     late runs once and skips the missed releases, which are counted as
+ *     overruns.
+ *   - Scheduling stays cooperative: a deadline is not used to pick the
+ *     next task (table order still decides), it only detects late runs.
+ *     Completion is measured with SCHED_Millis, so a miss is detected
+ *     with 1 ms resolution. A skipped periodic release is an overrun, and
+ *     the late run that follows usually also counts as a miss.
+ *   - SCHED_Idle checks for signals and new ticks with interrupts disabled
+ *     and executes sei immediately before sleep, so the sleep instruction
+ *     runs before any pending interrupt and a wake-up is never lost.
+ *   - Idle mode keeps every peripheral clock running, so the UART, SPI,
+ *     TWI, ADC and timers keep working while the CPU sleeps.
+ *   - Built with HAL_PWR_USE = 1, SCHED_Idle sleeps in the deepest mode
+ *     the HALs allow (power-hal.h). The tick holds idle mode only while a
+ *     periodic task is enabled; with every periodic task suspended the
+ *     MCU can reach power-down and SCHED_Millis stops until an interrupt
+ *     (pin change, DS3231 alarm) signals an event task.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for cooperative scheduler
+ *   2026-10-14  v0.2  Tick prescaler and compare value come from the CTC HAL solver
+ *   2026-10-14  v0.3  SCHED_Idle sleeps through HAL_PWR_SleepLocked with HAL_PWR_USE
+ *   2026-10-14  v0.4  Per-task deadline in SCHED_Task_t with miss counters
+ *                     (SCHED_GetMisses, SCHED_ClearMisses); the overrun count saturates
+ *
+ */
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SCHED_MAX_TASKS
+	#define SCHED_MAX_TASKS 8U
+#endif
+
+#ifndef SCHED_USE_SLEEP
+	#define SCHED_USE_SLEEP 1
+#endif
+
+#define SCHED_ALL 0xFF
+
+#if (SCHED_MAX_TASKS < 1) || (SCHED_MAX_TASKS > 16)
+	#error "SCHED_MAX_TASKS must be between 1 and 16"
+#endif
+
+typedef struct
+{
+	void (*run)(void* ctx);
+	void* ctx;
+	uint16_t period;
+	uint16_t offset;
+	uint16_t deadline;
+} SCHED_Task_t;
+
+uint8_t SCHED_Init(const SCHED_Task_t* table, uint8_t count);
+
+void SCHED_Run(void);
+uint8_t SCHED_Dispatch(void);
+void SCHED_Idle(void);
+
+void SCHED_Signal(uint8_t id);
+void SCHED_Suspend(uint8_t id);
+void SCHED_Resume(uint8_t id);
+
+uint32_t SCHED_Millis(void);
+uint32_t SCHED_Micros(void);
+
+uint16_t SCHED_GetOverruns(void);
+void SCHED_ClearOverruns(void);
+
+uint16_t SCHED_GetMisses(uint8_t id);
+void SCHED_ClearMisses(uint8_t id);
+
+#endif /* SCHED_H_ */
@@ -0,0 +1,267 @@
+/*
+ * uc-Microlab — Binary Sample Stream (header)
+ * File: stream.h / stream.c
+ *
+ * Project: uc-MicroLab
+ * Component: Framed binary streaming over UART (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Compact binary transport for sample streams on top of the UART HAL
+ *   (uart-hal.h). Samples are batched into frames carrying a record type,
+ *   a sequence number, a sample count, the samples as little-endian 16-bit
+ *   values and a CRC-16. Each frame is COBS-encoded and terminated by a
+ *   0x00 byte, so a receiver can resynchronize at any frame boundary.
+ *   A frame is emitted when the batch is full or when it has been waiting
+ *   longer than a timeout. Encoded frames are queued into the UART TX ring
+ *   without blocking while the ring has room.
+ *
+ * Public API:
+ *   void STRM_Init(uint8_t type);
+ *     Reset the stream: empty batch, sequence number 0, frames tagged with
+ *     record type type (e.g. STRM_TYPE_ADC). The UART must have been
+ *     initialized by the application.
+ *
+ *   uint8_t STRM_Push(uint16_t sample);
+ *     Append a sample to the batch. When the batch reaches
+ *     STRM_MAX_SAMPLES the frame is emitted. Returns 1 if a frame was
+ *     emitted, 0 otherwise.
+ *
+ *   void STRM_PushBlock(const uint16_t* samples, uint16_t len);
+ *     Append len samples (e.g. a buffer from ADC_SMP_GetBuffer), emitting
+ *     frames as batches fill up.
+ *
+ *   void STRM_Flush(void);
+ *     Emit the current batch now, if it holds at least one sample.
+ *
+ *   void STRM_Service(uint16_t now);
+ *     Move pending frame bytes into the UART TX ring and emit a partial
+ *     batch that has been waiting for STRM_TIMEOUT or more. now is a
+ *     free-running time stamp in the unit of STRM_TIMEOUT (normally ms).
+ *     Call it from the main loop.
+ *
+ *   uint8_t STRM_IsIdle(void);
+ *     Return 1 when the batch is empty and every encoded byte has been
+ *     handed to the UART.
+ *
+ * Frame format (before COBS encoding, multi-byte fields little-endian):
+ *   offset  size     field
+ *   0       1        type     — record type given to STRM_Init
+ *   1       2        seq      — frame sequence number, +1 per frame
+ *   3       1        count    — number of samples n (1..STRM_MAX_SAMPLES)
+ *   4       2 * n    samples  — uint16_t samples, oldest first
+ *   4 + 2n  2        crc      — CRC-16/CCITT-FALSE (poly 0x1021, init
+ *                               0xFFFF) over bytes 0 .. 3 + 2n
+ *   The encoded frame is followed by a single 0x00 delimiter. The host
+ *   decoder firmware/tools/stream-decode.py implements this format.
+ *
+ * Public constants:
+ *   STRM_TYPE_ADC - record type for raw ADC samples (0x01)
+ *   STRM_TYPE_ANY - first free record type for application data (0x80)
+ *
+ * Configuration (compile-time, define before building stream.c):
+ *   STRM_MAX_SAMPLES - samples per frame, 1 to 120 (default 16).
+ *   STRM_TIMEOUT     - age of a partial batch, in STRM_Service time units,
+ *                      after which it is emitted (default 50).
+ *
+ * Usage:
+ *   - Include this header where streaming is required:
+ *       #include "stream.h"
+ *
+ *   - Stream ADC sampler buffers:
+ *       HAL_UART_Init(38400);
+ *       STRM_Init(STRM_TYPE_ADC);
+ *       ...
+ *       const uint16_t* buf = ADC_SMP_GetBuffer();
+ *       if(buf)
+ *       {
+ *           STRM_PushBlock(buf, ADC_SMP_BUFFER_LEN);
+ *           ADC_SMP_Release();
+ *       }
+ *       STRM_Service(now_ms);
+ *
+ * Notes:
+ *   - Build uart-hal.c with HAL_UART_USE_ISR = 1 so frames drain in the
+ *     background. With the polling UART, STRM_Service only sends the bytes
+ *     the USART can take immediately.
+ *   - If a frame is emitted while the previous one is still waiting for
+ *     TX ring space, the caller blocks until the previous frame has been
+ *     queued. Keep the UART bit rate above the stream's data rate:
+ *     (2 * STRM_MAX_SAMPLES + 8) bytes per STRM_MAX_SAMPLES samples.
+ *   - At the default 16 samples per frame the overhead is 8 bytes per 32
+ *     bytes of samples (header, CRC, COBS code byte and delimiter), against
+ *     roughly 15 bytes of text per sample for a formatted printf line.
+ *   - The timeout is measured from the first STRM_Service call that sees
+ *     the partial batch, so its resolution is the service period.
+ *   - The stream module is not reentrant; call it from one context only.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for binary sample stream
+ *
+ */
+
+#include "stream.h"
+
+#include <util/crc16.h>
+
+#define STRM_HDR_LEN   4U
+#define STRM_CRC_LEN   2U
+#define STRM_RAW_MAX   (STRM_HDR_LEN + 2U * STRM_MAX_SAMPLES + STRM_CRC_LEN)
+
+/* A raw frame is shorter than 254 bytes: COBS adds one code byte */
+#define STRM_OUT_MAX   (STRM_RAW_MAX + 2U)
+
+/*
+ * Samples are stored straight into the raw frame, so emitting a frame only
+ * adds header and CRC before the COBS pass.
+ */
+static uint8_t strm_raw[STRM_RAW_MAX];
+static uint8_t strm_count = 0;
+
+static uint8_t strm_out[STRM_OUT_MAX];
+static uint8_t strm_out_len = 0;
+static uint8_t strm_out_pos = 0;
+
+static uint8_t  strm_type = STRM_TYPE_ADC;
+static uint16_t strm_seq = 0;
+
+static uint8_t  strm_waiting = 0;
+static uint16_t strm_since = 0;
+
+static void strm_emit(void);
+static void strm_drain(void);
+static uint8_t strm_cobs(const uint8_t* in, uint8_t len, uint8_t* out);
+
+void STRM_Init(uint8_t type)
+{
+	strm_type    = type;
+	strm_seq     = 0;
+	strm_count   = 0;
+	strm_out_len = 0;
+	strm_out_pos = 0;
+	strm_waiting = 0;
+}
+
+uint8_t STRM_Push(uint16_t sample)
+{
+	uint8_t* slot = &strm_raw[STRM_HDR_LEN + 2U * strm_count];
+	
+	slot[0] = (uint8_t) sample;
+	slot[1] = (uint8_t) (sample >> 8);
+	
+	if(++strm_count < STRM_MAX_SAMPLES) return 0U;
+	
+	strm_emit();
+	
+	return 1U;
+}
+
+void STRM_PushBlock(const uint16_t* samples, uint16_t len)
+{
+	for(uint16_t i = 0; i < len; ++i) STRM_Push(samples[i]);
+}
+
+void STRM_Flush(void)
+{
+	if(strm_count) strm_emit();
+}
+
+void STRM_Service(uint16_t now)
+{
+	strm_drain();
+	
+	if(strm_count == 0)
+	{
+		strm_waiting = 0;
+		return;
+	}
+	
+	if(!strm_waiting)
+	{
+		strm_waiting = 1;
+		strm_since   = now;
+		return;
+	}
+	
+	if((uint16_t)(now - strm_since) >= STRM_TIMEOUT) strm_emit();
+}
+
+uint8_t STRM_IsIdle(void)
+{
+	return (strm_count == 0 && strm_out_pos == strm_out_len) ? 1U : 0U;
+}
+
+static void strm_emit(void)
+{
+	/* The previous frame must be fully queued before strm_out is reused */
+	if(strm_out_pos < strm_out_len) HAL_UART_Send(&strm_out[strm_out_pos], strm_out_len - strm_out_pos);
+	
+	uint8_t  len = STRM_HDR_LEN + 2U * strm_count;
+	uint16_t crc = 0xFFFF;
+	
+	strm_raw[0] = strm_type;
+	strm_raw[1] = (uint8_t) strm_seq;
+	strm_raw[2] = (uint8_t) (strm_seq >> 8);
+	strm_raw[3] = strm_count;
+	
+	for(uint8_t i = 0; i < len; ++i) crc = _crc_xmodem_update(crc, strm_raw[i]);
+	
+	strm_raw[len++] = (uint8_t) crc;
+	strm_raw[len++] = (uint8_t) (crc >> 8);
+	
+	strm_out_len = strm_cobs(strm_raw, len, strm_out);
+	strm_out[strm_out_len++] = 0x00;
+	strm_out_pos = 0;
+	
+	++strm_seq;
+	strm_count   = 0;
+	strm_waiting = 0;
+	
+	strm_drain();
+}
+
+static void strm_drain(void)
+{
+	if(strm_out_pos >= strm_out_len) return;
+	
+	strm_out_pos += HAL_UART_TrySend(&strm_out[strm_out_pos], strm_out_len - strm_out_pos);
+}
+
+/*
+ * Consistent Overhead Byte Stuffing: every run of non-zero bytes is
+ * prefixed by its length + 1, which replaces the zero that ends it. The
+ * input is shorter than 254 bytes, so there is never a 0xFF code.
+ */
+static uint8_t strm_cobs(const uint8_t* in, uint8_t len, uint8_t* out)
+{
+	uint8_t code_pos = 0;
+	uint8_t pos  = 1;
+	uint8_t code = 1;
+	
+	for(uint8_t i = 0; i < len; ++i)
+	{
+		if(in[i] == 0x00)
+		{
+			out[code_pos] = code;
+			code_pos = pos++;
+			code = 1;
+		}
+		else
+		{
+			out[pos++] = in[i];
+			++code;
+		}
+	}
+	
+	out[code_pos] = code;
+	
+	return pos;
+}
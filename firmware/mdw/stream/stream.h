@@ -0,0 +1,141 @@
+/*
+ * uc-Microlab — Binary Sample Stream (header)
+ * File: stream.h / stream.c
+ *
+ * Project: uc-MicroLab
+ * Component: Framed binary streaming over UART (middleware)
+ * Hardware: uc-MicroLab board — version r1
+ *
+ * Description:
+ *   Compact binary transport for sample streams on top of the UART HAL
+ *   (uart-hal.h). Samples are batched into frames carrying a record type,
+ *   a sequence number, a sample count, the samples as little-endian 16-bit
+ *   values and a CRC-16. Each frame is COBS-encoded and terminated by a
+ *   0x00 byte, so a receiver can resynchronize at any frame boundary.
+ *   A frame is emitted when the batch is full or when it has been waiting
+ *   longer than a timeout. Encoded frames are queued into the UART TX ring
+ *   without blocking while the ring has room.
+ *
+ * Public API:
+ *   void STRM_Init(uint8_t type);
+ *     Reset the stream: empty batch, sequence number 0, frames tagged with
+ *     record type type (e.g. STRM_TYPE_ADC). The UART must have been
+ *     initialized by the application.
+ *
+ *   uint8_t STRM_Push(uint16_t sample);
+ *     Append a sample to the batch. When the batch reaches
+ *     STRM_MAX_SAMPLES the frame is emitted. Returns 1 if a frame was
+ *     emitted, 0 otherwise.
+ *
+ *   void STRM_PushBlock(const uint16_t* samples, uint16_t len);
+ *     Append len samples (e.g. a buffer from ADC_SMP_GetBuffer), emitting
+ *     frames as batches fill up.
+ *
+ *   void STRM_Flush(void);
+ *     Emit the current batch now, if it holds at least one sample.
+ *
+ *   void STRM_Service(uint16_t now);
+ *     Move pending frame bytes into the UART TX ring and emit a partial
+ *     batch that has been waiting for STRM_TIMEOUT or more. now is a
+ *     free-running time stamp in the unit of STRM_TIMEOUT (normally ms).
+ *     Call it from the main loop.
+ *
+ *   uint8_t STRM_IsIdle(void);
+ *     Return 1 when the batch is empty and every encoded byte has been
+ *     handed to the UART.
+ *
+ * Frame format (before COBS encoding, multi-byte fields little-endian):
+ *   offset  size     field
+ *   0       1        type     — record type given to STRM_Init
+ *   1       2        seq      — frame sequence number, +1 per frame
+ *   3       1        count    — number of samples n (1..STRM_MAX_SAMPLES)
+ *   4       2 * n    samples  — uint16_t samples, oldest first
+ *   4 + 2n  2        crc      — CRC-16/CCITT-FALSE (poly 0x1021, init
+ *                               0xFFFF) over bytes 0 .. 3 + 2n
+ *   The encoded frame is followed by a single 0x00 delimiter. The host
+ *   decoder firmware/tools/stream-decode.py implements this format.
+ *
+ * Public constants:
+ *   STRM_TYPE_ADC - record type for raw ADC samples (0x01)
+ *   STRM_TYPE_ANY - first free record type for application data (0x80)
+ *
+ * Configuration (compile-time, define before building stream.c):
+ *   STRM_MAX_SAMPLES - samples per frame, 1 to 120 (default 16).
+ *   STRM_TIMEOUT     - age of a partial batch, in STRM_Service time units,
+ *                      after which it is emitted (default 50).
+ *
+ * Usage:
+ *   - Include this header where streaming is required:
+ *       #include "stream.h"
+ *
+ *   - Stream ADC sampler buffers:
+ *       HAL_UART_Init(38400);
+ *       STRM_Init(STRM_TYPE_ADC);
+ *       ...
+ *       const uint16_t* buf = ADC_SMP_GetBuffer();
+ *       if(buf)
+ *       {
+ *           STRM_PushBlock(buf, ADC_SMP_BUFFER_LEN);
+ *           ADC_SMP_Release();
+ *       }
+ *       STRM_Service(now_ms);
+ *
+ * Notes:
+ *   - Build uart-hal.c with HAL_UART_USE_ISR = 1 so frames drain in the
+ *     background. With the polling UART, STRM_Service only sends the bytes
+ *     the USART can take immediately.
+ *   - If a frame is emitted while the previous one is still waiting for
+ *     TX ring space, the caller blocks until the previous frame has been
+ *     queued. Keep the UART bit rate above the stream's data rate:
+ *     (2 * STRM_MAX_SAMPLES + 8) bytes per STRM_MAX_SAMPLES samples.
+ *   - At the default 16 samples per frame the overhead is 8 bytes per 32
+ *     bytes of samples (header, CRC, COBS code byte and delimiter), against
+ *     roughly 15 bytes of text per sample for a formatted printf line.
+ *   - The timeout is measured from the first STRM_Service call that sees
+ *     the partial batch, so its resolution is the service period.
+ *   - The stream module is not reentrant; call it from one context only.
+ *
+ * Author: otavioacb
+ * Created: 2026-10-14
+ *
+ * License:
+ *   SPDX-License-Identifier: MIT
+ *   This file is licensed under the MIT License — see the repository LICENSE
+ *   file for full terms and copyright information.
+ *
+ * Change log:
+ *   2026-10-14  v0.1  Initial header for binary sample stream
+ *
+ */
+
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#include <stdint.h>
+#include "uart-hal.h"
+
+#ifndef STRM_MAX_SAMPLES
+	#define STRM_MAX_SAMPLES 16U
+#endif
+
+#ifndef STRM_TIMEOUT
+	#define STRM_TIMEOUT 50U
+#endif
+
+#if (STRM_MAX_SAMPLES < 1) || (STRM_MAX_SAMPLES > 120)
+	#error "STRM_MAX_SAMPLES must be between 1 and 120"
+#endif
+
+#define STRM_TYPE_ADC 0x01
+#define STRM_TYPE_ANY 0x80
+
+void STRM_Init(uint8_t type);
+
+uint8_t STRM_Push(uint16_t sample);
+void STRM_PushBlock(const uint16_t* samples, uint16_t len);
+void STRM_Flush(void);
+
+void STRM_Service(uint16_t now);
+uint8_t STRM_IsIdle(void);
+
+#endif /* STREAM_H_ */
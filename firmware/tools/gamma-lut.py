@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""
+uc-Microlab — Gamma correction table generator
+File: gamma-lut.py
+
+Prints a C array mapping perceived brightness (0-255) to PWM compare
+values, out[i] = round(max * (i / 255) ** gamma), for pasting into a
+driver such as firmware/drv/led/rgb-led.c. Entries above 0 are raised to
+at least 1 so that every non-zero input still lights the LED.
+
+Usage:
+    gamma-lut.py                       gamma 2.2, 8-bit output
+    gamma-lut.py -g 2.8 -m 1023        gamma 2.8, 10-bit output (uint16_t)
+    gamma-lut.py -n rgb_gamma          name of the generated array
+
+Author: otavioacb
+Created: 2026-10-14
+SPDX-License-Identifier: MIT
+"""
+
+import argparse
+
+
+def gamma_table(gamma, top):
+    table = []
+    for i in range(256):
+        value = int(round(top * (i / 255.0) ** gamma))
+        if i > 0 and value == 0:
+            value = 1
+        table.append(value)
+    return table
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a PROGMEM gamma table")
+    parser.add_argument("-g", "--gamma", type=float, default=2.2,
+                        help="gamma exponent (default 2.2)")
+    parser.add_argument("-m", "--max", type=int, default=255,
+                        help="largest output value (default 255)")
+    parser.add_argument("-n", "--name", default="rgb_gamma",
+                        help="array name (default rgb_gamma)")
+    args = parser.parse_args()
+
+    if not 1 <= args.max <= 0xFFFF:
+        parser.error("max must be between 1 and 65535")
+
+    ctype = "uint8_t" if args.max <= 0xFF else "uint16_t"
+    width = 3 if args.max <= 0xFF else 5
+    table = gamma_table(args.gamma, args.max)
+
+    print("/* Generated by firmware/tools/gamma-lut.py -g %g -m %d */"
+          % (args.gamma, args.max))
+    print("static const %s %s[256] PROGMEM =" % (ctype, args.name))
+    print("{")
+    for row in range(0, 256, 16):
+        line = ", ".join("%*d" % (width, v) for v in table[row:row + 16])
+        print("\t%s%s" % (line, "," if row < 240 else ""))
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
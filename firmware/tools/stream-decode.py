@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+uc-Microlab — Binary Sample Stream decoder
+File: stream-decode.py
+
+Host-side decoder for the frames produced by firmware/mdw/stream
+(stream.h / stream.c).
+
+Frame format (before COBS encoding, multi-byte fields little-endian):
+    offset  size    field
+    0       1       type     record type (0x01 = raw ADC samples)
+    1       2       seq      frame sequence number, +1 per frame
+    3       1       count    number of samples n
+    4       2 * n   samples  uint16 samples, oldest first
+    4 + 2n  2       crc      CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+                             over bytes 0 .. 3 + 2n
+Each frame is COBS-encoded and followed by a single 0x00 delimiter.
+
+Usage:
+    stream-decode.py capture.bin             decode a raw capture file
+    stream-decode.py /dev/ttyACM0 -b 38400   decode a serial port (pyserial)
+    stream-decode.py - < capture.bin         decode stdin
+
+Output is one line per sample, "seq,index,type,value", suitable for CSV.
+Frames with a bad CRC or length are reported on stderr and skipped; gaps in
+the sequence numbers are reported as lost frames.
+
+Author: otavioacb
+Created: 2026-10-14
+SPDX-License-Identifier: MIT
+"""
+
+import argparse
+import struct
+import sys
+
+
+def crc16_ccitt_false(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_frame(raw):
+    if len(raw) < 6:
+        raise ValueError("short frame")
+    body, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+    if crc16_ccitt_false(body) != crc:
+        raise ValueError("CRC mismatch")
+    ftype, seq, count = struct.unpack("<BHB", body[:4])
+    if len(body) != 4 + 2 * count:
+        raise ValueError("length mismatch")
+    samples = struct.unpack("<%dH" % count, body[4:])
+    return ftype, seq, samples
+
+
+def frames(stream):
+    pending = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        for byte in chunk:
+            if byte == 0:
+                if pending:
+                    yield bytes(pending)
+                pending.clear()
+            else:
+                pending.append(byte)
+
+
+def open_input(args):
+    if args.source == "-":
+        return sys.stdin.buffer
+    if args.source.startswith("/dev/") or args.source.upper().startswith("COM"):
+        import serial  # pyserial
+        return serial.Serial(args.source, args.baud, timeout=1)
+    return open(args.source, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode uc-Microlab binary sample streams")
+    parser.add_argument("source", help="capture file, serial port or - for stdin")
+    parser.add_argument("-b", "--baud", type=int, default=38400, help="serial bit rate")
+    args = parser.parse_args()
+
+    expected = None
+    good = bad = lost = 0
+
+    try:
+        for encoded in frames(open_input(args)):
+            try:
+                ftype, seq, samples = parse_frame(cobs_decode(encoded))
+            except ValueError as err:
+                bad += 1
+                print("# dropped frame: %s" % err, file=sys.stderr)
+                continue
+
+            if expected is not None and seq != expected:
+                missing = (seq - expected) & 0xFFFF
+                lost += missing
+                print("# lost %d frame(s) before seq %d" % (missing, seq), file=sys.stderr)
+            expected = (seq + 1) & 0xFFFF
+            good += 1
+
+            for index, value in enumerate(samples):
+                print("%d,%d,%d,%d" % (seq, index, ftype, value))
+    except KeyboardInterrupt:
+        pass
+
+    print("# frames: %d ok, %d bad, %d lost" % (good, bad, lost), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()